@@ -0,0 +1,65 @@
+#ifndef APPCONFIG_H
+#define APPCONFIG_H
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QHash>
+#include <QSettings>
+#include <QVariant>
+#include <QDebug>
+
+// ==============================================================================
+//  全局配置 (config.ini) 的只读快照
+//  第一次访问时读取并解析一次，之后只读，任意线程都可以并发调用 value()
+//  (QSettings 本身不是线程安全的，所以这里把所有键值拷贝出来)
+// ==============================================================================
+class AppConfig {
+public:
+    static QString path() {
+        // applicationDirPath() 指向的是 .exe 所在的目录
+        return QCoreApplication::applicationDirPath() + "/config.ini";
+    }
+
+    // 配置文件是否存在
+    static bool exists() {
+        return snapshot().loaded;
+    }
+
+    // key 形如 "Database/Host"
+    static QVariant value(const QString &key, const QVariant &defaultValue = QVariant()) {
+        const Snapshot &s = snapshot();
+        auto it = s.values.constFind(key);
+        return it == s.values.constEnd() ? defaultValue : it.value();
+    }
+
+private:
+    struct Snapshot {
+        bool loaded = false;
+        QHash<QString, QVariant> values;
+    };
+
+    static const Snapshot &snapshot() {
+        // C++11 起函数内 static 的初始化是线程安全的
+        static const Snapshot s = load();
+        return s;
+    }
+
+    static Snapshot load() {
+        Snapshot s;
+        const QString configPath = path();
+        if (!QFileInfo::exists(configPath)) {
+            qWarning() << "配置文件 config.ini 未找到！请拷贝 config.example.ini 并修改配置。";
+            return s;
+        }
+
+        QSettings settings(configPath, QSettings::IniFormat);
+        const QStringList keys = settings.allKeys();
+        for (const QString &key : keys) {
+            s.values.insert(key, settings.value(key));
+        }
+        s.loaded = true;
+        return s;
+    }
+};
+
+#endif // APPCONFIG_H
@@ -1,8 +1,20 @@
 #ifndef BASECONTROLLER_H
 #define BASECONTROLLER_H
 
+#include "AppConfig.h"
+#include "JsonStreamWriter.h"
+#include "Metrics.h"
+#include "StreamBackpressure.h"
+#include "Tracer.h"
 #include <QHttpServer>
+#include <QHttpServerResponder>
 #include <QObject>
+#include <QThread>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QtConcurrent/QtConcurrentRun>
+#include <memory>
 
 class BaseController : public QObject {
     Q_OBJECT
@@ -12,6 +24,131 @@ public:
 
     // 纯虚函数：子类必须实现这个函数来告诉 Server 只有哪些路由
     virtual void registerRoutes(QHttpServer *server) = 0;
+
+    // 所有 Controller 共用的工作线程池 (线程数见 config.ini 的 Server/WorkerThreads)
+    static QThreadPool *workerPool() {
+        static QThreadPool *pool = [] {
+            auto *p = new QThreadPool;
+            const int threads = AppConfig::value("Server/WorkerThreads", QThread::idealThreadCount()).toInt();
+            p->setMaxThreadCount(qMax(1, threads));
+            p->setObjectName("RequestWorkers");
+            return p;
+        }();
+        return pool;
+    }
+
+protected:
+    // 下面几个注册函数都会记录路由指标 (请求数、状态码类别、耗时)，见 /metrics
+    // 耗时从服务器线程收到请求开始算，包含在工作线程池里排队的时间
+    // 同时为每个请求开一个追踪 (Tracer)，handler 执行期间它是当前线程的当前追踪
+
+    // 注册一个在工作线程池中执行的路由 (按路由选择是否启用)
+    // handler 在工作线程里同步执行，服务器主线程只负责收发，慢查询不会再卡住其他请求。
+    // 数据库连接照常用 DatabaseManager::getConnection() 借用，连接池会把连接迁移到当前工作线程。
+    // 注意：handler 里不能使用属于主线程的 QObject (例如 QNetworkAccessManager)
+    template <typename Handler>
+    void routeConcurrent(QHttpServer *server, const QString &path,
+                         QHttpServerRequest::Method method, Handler handler)
+    {
+        RouteMetrics *metrics = RouteMetrics::forRoute(path);
+        server->route(path, method, [path, handler, metrics](const QHttpServerRequest &req) {
+            QElapsedTimer timer;
+            timer.start();
+            auto trace = Tracer::instance().begin(path);
+            // req 只在本次回调期间有效，拷贝一份交给工作线程
+            return QtConcurrent::run(workerPool(), [handler, req, metrics, timer, trace]() -> QHttpServerResponse {
+                TraceScope scope(trace);
+                if (trace) trace->addSpan("worker.queue", "server", trace->startUs(), Tracer::nowUs());
+                QHttpServerResponse response = handler(req);
+                const int status = int(response.statusCode());
+                metrics->record(status, timer.nsecsElapsed());
+                Tracer::instance().finish(trace, status);
+                return response;
+            });
+        });
+    }
+
+    // 注册一个本身就是异步的路由 (handler 在服务器线程里调用，返回 QFuture<QHttpServerResponse>)
+    // 用于要用主线程 QObject 的接口，例如通过 QNetworkAccessManager 调用大模型
+    template <typename Handler>
+    void routeAsync(QHttpServer *server, const QString &path,
+                    QHttpServerRequest::Method method, Handler handler)
+    {
+        RouteMetrics *metrics = RouteMetrics::forRoute(path);
+        server->route(path, method, [path, handler, metrics](const QHttpServerRequest &req) {
+            QElapsedTimer timer;
+            timer.start();
+            auto trace = Tracer::instance().begin(path);
+            // 异步链的后续步骤需要自己用 TraceScope(Tracer::current()) 接上追踪
+            TraceScope scope(trace);
+            return handler(req).then([metrics, timer, trace](QHttpServerResponse response) {
+                const int status = int(response.statusCode());
+                metrics->record(status, timer.nsecsElapsed());
+                Tracer::instance().finish(trace, status);
+                return response;
+            });
+        });
+    }
+
+    // 注册一个流式输出 JSON 的路由 (大结果集用)
+    // handler 签名：QHttpServerResponse::StatusCode (const QHttpServerRequest &, JsonStreamWriter &)
+    // handler 在工作线程里往 writer 写 JSON；攒够一个 chunk 就切回服务器线程以 chunked 编码发出去，
+    // 整个文档不会同时留在内存里。结果不足一个 chunk 时按普通响应一次性发出，状态码取 handler 的返回值。
+    // 注意：第一个 chunk 发出后状态码已经是 200，出错只能在开始写数据之前 (writer.reset() 后改写错误信息)
+    // 客户端收得慢时按 Server/StreamBufferKB 背压 (见 StreamBackpressure)，工作线程暂停产出，
+    // 一个响应累计最多等 Server/StreamMaxBlockSec；handler 要在写第一个 chunk 之前归还数据库连接
+    template <typename Handler>
+    void routeStreaming(QHttpServer *server, const QString &path,
+                        QHttpServerRequest::Method method, Handler handler)
+    {
+        RouteMetrics *metrics = RouteMetrics::forRoute(path);
+        const qint64 maxBuffered = qMax<qint64>(64, AppConfig::value("Server/StreamBufferKB", 256).toLongLong()) * 1024;
+        const int maxBlockedMs = qMax(1, AppConfig::value("Server/StreamMaxBlockSec", 10).toInt()) * 1000;
+        server->route(path, method, [path, server, handler, metrics, maxBuffered, maxBlockedMs](const QHttpServerRequest &req, QHttpServerResponder &responder) {
+            QElapsedTimer timer;
+            timer.start();
+            auto trace = Tracer::instance().begin(path);
+            // responder 只能在服务器线程里使用，移进共享指针，写操作都投递回 server 所在线程
+            auto shared = std::make_shared<QHttpServerResponder>(std::move(responder));
+            auto backpressure = std::make_shared<StreamBackpressure>(maxBuffered, maxBlockedMs);
+            const QHostAddress peer = req.remoteAddress();
+            const quint16 peerPort = req.remotePort();
+            QtConcurrent::run(workerPool(), [server, handler, req, shared, backpressure, peer, peerPort, metrics, timer, trace]() {
+                TraceScope scope(trace);
+                if (trace) trace->addSpan("worker.queue", "server", trace->startUs(), Tracer::nowUs());
+                auto started = std::make_shared<bool>(false);
+                JsonStreamWriter writer(64 * 1024);
+                writer.setSink([server, shared, started, backpressure, peer, peerPort](const QByteArray &chunk) {
+                    if (!backpressure->waitForRoom(chunk.size())) return; // 连接已断开或客户端不再接收
+                    QMetaObject::invokeMethod(server, [server, shared, started, backpressure, peer, peerPort, chunk]() {
+                        if (!*started) {
+                            backpressure->attach(server, peer, peerPort, backpressure);
+                            shared->writeBeginChunked("application/json");
+                            *started = true;
+                        }
+                        shared->writeChunk(chunk);
+                        backpressure->written(chunk.size());
+                    }, Qt::QueuedConnection);
+                });
+
+                const QHttpServerResponse::StatusCode status = handler(req, writer);
+                const QByteArray rest = writer.take();
+                const bool flushed = writer.hasFlushed();
+                // 已经开始分块发送时实际状态码是 200
+                const int sentStatus = flushed ? 200 : int(status);
+                metrics->record(sentStatus, timer.nsecsElapsed());
+                Tracer::instance().finish(trace, sentStatus);
+                QMetaObject::invokeMethod(server, [shared, backpressure, flushed, status, rest]() {
+                    if (flushed) {
+                        if (backpressure->abortIfStalled()) return;
+                        shared->writeEndChunked(rest);
+                    } else {
+                        shared->write(rest, "application/json", status);
+                    }
+                }, Qt::QueuedConnection);
+            });
+        });
+    }
 };
 
 #endif // BASECONTROLLER_H
@@ -0,0 +1,79 @@
+#include "CityDirectory.h"
+#include "DatabaseManager.h"
+
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+
+// 三字码统一按大写存，拼音统一按小写存，查询时各试一次
+static QString codeKey(const QString &s) { return s.trimmed().toUpper(); }
+static QString pinyinKey(const QString &s) { return s.trimmed().toLower(); }
+
+CityDirectory::CityDirectory()
+    : m_table(new Table)
+{
+}
+
+CityDirectory::~CityDirectory()
+{
+    delete m_table.load();
+    qDeleteAll(m_retired);
+}
+
+CityDirectory &CityDirectory::instance()
+{
+    static CityDirectory directory;
+    return directory;
+}
+
+bool CityDirectory::reload(const QSqlDatabase &db)
+{
+    QSqlQuery query(db);
+    if (!DatabaseManager::exec(query, "SELECT city_code, city_name, pinyin FROM city_codes")) {
+        qWarning() << "Load City Codes Error:" << query.lastError().text();
+        return false;
+    }
+
+    auto *table = new Table;
+    while (query.next()) {
+        City city;
+        city.code = codeKey(query.value(0).toString());
+        city.name = query.value(1).toString().trimmed();
+        city.pinyin = query.value(2).toString().trimmed();
+
+        table->byKey.insert(city.code, city);
+        table->byKey.insert(city.name, city);
+        if (!city.pinyin.isEmpty()) {
+            table->byKey.insert(pinyinKey(city.pinyin), city);
+        }
+        ++table->cityCount;
+    }
+
+    // 新快照构建完毕后一次性替换，正在查询的线程继续用旧快照
+    QMutexLocker locker(&m_reloadMutex);
+    const Table *old = m_table.exchange(table, std::memory_order_acq_rel);
+    m_retired.append(old);
+    qInfo() << "城市字典已加载:" << table->cityCount << "个城市";
+    return true;
+}
+
+const CityDirectory::City *CityDirectory::find(const QString &codeOrName) const
+{
+    const Table *table = snapshot();
+
+    auto it = table->byKey.constFind(codeKey(codeOrName));
+    if (it == table->byKey.constEnd()) it = table->byKey.constFind(codeOrName.trimmed());
+    if (it == table->byKey.constEnd()) it = table->byKey.constFind(pinyinKey(codeOrName));
+    return it == table->byKey.constEnd() ? nullptr : &it.value();
+}
+
+QString CityDirectory::cityName(const QString &codeOrName) const
+{
+    const City *city = find(codeOrName);
+    return city ? city->name : codeOrName;
+}
+
+int CityDirectory::size() const
+{
+    return snapshot()->cityCount;
+}
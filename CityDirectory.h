@@ -0,0 +1,54 @@
+#ifndef CITYDIRECTORY_H
+#define CITYDIRECTORY_H
+
+#include <QHash>
+#include <QString>
+#include <QSqlDatabase>
+#include <QMutex>
+#include <QList>
+#include <atomic>
+
+// ==============================================================================
+//  城市字典：启动时把 city_codes 整表读进内存
+//  支持 IATA 三字码 (BJS)、中文名 (北京)、拼音 (Beijing / beijing) 三种写法
+//  查询走不可变快照，只有一次原子读，不加锁；reload() 构建新快照后原子替换。
+//  被替换下来的旧快照不释放 (reload 只是偶尔的管理操作)，所以 find() 返回的指针一直有效
+// ==============================================================================
+class CityDirectory {
+public:
+    struct City {
+        QString code;    // IATA 三字码
+        QString name;    // 中文名 (flights 表里存的就是中文名)
+        QString pinyin;
+    };
+
+    static CityDirectory &instance();
+
+    // 从 city_codes 表重新加载，成功后原子替换当前快照
+    bool reload(const QSqlDatabase &db);
+
+    // 任意写法 -> 中文城市名；查不到时原样返回 (可能前端直接传了中文，或者代码错误)
+    QString cityName(const QString &codeOrName) const;
+
+    // 任意写法 -> 城市信息，查不到返回 nullptr
+    const City *find(const QString &codeOrName) const;
+
+    int size() const;
+
+private:
+    struct Table {
+        QHash<QString, City> byKey; // 三字码 / 中文名 / 小写拼音 都指向同一个城市
+        int cityCount = 0;
+    };
+
+    CityDirectory();
+    ~CityDirectory();
+
+    const Table *snapshot() const { return m_table.load(std::memory_order_acquire); }
+
+    std::atomic<const Table *> m_table;
+    QMutex m_reloadMutex;
+    QList<const Table *> m_retired; // 旧快照，进程退出时统一释放
+};
+
+#endif // CITYDIRECTORY_H
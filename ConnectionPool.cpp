@@ -0,0 +1,264 @@
+#include "ConnectionPool.h"
+
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QThread>
+#include <QDeadlineTimer>
+#include <QDebug>
+#include <vector>
+
+ConnectionPool::ConnectionPool(const QString &name, const ConnectionOptions &options)
+    : m_name(name), m_options(options)
+{
+    m_clock.start();
+    m_stats.minSize = m_options.minSize;
+    m_stats.maxSize = m_options.maxSize;
+    m_waitHistogram = Metrics::instance().histogram("db_pool_wait_seconds", "Time spent waiting to borrow a pooled connection",
+                                                    "pool=\"" + Metrics::escapeLabel(name) + "\"");
+}
+
+ConnectionPool::~ConnectionPool()
+{
+    // 只能回收空闲连接；仍被借出的句柄在进程退出时由系统回收
+    QList<PoolEntry *> idle;
+    {
+        QMutexLocker locker(&m_mutex);
+        idle.swap(m_idle);
+        m_total -= idle.size();
+    }
+    for (PoolEntry *entry : idle) {
+        entry->db.moveToThread(QThread::currentThread());
+        destroyEntry(entry);
+    }
+}
+
+bool ConnectionPool::warmUp()
+{
+    std::vector<PooledConnection> warm;
+    for (int i = 0; i < qMax(1, m_options.minSize); ++i) {
+        PooledConnection conn = acquire();
+        if (!conn.isOpen()) {
+            // 第一条都连不上说明配置有误，直接报告失败
+            if (i == 0) return false;
+            break;
+        }
+        warm.push_back(std::move(conn));
+    }
+    // warm 析构时全部归还，池内就有了 minSize 条空闲连接
+    return true;
+}
+
+PooledConnection ConnectionPool::acquire(int timeoutMs)
+{
+    if (timeoutMs < 0) timeoutMs = m_options.borrowTimeoutMs;
+
+    PoolEntry *entry = nullptr;
+    bool needCreate = false;
+
+    QElapsedTimer waitTimer;
+    waitTimer.start();
+    bool waited = false;
+    quint64 waitUs = 0;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        while (true) {
+            if (!m_idle.isEmpty()) {
+                entry = m_idle.takeLast();
+                break;
+            }
+            if (m_total < m_options.maxSize) {
+                ++m_total;          // 先占位，真正的连接在锁外建立
+                needCreate = true;
+                break;
+            }
+
+            // 池已满，排队等待其他请求归还
+            const qint64 remaining = timeoutMs - waitTimer.elapsed();
+            if (remaining <= 0) {
+                ++m_stats.timeoutCount;
+                qWarning() << "连接池" << m_name << "等待超时 (" << timeoutMs << "ms)，当前连接数:" << m_total;
+                return PooledConnection();
+            }
+            waited = true;
+            m_available.wait(&m_mutex, QDeadlineTimer(remaining));
+        }
+
+        waitUs = quint64(waitTimer.nsecsElapsed() / 1000);
+        ++m_stats.borrowCount;
+        if (waited) ++m_stats.waitCount;
+        m_stats.totalWaitUs += waitUs;
+        if (waitUs > m_stats.maxWaitUs) m_stats.maxWaitUs = waitUs;
+    }
+    m_waitHistogram->observeUs(qint64(waitUs));
+
+    if (needCreate) {
+        entry = openEntry();
+        if (!entry) {
+            QMutexLocker locker(&m_mutex);
+            --m_total;
+            m_available.wakeOne();
+            return PooledConnection();
+        }
+        return PooledConnection(this, entry);
+    }
+
+    // 复用空闲连接：先把它"拉"到当前线程
+    entry->db.moveToThread(QThread::currentThread());
+    if (!validate(entry)) {
+        destroyEntry(entry);
+        QMutexLocker locker(&m_mutex);
+        --m_total;
+        m_available.wakeOne();
+        return PooledConnection();
+    }
+    return PooledConnection(this, entry);
+}
+
+void ConnectionPool::giveBack(PoolEntry *entry)
+{
+    // 借用者忘记结束事务时在这里回滚，避免把行锁带给下一个使用者
+    if (entry->inTransaction) {
+        entry->db.rollback();
+        entry->inTransaction = false;
+    }
+    // 借用期间被淘汰的语句在这里销毁，命中计数汇总到池统计
+    entry->statements.releaseTransient();
+    quint64 hits, misses, evictions;
+    entry->statements.takeCounters(&hits, &misses, &evictions);
+
+    // 解除线程归属，任意线程都可以再把它拉走
+    entry->db.moveToThread(nullptr);
+
+    QMutexLocker locker(&m_mutex);
+    m_stats.statementHits += hits;
+    m_stats.statementMisses += misses;
+    m_stats.statementEvictions += evictions;
+    entry->lastUsedMs = m_clock.elapsed();
+    m_idle.append(entry);
+    m_available.wakeOne();
+}
+
+int ConnectionPool::evictIdle()
+{
+    QList<PoolEntry *> victims;
+    {
+        QMutexLocker locker(&m_mutex);
+        const qint64 now = m_clock.elapsed();
+        // 头部是最久未使用的
+        while (!m_idle.isEmpty() && m_total > m_options.minSize
+               && now - m_idle.first()->lastUsedMs > m_options.idleTimeoutMs) {
+            victims.append(m_idle.takeFirst());
+            --m_total;
+        }
+        m_stats.evictedCount += victims.size();
+    }
+
+    for (PoolEntry *entry : victims) {
+        entry->db.moveToThread(QThread::currentThread());
+        destroyEntry(entry);
+    }
+    if (!victims.isEmpty()) {
+        qDebug() << "连接池" << m_name << "回收空闲连接:" << victims.size();
+    }
+    return victims.size();
+}
+
+PoolStats ConnectionPool::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    PoolStats s = m_stats;
+    s.total = m_total;
+    s.idle = m_idle.size();
+    s.inUse = m_total - m_idle.size();
+    return s;
+}
+
+PoolEntry *ConnectionPool::openEntry()
+{
+    quint64 serial;
+    {
+        QMutexLocker locker(&m_mutex);
+        serial = ++m_serial;
+    }
+
+    auto *entry = new PoolEntry(m_options.statementCacheSize);
+    entry->connectionName = QString("%1_%2").arg(m_name).arg(serial);
+
+    QSqlDatabase db = QSqlDatabase::addDatabase(m_options.driver, entry->connectionName);
+    db.setHostName(m_options.host);
+    db.setPort(m_options.port);
+    db.setDatabaseName(m_options.databaseName);
+    db.setUserName(m_options.userName);
+    db.setPassword(m_options.password);
+    db.setConnectOptions(m_options.connectOptions);
+    if (!db.open() || !initConnection(db)) {
+        qWarning() << "DB Error:" << db.lastError().text();
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(entry->connectionName);
+        delete entry;
+        return nullptr;
+    }
+    entry->db = db;
+    entry->immediateTransactions = m_options.immediateTransactions;
+
+    QMutexLocker locker(&m_mutex);
+    ++m_stats.createdCount;
+    return entry;
+}
+
+bool ConnectionPool::validate(PoolEntry *entry)
+{
+    qint64 idleMs;
+    {
+        QMutexLocker locker(&m_mutex);
+        idleMs = m_clock.elapsed() - entry->lastUsedMs;
+    }
+    if (idleMs < m_options.validateAfterIdleMs && entry->db.isOpen()) {
+        return true;
+    }
+
+    // ping：MySQL 默认 8 小时断开空闲连接，这里提前发现并重连
+    // (SQLite 内存库只有一条连接，重连后是一个新的空库，这种情况实际不会发生)
+    {
+        QSqlQuery ping(entry->db);
+        if (entry->db.isOpen() && ping.exec("SELECT 1")) {
+            return true;
+        }
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        ++m_stats.pingFailures;
+    }
+    qWarning() << "连接" << entry->connectionName << "已失效，尝试重连";
+    entry->statements.clear(); // 旧连接上的预编译语句随连接一起失效
+    entry->db.close();
+    if (!entry->db.open() || !initConnection(entry->db)) {
+        qWarning() << "DB Error:" << entry->db.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool ConnectionPool::initConnection(QSqlDatabase &db)
+{
+    for (const QString &sql : m_options.initStatements) {
+        QSqlQuery init(db);
+        if (!init.exec(sql)) {
+            qWarning() << "连接初始化失败:" << sql << init.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+void ConnectionPool::destroyEntry(PoolEntry *entry)
+{
+    const QString name = entry->connectionName;
+    entry->statements.clear();
+    entry->db.close();
+    entry->db = QSqlDatabase();
+    delete entry;
+    QSqlDatabase::removeDatabase(name);
+}
@@ -0,0 +1,217 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include "StatementCache.h"
+#include "Metrics.h"
+#include "Tracer.h"
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class ConnectionPool;
+
+// 连接参数 + 池参数 (由 DatabaseManager 从 config.ini 填充)
+struct ConnectionOptions {
+    QString driver = "QMYSQL";
+    QString host = "localhost";
+    int port = 3306;
+    QString databaseName = "flight_system";
+    QString userName = "root";
+    QString password;
+    QString connectOptions;           // QSqlDatabase::setConnectOptions (驱动相关，例如 QSQLITE_BUSY_TIMEOUT)
+    QStringList initStatements;       // 每条连接建立 (含重连) 后执行一次，例如 SQLite 的 PRAGMA
+    bool immediateTransactions = false; // 事务用 BEGIN IMMEDIATE 开启 (SQLite：一开始就拿写锁，不会在升级时失败)
+
+    int minSize = 2;                  // 启动时预热、空闲回收时至少保留的连接数
+    int maxSize = 16;                 // 同时存在的连接上限 (决定数据库最大并发)
+    int idleTimeoutMs = 300000;       // 空闲超过该时间的连接会被回收 (保留 minSize 个)
+    int borrowTimeoutMs = 5000;       // 池满时最多等待多久
+    int validateAfterIdleMs = 5000;   // 借出前若空闲超过该时间则先 ping 一次，0 表示每次都 ping
+    int statementCacheSize = 64;      // 每条连接缓存的预编译语句条数，0 表示不缓存
+};
+
+// 连接池统计快照
+struct PoolStats {
+    int total = 0;
+    int idle = 0;
+    int inUse = 0;
+    int minSize = 0;
+    int maxSize = 0;
+    quint64 borrowCount = 0;     // 成功借出的次数
+    quint64 waitCount = 0;       // 需要排队等待的次数
+    quint64 timeoutCount = 0;    // 等待超时的次数
+    quint64 totalWaitUs = 0;     // 累计等待时间 (微秒)
+    quint64 maxWaitUs = 0;       // 最长一次等待 (微秒)
+    quint64 createdCount = 0;    // 新建的物理连接数
+    quint64 evictedCount = 0;    // 因空闲被回收的连接数
+    quint64 pingFailures = 0;    // 借出前检测发现失效的次数
+    quint64 statementHits = 0;   // 预编译语句缓存命中 (省掉一次 prepare 往返)
+    quint64 statementMisses = 0; // 预编译语句缓存未命中 (需要 prepare)
+    quint64 statementEvictions = 0; // 因超出条数上限被淘汰的预编译语句
+};
+
+// 池内的一条物理连接
+struct PoolEntry {
+    explicit PoolEntry(int statementCacheSize) : statements(statementCacheSize) {}
+
+    QString connectionName;
+    QSqlDatabase db;
+    qint64 lastUsedMs = 0;       // 最近一次归还的时间 (池内单调时钟)
+    bool inTransaction = false;  // 借用者开启了事务但尚未提交/回滚
+    bool immediateTransactions = false; // 见 ConnectionOptions::immediateTransactions
+    StatementCache statements;   // 这条连接上的预编译语句
+};
+
+// ==============================================================================
+//  RAII 连接句柄：析构 (或 release()) 时自动归还连接池
+//  用法与 QSqlDatabase 基本一致：QSqlQuery query(db); db.transaction(); ...
+//  注意：句柄必须比基于它创建的 QSqlQuery 活得久 (在函数开头声明即可)
+//  固定文本的 SQL 用 prepared() 取连接上缓存的语句：QSqlQuery &query = db.prepared("...");
+// ==============================================================================
+class PooledConnection {
+public:
+    PooledConnection() = default;
+    ~PooledConnection() { release(); }
+
+    PooledConnection(PooledConnection &&other) noexcept
+        : m_pool(other.m_pool), m_entry(other.m_entry) {
+        other.m_pool = nullptr;
+        other.m_entry = nullptr;
+    }
+    PooledConnection &operator=(PooledConnection &&other) noexcept {
+        if (this != &other) {
+            release();
+            m_pool = other.m_pool;
+            m_entry = other.m_entry;
+            other.m_pool = nullptr;
+            other.m_entry = nullptr;
+        }
+        return *this;
+    }
+    PooledConnection(const PooledConnection &) = delete;
+    PooledConnection &operator=(const PooledConnection &) = delete;
+
+    bool isValid() const { return m_entry != nullptr; }
+    bool isOpen() const { return m_entry && m_entry->db.isOpen(); }
+
+    QSqlDatabase &database() { return m_entry ? m_entry->db : invalidDatabase(); }
+
+    bool transaction() {
+        bool ok;
+        if (m_entry && m_entry->immediateTransactions) {
+            // QSqlDatabase::commit()/rollback() 只是执行 COMMIT/ROLLBACK，与这里手动开启的事务配套使用没有问题
+            QSqlQuery begin(m_entry->db);
+            ok = begin.exec("BEGIN IMMEDIATE");
+        } else {
+            ok = database().transaction();
+        }
+        if (ok && m_entry) m_entry->inTransaction = true;
+        return ok;
+    }
+    bool commit() {
+        TraceSpan span("db.commit", "db");
+        if (m_entry) m_entry->inTransaction = false;
+        return database().commit();
+    }
+    bool rollback() {
+        if (m_entry) m_entry->inTransaction = false;
+        return database().rollback();
+    }
+
+    // 允许直接写 QSqlQuery query(db)
+    // 禁止从临时句柄转换 (否则连接会在语句执行前就被归还)
+    operator const QSqlDatabase &() const & { return m_entry ? m_entry->db : invalidDatabase(); }
+    operator const QSqlDatabase &() const && = delete;
+
+    // 取这条连接上缓存的预编译语句 (已 prepare，绑定参数后直接 exec)
+    // 返回的引用在连接归还之前有效；只用于文本固定的 SQL，拼接出来的 SQL 仍然用 QSqlQuery query(db)
+    QSqlQuery &prepared(const QString &sql) {
+        if (m_entry) return m_entry->statements.acquire(m_entry->db, sql);
+        static thread_local QSqlQuery invalid;
+        invalid = QSqlQuery(invalidDatabase());
+        return invalid;
+    }
+
+    // 提前归还连接
+    void release();
+
+private:
+    friend class ConnectionPool;
+    PooledConnection(ConnectionPool *pool, PoolEntry *entry) : m_pool(pool), m_entry(entry) {}
+
+    static QSqlDatabase &invalidDatabase() {
+        static thread_local QSqlDatabase invalid;
+        return invalid;
+    }
+
+    ConnectionPool *m_pool = nullptr;
+    PoolEntry *m_entry = nullptr;
+};
+
+// ==============================================================================
+//  有界连接池
+//  - 最多 maxSize 条物理连接，池满时调用方排队等待 (带超时)
+//  - 借出前对空闲过久的连接做一次 ping，失效则自动重连
+//  - evictIdle() 回收长时间空闲的连接
+//  - 连接可以在不同线程之间复用：借出时把驱动迁移到当前线程，归还时解除线程归属
+// ==============================================================================
+class ConnectionPool {
+public:
+    ConnectionPool(const QString &name, const ConnectionOptions &options);
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool &) = delete;
+    ConnectionPool &operator=(const ConnectionPool &) = delete;
+
+    // 预热 minSize 条连接；第一条都连不上时返回 false
+    bool warmUp();
+
+    // 借出一条连接；timeoutMs < 0 时使用配置的 borrowTimeoutMs
+    // 超时或连接失败时返回无效句柄 (isValid() == false)
+    PooledConnection acquire(int timeoutMs = -1);
+
+    // 回收空闲超过 idleTimeoutMs 的连接 (保留 minSize 条)
+    int evictIdle();
+
+    PoolStats stats() const;
+    const ConnectionOptions &options() const { return m_options; }
+    QString name() const { return m_name; }
+
+private:
+    friend class PooledConnection;
+    void giveBack(PoolEntry *entry);
+
+    PoolEntry *openEntry();
+    bool initConnection(QSqlDatabase &db);
+    bool validate(PoolEntry *entry);
+    void destroyEntry(PoolEntry *entry);
+
+    const QString m_name;
+    const ConnectionOptions m_options;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_available;
+    QElapsedTimer m_clock;
+    QList<PoolEntry *> m_idle;   // 尾部是最近归还的 (LIFO，热连接优先)
+    int m_total = 0;             // 已创建 (含正在创建) 的连接数
+    quint64 m_serial = 0;
+    PoolStats m_stats;
+    MetricHistogram *m_waitHistogram = nullptr;  // 借连接的等待时间 (/metrics)
+};
+
+inline void PooledConnection::release()
+{
+    if (m_pool && m_entry) {
+        m_pool->giveBack(m_entry);
+    }
+    m_pool = nullptr;
+    m_entry = nullptr;
+}
+
+#endif // CONNECTIONPOOL_H
@@ -2,48 +2,145 @@
 #define DATABASEMANAGER_H
 
 
-#include <QSqlDatabase>
-#include <QThread>
-#include <QDebug>
+#include "AppConfig.h"
+#include "ConnectionPool.h"
+#include "Metrics.h"
+#include "Tracer.h"
+#include "SqlProfiler.h"
+#include "SqlDialect.h"
+#include "ReplicaRouter.h"
+#include <QSqlQuery>
 #include <QSqlError>
-#include <QSettings>
-#include <QCoreApplication>
-#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QDebug>
 
 class DatabaseManager {
 public:
-    static QSqlDatabase getConnection() {
-        // 用当前线程的 ID 作为连接的唯一名称
-        const QString connectionName = QString("conn_%1").arg((quintptr)QThread::currentThreadId());
-        // applicationDirPath() 指向的是 .exe 所在的目录
-        QString configPath = QCoreApplication::applicationDirPath() + "/config.ini";
-
-        // 检查文件是否存在
-        if (!QFileInfo::exists(configPath)) {
-            qWarning() << "配置文件 config.ini 未找到！请拷贝 config.example.ini 并修改配置。";
-            return QSqlDatabase();
+    // 从连接池借一条连接，句柄析构时自动归还
+    // 用法：PooledConnection db = DatabaseManager::getConnection();
+    static PooledConnection getConnection() {
+        TraceSpan span("db.acquire", "db");
+        return pool().acquire();
+    }
+
+    // 只读查询借连接：配置了 [Replica] 时走健康的只读副本，否则与 getConnection() 相同
+    // uid 为数据所属的用户，该用户刚写过 (noteWrite) 时仍然走主库，保证读到自己的写
+    // 事务里要先读后写的地方 (锁座、扣款) 不要用它
+    static PooledConnection getReadConnection(int uid = 0) {
+        TraceSpan span("db.acquire", "db");
+        return ReplicaRouter::instance().acquireRead(uid);
+    }
+
+    // 用户的写事务提交之后调用，之后一小段时间内该用户的读走主库
+    static void noteWrite(int uid) {
+        ReplicaRouter::instance().noteWrite(uid);
+    }
+
+    // 执行语句并记录耗时 (按 SELECT/INSERT/UPDATE/DELETE 分类的直方图和出错次数，死锁/等锁超时另外计数，见 /metrics)
+    // 同时按归一化 SQL 汇总到 SqlProfiler (慢查询日志、EXPLAIN，见 /api/admin/sql_stats)
+    // 请求正在被追踪时再记一个 db.exec 区间 (带 SQL 文本，不含参数值)
+    // 用法与 query.exec() 相同：DatabaseManager::exec(query) / DatabaseManager::exec(query, "SELECT ...")
+    static bool exec(QSqlQuery &query) {
+        TraceSpan span("db.exec", "db");
+        QElapsedTimer timer;
+        timer.start();
+        const bool ok = query.exec();
+        const qint64 elapsedNs = timer.nsecsElapsed();
+        recordQuery(query.lastQuery(), elapsedNs, ok);
+        if (!ok) recordLockError(query.lastError());
+        SqlProfiler::instance().record(query.lastQuery(), elapsedNs, ok, query);
+        if (span.isActive()) span.setDetail(query.lastQuery());
+        return ok;
+    }
+    static bool exec(QSqlQuery &query, const QString &sql) {
+        TraceSpan span("db.exec", "db");
+        QElapsedTimer timer;
+        timer.start();
+        const bool ok = query.exec(sql);
+        const qint64 elapsedNs = timer.nsecsElapsed();
+        recordQuery(sql, elapsedNs, ok);
+        if (!ok) recordLockError(query.lastError());
+        SqlProfiler::instance().record(sql, elapsedNs, ok, query);
+        if (span.isActive()) span.setDetail(sql);
+        return ok;
+    }
+
+    // 是否为唯一键冲突 (MySQL 1062: Duplicate entry / SQLite: UNIQUE constraint failed)
+    static bool isDuplicateKeyError(const QSqlError &error) {
+        return SqlDialect::isDuplicateKey(error);
+    }
+
+    // 主库连接池 (配置只在第一次访问时读取)
+    static ConnectionPool &pool() {
+        static ConnectionPool instance("conn", loadOptions());
+        return instance;
+    }
+
+private:
+    // 按语句的第一个关键字归类，只看开头几个字符，不做完整解析
+    static void recordQuery(const QString &sql, qint64 elapsedNs, bool ok) {
+        static const char *const kinds[] = {"select", "insert", "update", "delete", "other"};
+        struct Series { MetricHistogram *duration; MetricCounter *errors; };
+        static const std::vector<Series> series = [] {
+            std::vector<Series> v;
+            for (const char *kind : kinds) {
+                const QString label = QString("op=\"%1\"").arg(kind);
+                v.push_back({Metrics::instance().histogram("db_query_duration_seconds", "SQL statement execution time", label),
+                             Metrics::instance().counter("db_query_errors_total", "Failed SQL statements", label)});
+            }
+            return v;
+        }();
+
+        const QStringView head = QStringView(sql).trimmed().left(6);
+        int kind = 4;
+        for (int i = 0; i < 4; ++i) {
+            if (head.compare(QLatin1String(kinds[i]), Qt::CaseInsensitive) == 0) { kind = i; break; }
         }
+        series[kind].duration->observeNs(elapsedNs);
+        if (!ok) series[kind].errors->inc();
+    }
 
-        QSettings settings(configPath, QSettings::IniFormat);
+    // 锁冲突单独计数 (MySQL 1213: 死锁，整个事务已被回滚；1205 / SQLite SQLITE_BUSY: 等锁超时)
+    static void recordLockError(const QSqlError &error) {
+        static MetricCounter *deadlocks = Metrics::instance().counter(
+            "db_lock_errors_total", "Statements failed by lock conflicts", "kind=\"deadlock\"");
+        static MetricCounter *timeouts = Metrics::instance().counter(
+            "db_lock_errors_total", "Statements failed by lock conflicts", "kind=\"lock_wait_timeout\"");
+        if (SqlDialect::isDeadlock(error)) deadlocks->inc();
+        else if (SqlDialect::isLockTimeout(error)) timeouts->inc();
+    }
 
-        if (QSqlDatabase::contains(connectionName)) {
-            return QSqlDatabase::database(connectionName, false);
+    static ConnectionOptions loadOptions() {
+        ConnectionOptions opt;
+        if (!AppConfig::exists()) {
+            return opt;
         }
 
-        QString dbHost = settings.value("Database/Host", "localhost").toString();
-        QString dbName = settings.value("Database/Name", "flight_system").toString();
-        QString dbUser = settings.value("Database/User", "root").toString();
-        QString dbPass = settings.value("Database/Password", "").toString(); // 默认为空，强迫用户配置
-
-        QSqlDatabase db = QSqlDatabase::addDatabase("QMYSQL", connectionName);
-        db.setHostName(dbHost);
-        db.setDatabaseName(dbName);
-        db.setUserName(dbUser);
-        db.setPassword(dbPass);
-        if (!db.open()) {
-            qWarning() << "DB Error:" << db.lastError().text();
+        opt.host = AppConfig::value("Database/Host", "localhost").toString();
+        opt.port = AppConfig::value("Database/Port", 3306).toInt();
+        opt.databaseName = AppConfig::value("Database/Name", "flight_system").toString();
+        opt.userName = AppConfig::value("Database/User", "root").toString();
+        opt.password = AppConfig::value("Database/Password", "").toString(); // 默认为空，强迫用户配置
+
+        opt.minSize = AppConfig::value("Database/PoolMinSize", opt.minSize).toInt();
+        opt.maxSize = qMax(1, AppConfig::value("Database/PoolMaxSize", opt.maxSize).toInt());
+        opt.minSize = qBound(0, opt.minSize, opt.maxSize);
+        opt.idleTimeoutMs = AppConfig::value("Database/PoolIdleTimeoutSec", opt.idleTimeoutMs / 1000).toInt() * 1000;
+        opt.borrowTimeoutMs = AppConfig::value("Database/PoolBorrowTimeoutMs", opt.borrowTimeoutMs).toInt();
+        opt.validateAfterIdleMs = AppConfig::value("Database/PoolValidateAfterIdleMs", opt.validateAfterIdleMs).toInt();
+        opt.statementCacheSize = qMax(0, AppConfig::value("Database/StatementCacheSize", opt.statementCacheSize).toInt());
+
+        // 嵌入式 SQLite：库文件代替主机/账号；写事务在库级别串行，等锁最多 SqliteBusyTimeoutMs
+        opt.driver = SqlDialect::driverName();
+        if (SqlDialect::isSqlite()) {
+            opt.databaseName = SqlDialect::sqlitePath();
+            opt.connectOptions = "QSQLITE_BUSY_TIMEOUT=" + QString::number(AppConfig::value("Database/SqliteBusyTimeoutMs", 5000).toInt());
+            opt.initStatements = SqlDialect::sqliteInitStatements();
+            opt.immediateTransactions = true;
+            // 内存库只存在于打开它的那条连接里，整个池只能有这一条连接
+            if (SqlDialect::isSqliteInMemory()) opt.minSize = opt.maxSize = 1;
         }
-        return db;
+        return opt;
     }
 };
 
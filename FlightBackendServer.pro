@@ -7,7 +7,9 @@
 #    network: 网络功能 (QHttpServer 需要)
 #    sql:     数据库功能 (QSqlDatabase 需要)
 #    httpserver: HTTP 服务器功能 (QHttpServer 主体)
-QT += core network sql httpserver
+#    concurrent: 工作线程池 (路由处理函数在线程池中执行，返回 QFuture)
+#    (连接池跨线程复用连接用到了 QSqlDatabase::moveToThread，需要 Qt 6.8 及以上)
+QT += core network sql httpserver concurrent
 
 # 2. 告诉编译器，我们要使用 C++ 17 标准
 #    (QHttpServer 依赖 C++17 的特性)
@@ -21,20 +23,58 @@ CONFIG -= app_bundle
 #    SOURCES: .cpp 源文件 (定义了“怎么做”)
 #    (我们稍后会创建这些文件)
 SOURCES += \
+    CityDirectory.cpp \
+    ConnectionPool.cpp \
+    FlightStore.cpp \
+    JsonStreamWriter.cpp \
+    Metrics.cpp \
+    MonitorController.cpp \
     OrderController.cpp \
+    OrderExpiryScheduler.cpp \
     aicontroller.cpp \
     PaymentController.cpp \
+    QueryPlanCheck.cpp \
+    ReplicaRouter.cpp \
+    SeatCounters.cpp \
+    SearchCache.cpp \
+    SqlDialect.cpp \
+    SqlProfiler.cpp \
+    StatementCache.cpp \
+    Tracer.cpp \
+    SeatInventory.cpp \
+    UserProfileCache.cpp \
     flightcontroller.cpp \
     logincontroller.cpp \
     main.cpp \
     usercontroller.cpp
 
 HEADERS += \
+    AppConfig.h \
     BaseController.h \
+    CityDirectory.h \
+    ConnectionPool.h \
     DatabaseManager.h \
+    FlightQueries.h \
+    FlightStore.h \
+    JsonStreamWriter.h \
+    Metrics.h \
+    MonitorController.h \
     OrderController.h \
+    OrderExpiryScheduler.h \
+    OrderQueries.h \
     aicontroller.h \
     PaymentController.h \
+    QueryPlanCheck.h \
+    ReplicaRouter.h \
+    SeatCounters.h \
+    SearchCache.h \
+    SqlDialect.h \
+    SqlProfiler.h \
+    StatementCache.h \
+    StreamBackpressure.h \
+    Tracer.h \
+    SeatInventory.h \
+    UserProfileCache.h \
     flightcontroller.h \
     logincontroller.h \
     usercontroller.h
@@ -47,4 +87,6 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 DISTFILES += \
     .gitignore \
     config.ini \
-    flight_system.sql
+    flight_system.sql \
+    flight_system.sqlite.sql \
+    flight_system_upgrade.sql
@@ -0,0 +1,38 @@
+#ifndef FLIGHTQUERIES_H
+#define FLIGHTQUERIES_H
+
+#include <QSqlQuery>
+#include <QDate>
+#include <QString>
+
+// ==============================================================================
+//  航班查询共用的 SQL (FlightController、AIController 以及 --check-query-plans 共用同一份文本)
+// ==============================================================================
+class FlightQueries {
+public:
+    // 按 航线 + 出发日期 查航班
+    // departure_time 用半开区间 [当天 00:00:00, 次日 00:00:00) 比较，而不是 DATE(departure_time) = ?，
+    // 这样才能用上 idx_route_time (origin, destination, departure_time) 做范围扫描
+    // 余座是 flight_seat_inventory 里该舱位各分片之和，按主键前缀 (flight_id, seat_type) 取几行，每个航班是 O(1) 的代价
+    // 按起飞时间 (相同时按 ID) 排序，与 FlightStore::search 的顺序一致；范围扫描本来就按这个顺序出行，不需要额外排序
+    static QString searchByRouteDaySql() {
+        return QStringLiteral("SELECT f.*, "
+                              "(SELECT SUM(i.remaining) FROM flight_seat_inventory i WHERE i.flight_id = f.ID AND i.seat_type = 0) AS economy_remaining, "
+                              "(SELECT SUM(i.remaining) FROM flight_seat_inventory i WHERE i.flight_id = f.ID AND i.seat_type = 1) AS business_remaining, "
+                              "(SELECT SUM(i.remaining) FROM flight_seat_inventory i WHERE i.flight_id = f.ID AND i.seat_type = 2) AS first_class_remaining "
+                              "FROM flights f "
+                              "WHERE f.origin = ? AND f.destination = ? "
+                              "AND f.departure_time >= ? AND f.departure_time < ? "
+                              "ORDER BY f.departure_time, f.ID");
+    }
+
+    // 绑定 searchByRouteDaySql() 的 4 个参数
+    static void bindRouteDay(QSqlQuery &query, const QString &origin, const QString &destination, const QDate &date) {
+        query.addBindValue(origin);
+        query.addBindValue(destination);
+        query.addBindValue(date.toString("yyyy-MM-dd") + " 00:00:00");
+        query.addBindValue(date.addDays(1).toString("yyyy-MM-dd") + " 00:00:00");
+    }
+};
+
+#endif // FLIGHTQUERIES_H
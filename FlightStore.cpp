@@ -0,0 +1,323 @@
+#include "FlightStore.h"
+#include "DatabaseManager.h"
+
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlError>
+#include <QDebug>
+#include <algorithm>
+
+// 整表加载和单行刷新共用的列列表 (按下标取值，不再逐行按列名查找)
+// 余座是 flight_seat_inventory 里该舱位各分片之和，按主键前缀取
+static const char *kFlightColumns =
+    "SELECT f.ID, f.flight_number, f.origin, f.destination, f.departure_time, f.landing_time, "
+    "f.airline, f.aircraft_model, "
+    "f.economy_seats, f.business_seats, f.first_class_seats, "
+    "f.economy_price, f.business_price, f.first_class_price, "
+    "(SELECT SUM(i.remaining) FROM flight_seat_inventory i WHERE i.flight_id = f.ID AND i.seat_type = 0), "
+    "(SELECT SUM(i.remaining) FROM flight_seat_inventory i WHERE i.flight_id = f.ID AND i.seat_type = 1), "
+    "(SELECT SUM(i.remaining) FROM flight_seat_inventory i WHERE i.flight_id = f.ID AND i.seat_type = 2) "
+    "FROM flights f";
+
+static FlightRecord readFlightRecord(const QSqlQuery &query)
+{
+    FlightRecord r;
+    r.id = query.value(0).toInt();
+    r.flightNumber = query.value(1).toString();
+    r.origin = query.value(2).toString();
+    r.destination = query.value(3).toString();
+    r.departureTime = query.value(4).toDateTime();
+    r.landingTime = query.value(5).toDateTime();
+    r.airline = query.value(6).toString();
+    r.aircraftModel = query.value(7).toString();
+    for (int c = 0; c < 3; ++c) {
+        r.seats[c] = query.value(8 + c).toInt();
+        r.prices[c] = query.value(11 + c).toInt();
+        r.remaining[c] = query.value(14 + c).toInt();
+    }
+    return r;
+}
+
+// ------------------------------------------------------------------
+// 内部结构
+// ------------------------------------------------------------------
+qint32 FlightStore::Dictionary::encode(const QString &value)
+{
+    auto it = ids.constFind(value);
+    if (it != ids.constEnd()) return it.value();
+    const qint32 id = qint32(values.size());
+    ids.insert(value, id);
+    values.append(value);
+    return id;
+}
+
+int FlightStore::Partition::rowOf(int flightId) const
+{
+    auto it = std::find(id.begin(), id.end(), flightId);
+    return it == id.end() ? -1 : int(it - id.begin());
+}
+
+void FlightStore::Partition::removeAt(int row)
+{
+    const int last = rowCount() - 1;
+    auto moveLast = [row, last](auto &column) {
+        if (row != last) column[row] = std::move(column[last]);
+        column.pop_back();
+    };
+    moveLast(id);
+    moveLast(departMinute);
+    moveLast(landMinute);
+    moveLast(airlineId);
+    moveLast(modelId);
+    for (int c = 0; c < 3; ++c) {
+        moveLast(seats[c]);
+        moveLast(prices[c]);
+        moveLast(remaining[c]);
+    }
+    moveLast(flightNumber);
+}
+
+// ------------------------------------------------------------------
+// FlightStore
+// ------------------------------------------------------------------
+FlightStore &FlightStore::instance()
+{
+    static FlightStore store;
+    return store;
+}
+
+bool FlightStore::reload(const QSqlDatabase &db)
+{
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!DatabaseManager::exec(query, kFlightColumns)) {
+        qWarning() << "Load Flight Store Error:" << query.lastError().text();
+        return false;
+    }
+
+    QList<FlightRecord> records;
+    while (query.next()) {
+        records.append(readFlightRecord(query));
+    }
+
+    QWriteLocker locker(&m_lock);
+    m_cities = Dictionary();
+    m_airlines = Dictionary();
+    m_models = Dictionary();
+    m_routes.clear();
+    m_routeCities.clear();
+    m_partitions.clear();
+    m_partitionOf.clear();
+    m_size = 0;
+    for (const FlightRecord &r : records) {
+        insertLocked(r);
+    }
+    m_loaded = true;
+
+    qInfo() << "航班内存库已加载:" << m_size << "个航班," << m_partitions.size() << "个航线日期分区";
+    return true;
+}
+
+bool FlightStore::refreshFlight(const QSqlDatabase &db, int flightId, FlightRecord *current)
+{
+    QSqlQuery query(db);
+    query.prepare(QString(kFlightColumns) + " WHERE f.ID = ?");
+    query.addBindValue(flightId);
+    if (!DatabaseManager::exec(query)) {
+        qWarning() << "Refresh Flight Store Error:" << query.lastError().text();
+        return false;
+    }
+
+    const bool exists = query.next();
+    FlightRecord record;
+    if (exists) record = readFlightRecord(query);
+    if (current) *current = record;
+
+    QWriteLocker locker(&m_lock);
+    if (!m_loaded) return true; // 内存库没启用，只是顺便读了一下
+    removeLocked(flightId);
+    if (exists) insertLocked(record);
+    return true;
+}
+
+void FlightStore::removeFlight(int flightId)
+{
+    QWriteLocker locker(&m_lock);
+    removeLocked(flightId);
+}
+
+void FlightStore::adjustRemaining(int flightId, int seatType, int delta)
+{
+    if (seatType < 0 || seatType > 2) return;
+
+    QWriteLocker locker(&m_lock);
+    auto loc = m_partitionOf.constFind(flightId);
+    if (loc == m_partitionOf.constEnd()) return;
+    auto it = m_partitions.find(loc.value());
+    if (it == m_partitions.end()) return;
+    const int row = it->rowOf(flightId);
+    if (row >= 0) it->remaining[seatType][row] += delta;
+}
+
+bool FlightStore::isLoaded() const
+{
+    QReadLocker locker(&m_lock);
+    return m_loaded;
+}
+
+int FlightStore::size() const
+{
+    QReadLocker locker(&m_lock);
+    return m_size;
+}
+
+bool FlightStore::find(int flightId, FlightRecord *record) const
+{
+    QReadLocker locker(&m_lock);
+    auto loc = m_partitionOf.constFind(flightId);
+    if (loc == m_partitionOf.constEnd()) return false;
+    auto it = m_partitions.constFind(loc.value());
+    if (it == m_partitions.constEnd()) return false;
+    const int row = it->rowOf(flightId);
+    if (row < 0) return false;
+
+    // 分区 key 的高 32 位是航线 ID，反查出发/到达城市
+    const QPair<qint32, qint32> &cities = m_routeCities.at(qint32(loc.value() >> 32));
+    *record = materialize(it.value(), row, m_cities.values.at(cities.first), m_cities.values.at(cities.second));
+    return true;
+}
+
+qint32 FlightStore::routeId(const QString &origin, const QString &destination) const
+{
+    const qint32 from = m_cities.find(origin);
+    const qint32 to = m_cities.find(destination);
+    if (from < 0 || to < 0) return -1;
+    return m_routes.value(qMakePair(from, to), -1);
+}
+
+qint32 FlightStore::encodeRoute(const QString &origin, const QString &destination)
+{
+    const auto key = qMakePair(m_cities.encode(origin), m_cities.encode(destination));
+    auto it = m_routes.constFind(key);
+    if (it != m_routes.constEnd()) return it.value();
+    const qint32 id = qint32(m_routes.size());
+    m_routes.insert(key, id);
+    m_routeCities.append(key);
+    return id;
+}
+
+void FlightStore::insertLocked(const FlightRecord &r)
+{
+    const QDate date = r.departureTime.date();
+    const quint64 key = partitionKey(encodeRoute(r.origin, r.destination), date);
+
+    Partition &p = m_partitions[key];
+    p.date = date;
+    p.id.push_back(r.id);
+    p.departMinute.push_back(r.departureTime.time().msecsSinceStartOfDay() / 60000);
+    // 落地时间相对起飞当天 0 点计算，跨天航班自然大于 1440
+    p.landMinute.push_back(qint32(date.daysTo(r.landingTime.date()) * 1440
+                                  + r.landingTime.time().msecsSinceStartOfDay() / 60000));
+    p.airlineId.push_back(m_airlines.encode(r.airline));
+    p.modelId.push_back(m_models.encode(r.aircraftModel));
+    for (int c = 0; c < 3; ++c) {
+        p.seats[c].push_back(r.seats[c]);
+        p.prices[c].push_back(r.prices[c]);
+        p.remaining[c].push_back(r.remaining[c]);
+    }
+    p.flightNumber.push_back(r.flightNumber);
+
+    m_partitionOf.insert(r.id, key);
+    ++m_size;
+}
+
+void FlightStore::removeLocked(int flightId)
+{
+    auto loc = m_partitionOf.find(flightId);
+    if (loc == m_partitionOf.end()) return;
+
+    auto it = m_partitions.find(loc.value());
+    if (it != m_partitions.end()) {
+        const int row = it->rowOf(flightId);
+        if (row >= 0) {
+            it->removeAt(row);
+            --m_size;
+        }
+        if (it->rowCount() == 0) m_partitions.erase(it);
+    }
+    m_partitionOf.erase(loc);
+}
+
+FlightRecord FlightStore::materialize(const Partition &p, int row, const QString &origin, const QString &destination) const
+{
+    FlightRecord r;
+    r.id = p.id[row];
+    r.flightNumber = p.flightNumber[row];
+    r.origin = origin;
+    r.destination = destination;
+    const QDateTime dayStart = p.date.startOfDay();
+    r.departureTime = dayStart.addSecs(qint64(p.departMinute[row]) * 60);
+    r.landingTime = dayStart.addSecs(qint64(p.landMinute[row]) * 60);
+    r.airline = m_airlines.values.at(p.airlineId[row]);
+    r.aircraftModel = m_models.values.at(p.modelId[row]);
+    for (int c = 0; c < 3; ++c) {
+        r.seats[c] = p.seats[c][row];
+        r.prices[c] = p.prices[c][row];
+        r.remaining[c] = p.remaining[c][row];
+    }
+    return r;
+}
+
+QList<FlightRecord> FlightStore::search(const FlightFilter &filter) const
+{
+    QList<FlightRecord> result;
+
+    QReadLocker locker(&m_lock);
+
+    // 1. 航线 + 日期 -> 分区 (一次哈希)
+    const qint32 route = routeId(filter.origin, filter.destination);
+    if (route < 0) return result;
+    auto it = m_partitions.constFind(partitionKey(route, filter.date));
+    if (it == m_partitions.constEnd()) return result;
+    const Partition &p = it.value();
+
+    // 航空公司先编码成 int，不存在的航司直接返回空
+    qint32 airline = -1;
+    if (!filter.airline.isEmpty()) {
+        airline = m_airlines.find(filter.airline);
+        if (airline < 0) return result;
+    }
+    const bool anyAirline = airline < 0;
+
+    // 2. 列式过滤：只读几列紧凑的 int 数组，条件用 & 合并、没有分支，
+    //    命中的行号无条件写入选择向量，游标按命中与否前进
+    const int n = p.rowCount();
+    const qint32 *depart = p.departMinute.data();
+    const qint32 *price = p.prices[qBound(0, filter.priceCabin, 2)].data();
+    const qint32 *airlines = p.airlineId.data();
+    const qint32 from = filter.departFromMinute;
+    const qint32 to = filter.departToMinute;
+    const qint32 minPrice = filter.minPrice;
+    const qint32 maxPrice = filter.maxPrice;
+
+    std::vector<qint32> selected(size_t(n) + 1);
+    int count = 0;
+    for (int i = 0; i < n; ++i) {
+        const bool hit = (depart[i] >= from) & (depart[i] < to)
+                         & (price[i] >= minPrice) & (price[i] <= maxPrice)
+                         & (anyAirline | (airlines[i] == airline));
+        selected[count] = i;
+        count += hit;
+    }
+
+    // 3. 只把命中的行物化成 FlightRecord，按起飞时间排序 (相同时按 ID，与 SQL 查询的 ORDER BY 一致)
+    const qint32 *ids = p.id.data();
+    std::sort(selected.begin(), selected.begin() + count, [depart, ids](qint32 a, qint32 b) {
+        return depart[a] != depart[b] ? depart[a] < depart[b] : ids[a] < ids[b];
+    });
+    result.reserve(count);
+    for (int k = 0; k < count; ++k) {
+        result.append(materialize(p, selected[k], filter.origin, filter.destination));
+    }
+    return result;
+}
@@ -0,0 +1,135 @@
+#ifndef FLIGHTSTORE_H
+#define FLIGHTSTORE_H
+
+#include <QString>
+#include <QStringList>
+#include <QDate>
+#include <QDateTime>
+#include <QHash>
+#include <QPair>
+#include <QList>
+#include <QReadWriteLock>
+#include <QSqlDatabase>
+#include <vector>
+#include <climits>
+
+// 一条航班的完整信息 (查询结果按行物化出来时使用)
+struct FlightRecord {
+    int id = 0;
+    QString flightNumber;
+    QString origin;
+    QString destination;
+    QDateTime departureTime;
+    QDateTime landingTime;
+    QString airline;
+    QString aircraftModel;
+    int seats[3] = {0, 0, 0};   // 下标与 seat_type 一致：0 经济舱, 1 商务舱, 2 头等舱
+    int prices[3] = {0, 0, 0};
+    int remaining[3] = {0, 0, 0}; // 余座 (flight_seat_inventory)
+};
+
+// 搜索条件：航线 + 日期必填，其余可选
+struct FlightFilter {
+    QString origin;                 // 中文城市名
+    QString destination;
+    QDate date;
+    int departFromMinute = 0;       // 起飞时间窗口 [from, to)，单位：当天第几分钟
+    int departToMinute = 24 * 60;
+    int priceCabin = 0;             // 价格区间作用在哪个舱位上
+    int minPrice = 0;
+    int maxPrice = INT_MAX;
+    QString airline;                // 为空表示不限
+
+    // 逐行判断 (数据库回退路径使用，内存库走列式过滤)
+    bool matches(const FlightRecord &r) const {
+        const int minute = r.departureTime.time().msecsSinceStartOfDay() / 60000;
+        const int price = r.prices[qBound(0, priceCabin, 2)];
+        return minute >= departFromMinute && minute < departToMinute
+               && price >= minPrice && price <= maxPrice
+               && (airline.isEmpty() || r.airline == airline);
+    }
+};
+
+// ==============================================================================
+//  进程内列式航班库
+//  flights 表按 (航线, 起飞日期) 分区，每个分区内按列存放：
+//  时间、价格、座位都是紧凑的 int 数组，航空公司、机型做字典编码成 int，
+//  搜索时一次哈希定位分区，再对几列 int 做无分支的过滤循环 (编译器可以自动向量化)
+//  启动时整表加载，管理员增删改航班后按 ID 增量更新
+// ==============================================================================
+class FlightStore {
+public:
+    static FlightStore &instance();
+
+    // 从 flights 表整表加载 (替换当前内容)
+    bool reload(const QSqlDatabase &db);
+    // 重新读取单个航班 (新增/修改后调用)；数据库里已不存在时从内存删除
+    // current 不为空时写回该航班的最新数据 (航班已不存在时 id 为 0)
+    bool refreshFlight(const QSqlDatabase &db, int flightId, FlightRecord *current = nullptr);
+    // 删除单个航班
+    void removeFlight(int flightId);
+    // 订单事务提交后调整余座 (seatType 已按 cabinIndex 归一)
+    void adjustRemaining(int flightId, int seatType, int delta);
+
+    bool isLoaded() const;
+    int size() const;
+
+    // 按航班 ID 取一行，找不到返回 false
+    bool find(int flightId, FlightRecord *record) const;
+
+    // 按条件过滤，结果按起飞时间排序
+    QList<FlightRecord> search(const FlightFilter &filter) const;
+
+private:
+    // 同一航线同一天的航班，按列存放
+    struct Partition {
+        QDate date;
+        std::vector<qint32> id;
+        std::vector<qint32> departMinute;   // 起飞：当天第几分钟
+        std::vector<qint32> landMinute;     // 落地：相对起飞当天 0 点的分钟数 (跨天时 >= 1440)
+        std::vector<qint32> airlineId;      // 字典编码
+        std::vector<qint32> modelId;        // 字典编码
+        std::vector<qint32> seats[3];
+        std::vector<qint32> prices[3];
+        std::vector<qint32> remaining[3];
+        std::vector<QString> flightNumber;
+
+        int rowCount() const { return int(id.size()); }
+        int rowOf(int flightId) const;
+        void removeAt(int row);             // 与最后一行交换后删除
+    };
+
+    // 字典编码：字符串 <-> 连续的 int
+    struct Dictionary {
+        QHash<QString, qint32> ids;
+        QStringList values;
+        qint32 encode(const QString &value);
+        qint32 find(const QString &value) const { return ids.value(value, -1); }
+    };
+
+    FlightStore() = default;
+
+    static quint64 partitionKey(qint32 routeId, const QDate &date) {
+        return (quint64(quint32(routeId)) << 32) | quint32(date.toJulianDay());
+    }
+    qint32 routeId(const QString &origin, const QString &destination) const;
+    qint32 encodeRoute(const QString &origin, const QString &destination);
+
+    void insertLocked(const FlightRecord &record);
+    void removeLocked(int flightId);
+    FlightRecord materialize(const Partition &p, int row, const QString &origin, const QString &destination) const;
+
+    mutable QReadWriteLock m_lock;
+    bool m_loaded = false;
+    int m_size = 0;
+
+    Dictionary m_cities;
+    Dictionary m_airlines;
+    Dictionary m_models;
+    QHash<QPair<qint32, qint32>, qint32> m_routes;   // (出发城市, 到达城市) -> 航线 ID
+    QList<QPair<qint32, qint32>> m_routeCities;      // 航线 ID -> (出发城市, 到达城市)
+    QHash<quint64, Partition> m_partitions;          // (航线, 日期) -> 分区
+    QHash<int, quint64> m_partitionOf;               // 航班 ID -> 所在分区
+};
+
+#endif // FLIGHTSTORE_H
@@ -0,0 +1,157 @@
+#include "JsonStreamWriter.h"
+
+#include <cmath>
+
+JsonStreamWriter::JsonStreamWriter(qsizetype reserveBytes)
+    : m_reserve(reserveBytes)
+{
+    m_buf.reserve(reserveBytes);
+}
+
+void JsonStreamWriter::setSink(Sink sink, qsizetype chunkBytes)
+{
+    m_sink = std::move(sink);
+    m_chunkBytes = chunkBytes;
+}
+
+void JsonStreamWriter::separator()
+{
+    // key 后面紧跟的值不需要逗号
+    if (m_afterKey) {
+        m_afterKey = false;
+        return;
+    }
+    if (!m_hasItem.empty()) {
+        if (m_hasItem.back()) m_buf.append(',');
+        m_hasItem.back() = true;
+    }
+}
+
+void JsonStreamWriter::beginObject()
+{
+    separator();
+    m_buf.append('{');
+    m_hasItem.push_back(false);
+}
+
+void JsonStreamWriter::endObject()
+{
+    m_buf.append('}');
+    m_hasItem.pop_back();
+    maybeFlush();
+}
+
+void JsonStreamWriter::beginArray()
+{
+    separator();
+    m_buf.append('[');
+    m_hasItem.push_back(false);
+}
+
+void JsonStreamWriter::endArray()
+{
+    m_buf.append(']');
+    m_hasItem.pop_back();
+    maybeFlush();
+}
+
+void JsonStreamWriter::key(const char *name)
+{
+    separator();
+    m_buf.append('"').append(name).append("\":"); // key 都是代码里的常量，不需要转义
+    m_afterKey = true;
+}
+
+void JsonStreamWriter::value(const QString &v)
+{
+    separator();
+    writeString(v);
+}
+
+void JsonStreamWriter::value(const char *v)
+{
+    value(QString::fromUtf8(v));
+}
+
+void JsonStreamWriter::value(int v)
+{
+    separator();
+    m_buf.append(QByteArray::number(v));
+}
+
+void JsonStreamWriter::value(qint64 v)
+{
+    separator();
+    m_buf.append(QByteArray::number(v));
+}
+
+void JsonStreamWriter::value(double v)
+{
+    separator();
+    if (!std::isfinite(v)) {
+        m_buf.append("null"); // JSON 不支持 NaN / Inf
+        return;
+    }
+    m_buf.append(QByteArray::number(v, 'g', 17));
+}
+
+void JsonStreamWriter::value(bool v)
+{
+    separator();
+    m_buf.append(v ? "true" : "false");
+}
+
+void JsonStreamWriter::nullValue()
+{
+    separator();
+    m_buf.append("null");
+}
+
+void JsonStreamWriter::writeString(const QString &s)
+{
+    static const char hex[] = "0123456789abcdef";
+    const QByteArray utf8 = s.toUtf8();
+
+    m_buf.append('"');
+    for (char c : utf8) {
+        const uchar u = uchar(c);
+        switch (c) {
+        case '"':  m_buf.append("\\\""); break;
+        case '\\': m_buf.append("\\\\"); break;
+        case '\n': m_buf.append("\\n"); break;
+        case '\r': m_buf.append("\\r"); break;
+        case '\t': m_buf.append("\\t"); break;
+        default:
+            if (u < 0x20) {
+                const char esc[] = { '\\', 'u', '0', '0', hex[u >> 4], hex[u & 0xF] };
+                m_buf.append(esc, sizeof(esc));
+            } else {
+                m_buf.append(c); // 多字节 UTF-8 原样写入
+            }
+        }
+    }
+    m_buf.append('"');
+}
+
+void JsonStreamWriter::maybeFlush()
+{
+    if (!m_sink || m_buf.size() < m_chunkBytes) return;
+    m_sink(m_buf);
+    m_flushed = true;
+    m_buf.clear();
+    m_buf.reserve(m_reserve);
+}
+
+void JsonStreamWriter::reset()
+{
+    m_buf.clear();
+    m_hasItem.clear();
+    m_afterKey = false;
+}
+
+QByteArray JsonStreamWriter::take()
+{
+    QByteArray out;
+    out.swap(m_buf);
+    return out;
+}
@@ -0,0 +1,72 @@
+#ifndef JSONSTREAMWRITER_H
+#define JSONSTREAMWRITER_H
+
+#include <QByteArray>
+#include <QString>
+#include <functional>
+#include <vector>
+
+// ==============================================================================
+//  流式 JSON 写入器
+//  直接把 JSON 文本追加到预先分配好的 QByteArray，不构造 QJsonObject / QJsonArray。
+//  设置了 sink 之后，缓冲区超过 chunkBytes 就把已写的部分交给 sink (例如作为一个 HTTP chunk 发出去)，
+//  大结果集不会在内存里攒成一整份文档。
+//
+//  用法：
+//      JsonStreamWriter w;
+//      w.beginObject();
+//      w.field("status", "success");
+//      w.key("data"); w.beginArray();
+//      ... w.beginObject(); w.field("id", 1); w.endObject(); ...
+//      w.endArray();
+//      w.endObject();
+//      QByteArray body = w.take();
+// ==============================================================================
+class JsonStreamWriter {
+public:
+    using Sink = std::function<void(const QByteArray &chunk)>;
+
+    explicit JsonStreamWriter(qsizetype reserveBytes = 4096);
+
+    // 缓冲区达到 chunkBytes 时调用 sink；不设置则一直写在内存里
+    void setSink(Sink sink, qsizetype chunkBytes = 64 * 1024);
+    // 是否已经有数据交给了 sink (之后就不能再改响应状态码了)
+    bool hasFlushed() const { return m_flushed; }
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+    void key(const char *name);
+
+    void value(const QString &v);
+    void value(const char *v);
+    void value(int v);
+    void value(qint64 v);
+    void value(double v);
+    void value(bool v);
+    void nullValue();
+
+    template <typename T>
+    void field(const char *name, const T &v) { key(name); value(v); }
+
+    // 丢弃还没交给 sink 的内容，重新开始 (出错时改写成错误信息)
+    void reset();
+    // 取走缓冲区里剩下的内容
+    QByteArray take();
+
+private:
+    void separator();
+    void writeString(const QString &s);
+    void maybeFlush();
+
+    QByteArray m_buf;
+    qsizetype m_reserve;
+    std::vector<bool> m_hasItem;   // 每层容器是否已经写过元素 (决定要不要补逗号)
+    bool m_afterKey = false;
+    Sink m_sink;
+    qsizetype m_chunkBytes = 0;
+    bool m_flushed = false;
+};
+
+#endif // JSONSTREAMWRITER_H
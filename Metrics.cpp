@@ -0,0 +1,190 @@
+#include "Metrics.h"
+
+#include <QMutexLocker>
+#include <algorithm>
+
+int metricShardIndex()
+{
+    static std::atomic<int> nextShard{0};
+    static thread_local const int shard = nextShard.fetch_add(1, std::memory_order_relaxed) % kMetricShards;
+    return shard;
+}
+
+// ==============================================================================
+//  计数器 / 直方图
+// ==============================================================================
+quint64 MetricCounter::value() const
+{
+    quint64 total = 0;
+    for (const Shard &s : m_shards) total += s.value.load(std::memory_order_relaxed);
+    return total;
+}
+
+MetricHistogram::MetricHistogram(const std::vector<double> &boundsSeconds)
+    : m_bounds(boundsSeconds), m_shards(new Shard[kMetricShards])
+{
+    std::sort(m_bounds.begin(), m_bounds.end());
+    if (int(m_bounds.size()) > kMaxBuckets) m_bounds.resize(kMaxBuckets);
+    for (double b : m_bounds) m_boundsUs.push_back(qint64(b * 1e6));
+}
+
+void MetricHistogram::observeUs(qint64 us)
+{
+    if (us < 0) us = 0;
+    // 桶只有十几个，线性查找比二分更快
+    size_t bucket = 0;
+    while (bucket < m_boundsUs.size() && us > m_boundsUs[bucket]) ++bucket;
+
+    Shard &s = m_shards[metricShardIndex()];
+    s.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    s.sumUs.fetch_add(quint64(us), std::memory_order_relaxed);
+}
+
+void MetricHistogram::snapshot(std::vector<quint64> *cumulative, quint64 *count, double *sumSeconds) const
+{
+    const size_t buckets = m_bounds.size() + 1;
+    cumulative->assign(buckets, 0);
+    quint64 sumUs = 0;
+    for (int i = 0; i < kMetricShards; ++i) {
+        const Shard &s = m_shards[i];
+        for (size_t b = 0; b < buckets; ++b) (*cumulative)[b] += s.buckets[b].load(std::memory_order_relaxed);
+        sumUs += s.sumUs.load(std::memory_order_relaxed);
+    }
+    for (size_t b = 1; b < buckets; ++b) (*cumulative)[b] += (*cumulative)[b - 1];
+    // 各字段分别读取，抓取时恰好有写入的话单独的 count 可能和 +Inf 桶差几个，这里直接用 +Inf 桶保持一致
+    *count = cumulative->back();
+    *sumSeconds = double(sumUs) / 1e6;
+}
+
+// ==============================================================================
+//  注册表
+// ==============================================================================
+Metrics &Metrics::instance()
+{
+    static Metrics metrics;
+    return metrics;
+}
+
+const std::vector<double> &Metrics::latencyBuckets()
+{
+    static const std::vector<double> buckets = {0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+                                                0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+    return buckets;
+}
+
+QString Metrics::escapeLabel(const QString &value)
+{
+    QString out = value;
+    out.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    return out;
+}
+
+Metrics::Series *Metrics::seriesLocked(const QString &name, const QString &help, bool isHistogram, const QString &labels)
+{
+    Family *family = m_byName.value(name);
+    if (!family) {
+        m_families.push_back(std::make_unique<Family>());
+        family = m_families.back().get();
+        family->name = name;
+        family->help = help;
+        family->isHistogram = isHistogram;
+        m_byName.insert(name, family);
+    }
+    for (Series &s : family->series) {
+        if (s.labels == labels) return &s;
+    }
+    family->series.push_back(Series{labels, nullptr, nullptr});
+    return &family->series.back();
+}
+
+MetricCounter *Metrics::counter(const QString &name, const QString &help, const QString &labels)
+{
+    QMutexLocker locker(&m_mutex);
+    Series *s = seriesLocked(name, help, false, labels);
+    if (!s->counter) s->counter = std::make_unique<MetricCounter>();
+    return s->counter.get();
+}
+
+MetricHistogram *Metrics::histogram(const QString &name, const QString &help, const QString &labels,
+                                    const std::vector<double> &boundsSeconds)
+{
+    QMutexLocker locker(&m_mutex);
+    Series *s = seriesLocked(name, help, true, labels);
+    if (!s->histogram) s->histogram = std::make_unique<MetricHistogram>(boundsSeconds);
+    return s->histogram.get();
+}
+
+QByteArray Metrics::render() const
+{
+    QByteArray out;
+    out.reserve(16 * 1024);
+
+    // 拼出 name{labels[,extra]}
+    auto seriesName = [](const QString &name, const QString &labels, const QString &extra) {
+        QString joined = labels;
+        if (!extra.isEmpty()) joined += (joined.isEmpty() ? "" : ",") + extra;
+        return joined.isEmpty() ? name : name + '{' + joined + '}';
+    };
+
+    QMutexLocker locker(&m_mutex);
+    std::vector<quint64> cumulative;
+    for (const auto &family : m_families) {
+        out += "# HELP " + family->name.toUtf8() + ' ' + family->help.toUtf8() + '\n';
+        out += "# TYPE " + family->name.toUtf8() + (family->isHistogram ? " histogram\n" : " counter\n");
+
+        for (const Series &s : family->series) {
+            if (!family->isHistogram) {
+                out += seriesName(family->name, s.labels, QString()).toUtf8() + ' '
+                       + QByteArray::number(s.counter->value()) + '\n';
+                continue;
+            }
+
+            quint64 count = 0;
+            double sum = 0;
+            s.histogram->snapshot(&cumulative, &count, &sum);
+            const std::vector<double> &bounds = s.histogram->bounds();
+            for (size_t b = 0; b < cumulative.size(); ++b) {
+                const QString le = b < bounds.size() ? QString::number(bounds[b]) : QStringLiteral("+Inf");
+                out += seriesName(family->name + "_bucket", s.labels, "le=\"" + le + '"').toUtf8() + ' '
+                       + QByteArray::number(cumulative[b]) + '\n';
+            }
+            out += seriesName(family->name + "_sum", s.labels, QString()).toUtf8() + ' '
+                   + QByteArray::number(sum, 'g', 12) + '\n';
+            out += seriesName(family->name + "_count", s.labels, QString()).toUtf8() + ' '
+                   + QByteArray::number(count) + '\n';
+        }
+    }
+    return out;
+}
+
+// ==============================================================================
+//  路由指标
+// ==============================================================================
+RouteMetrics *RouteMetrics::forRoute(const QString &path)
+{
+    static QMutex mutex;
+    static QHash<QString, RouteMetrics *> routes; // 进程内常驻，不释放
+    QMutexLocker locker(&mutex);
+    RouteMetrics *&metrics = routes[path];
+    if (!metrics) metrics = new RouteMetrics(path);
+    return metrics;
+}
+
+RouteMetrics::RouteMetrics(const QString &path)
+{
+    Metrics &m = Metrics::instance();
+    const QString route = "route=\"" + Metrics::escapeLabel(path) + '"';
+    m_latency = m.histogram("http_request_duration_seconds",
+                            "HTTP request latency from routing to response, including worker queue time", route);
+    for (int i = 0; i < 5; ++i) {
+        m_byClass[i] = m.counter("http_requests_total", "HTTP requests by route and status class",
+                                 route + ",status=\"" + QString::number(i + 1) + "xx\"");
+    }
+}
+
+void RouteMetrics::record(int statusCode, qint64 elapsedNs)
+{
+    const int cls = qBound(1, statusCode / 100, 5);
+    m_byClass[cls - 1]->inc();
+    m_latency->observeNs(elapsedNs);
+}
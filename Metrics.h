@@ -0,0 +1,119 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QByteArray>
+#include <QString>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// ==============================================================================
+//  指标 (Prometheus 文本格式，由 /metrics 输出)
+//  计数器和直方图按线程分片：每个线程固定写自己的分片，记录时只有一次 relaxed 原子加，
+//  不加锁、不同线程之间也不会争同一条缓存行；/metrics 抓取时再把各分片加起来。
+//  指标在第一次使用时注册 (加锁)，返回的指针一直有效，热点路径上应当缓存指针，不要每次都查表。
+// ==============================================================================
+
+// 每个线程固定落在其中一个分片 (工作线程数一般不超过分片数，基本没有共享)
+constexpr int kMetricShards = 16;
+int metricShardIndex();
+
+class MetricCounter {
+public:
+    void inc(quint64 n = 1) {
+        m_shards[metricShardIndex()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+    quint64 value() const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<quint64> value{0};
+    };
+    Shard m_shards[kMetricShards];
+};
+
+// 直方图：桶上界单位为秒，内部按微秒记录
+class MetricHistogram {
+public:
+    static constexpr int kMaxBuckets = 15;
+
+    explicit MetricHistogram(const std::vector<double> &boundsSeconds);
+
+    void observeNs(qint64 ns) { observeUs(ns / 1000); }
+    void observeUs(qint64 us);
+
+    // 输出各桶累计值 (最后一个是 +Inf)、样本数和总和 (秒)
+    void snapshot(std::vector<quint64> *cumulative, quint64 *count, double *sumSeconds) const;
+    const std::vector<double> &bounds() const { return m_bounds; }
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<quint64> buckets[kMaxBuckets + 1] = {};
+        std::atomic<quint64> sumUs{0};
+    };
+
+    std::vector<double> m_bounds;
+    std::vector<qint64> m_boundsUs;
+    std::unique_ptr<Shard[]> m_shards;
+};
+
+class Metrics {
+public:
+    static Metrics &instance();
+
+    // 请求/查询耗时的默认桶：1ms ~ 10s
+    static const std::vector<double> &latencyBuckets();
+
+    // labels 形如 route="/api/login",status="2xx"；同名同标签重复注册返回同一个指标
+    MetricCounter *counter(const QString &name, const QString &help, const QString &labels = QString());
+    MetricHistogram *histogram(const QString &name, const QString &help, const QString &labels = QString(),
+                               const std::vector<double> &boundsSeconds = latencyBuckets());
+
+    // 按注册顺序输出所有指标
+    QByteArray render() const;
+
+    // 标签值转义 (反斜杠、双引号、换行)
+    static QString escapeLabel(const QString &value);
+
+private:
+    struct Series {
+        QString labels;
+        std::unique_ptr<MetricCounter> counter;
+        std::unique_ptr<MetricHistogram> histogram;
+    };
+    struct Family {
+        QString name;
+        QString help;
+        bool isHistogram = false;
+        std::vector<Series> series;
+    };
+
+    Metrics() = default;
+    Series *seriesLocked(const QString &name, const QString &help, bool isHistogram, const QString &labels);
+
+    mutable QMutex m_mutex;
+    std::vector<std::unique_ptr<Family>> m_families;
+    QHash<QString, Family *> m_byName;
+};
+
+// ------------------------------------------------------------------------------
+//  单个路由的指标：请求数 (按状态码类别) 和耗时直方图
+//  路由注册时取一次，请求处理完调用 record()
+// ------------------------------------------------------------------------------
+class RouteMetrics {
+public:
+    static RouteMetrics *forRoute(const QString &path);
+
+    void record(int statusCode, qint64 elapsedNs);
+
+private:
+    explicit RouteMetrics(const QString &path);
+
+    MetricHistogram *m_latency;
+    MetricCounter *m_byClass[5];    // 1xx ~ 5xx
+};
+
+#endif // METRICS_H
@@ -0,0 +1,123 @@
+#include "MonitorController.h"
+#include "DatabaseManager.h"
+#include "FlightStore.h"
+#include "Metrics.h"
+#include "SqlProfiler.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+MonitorController::MonitorController(QObject *parent) : BaseController(parent)
+{
+}
+
+void MonitorController::registerRoutes(QHttpServer *server)
+{
+    routeConcurrent(server, "/metrics", QHttpServerRequest::Method::Get,
+                    [this](const QHttpServerRequest &req) {
+                        return handleMetrics(req);
+                    });
+
+    routeConcurrent(server, "/api/admin/sql_stats", QHttpServerRequest::Method::Post,
+                    [this](const QHttpServerRequest &req) {
+                        return handleSqlStats(req);
+                    });
+}
+
+// 追加一个只有一条样本的指标 (抓取时才计算的瞬时值/累计值)
+static void appendSample(QByteArray &out, const char *name, const char *type, const char *help,
+                         const QString &labels, double value)
+{
+    out += QByteArray("# HELP ") + name + ' ' + help + '\n';
+    out += QByteArray("# TYPE ") + name + ' ' + type + '\n';
+    out += name;
+    if (!labels.isEmpty()) out += '{' + labels.toUtf8() + '}';
+    out += ' ' + QByteArray::number(value, 'g', 15) + '\n';
+}
+
+QHttpServerResponse MonitorController::handleMetrics(const QHttpServerRequest &request)
+{
+    Q_UNUSED(request);
+
+    QByteArray out = Metrics::instance().render();
+
+    // 1. 连接池 (主库 + 只读副本，每个指标一组样本，用 pool 标签区分)
+    QList<QPair<QString, PoolStats>> pools;
+    pools.append({"pool=\"" + Metrics::escapeLabel(DatabaseManager::pool().name()) + '"', DatabaseManager::pool().stats()});
+    const QList<ReplicaRouter::ReplicaStatus> replicas = ReplicaRouter::instance().status();
+    for (const ReplicaRouter::ReplicaStatus &r : replicas) {
+        pools.append({"pool=\"" + Metrics::escapeLabel(r.name) + '"', r.pool});
+    }
+    auto appendPools = [&out, &pools](const char *name, const char *type, const char *help, auto value) {
+        out += QByteArray("# HELP ") + name + ' ' + help + '\n';
+        out += QByteArray("# TYPE ") + name + ' ' + type + '\n';
+        for (const auto &p : pools) {
+            out += name + ('{' + p.first.toUtf8() + "} ") + QByteArray::number(double(value(p.second)), 'g', 15) + '\n';
+        }
+    };
+    appendPools("db_pool_connections", "gauge", "Physical connections (idle + in use)", [](const PoolStats &s) { return s.total; });
+    appendPools("db_pool_connections_in_use", "gauge", "Connections currently borrowed", [](const PoolStats &s) { return s.inUse; });
+    appendPools("db_pool_connections_max", "gauge", "Configured pool size limit", [](const PoolStats &s) { return s.maxSize; });
+    appendPools("db_pool_borrows_total", "counter", "Successful borrows", [](const PoolStats &s) { return s.borrowCount; });
+    appendPools("db_pool_waits_total", "counter", "Borrows that had to wait for a free connection", [](const PoolStats &s) { return s.waitCount; });
+    appendPools("db_pool_timeouts_total", "counter", "Borrows that timed out", [](const PoolStats &s) { return s.timeoutCount; });
+    appendPools("db_pool_ping_failures_total", "counter", "Stale connections found before lending", [](const PoolStats &s) { return s.pingFailures; });
+
+    // 2. 预编译语句缓存 (连接归还时汇总)
+    out += "# HELP db_statement_cache_lookups_total Prepared statement cache lookups by result\n"
+           "# TYPE db_statement_cache_lookups_total counter\n";
+    for (const auto &p : pools) {
+        out += "db_statement_cache_lookups_total{" + p.first.toUtf8() + ",result=\"hit\"} " + QByteArray::number(p.second.statementHits) + '\n';
+        out += "db_statement_cache_lookups_total{" + p.first.toUtf8() + ",result=\"miss\"} " + QByteArray::number(p.second.statementMisses) + '\n';
+    }
+    appendPools("db_statement_cache_evictions_total", "counter", "Prepared statements evicted by the LRU bound",
+                [](const PoolStats &s) { return s.statementEvictions; });
+
+    // 只读副本的健康状态和复制延迟 (-1 表示未知或未检查)
+    if (!replicas.isEmpty()) {
+        out += "# HELP db_replica_healthy Whether the read replica is currently used for reads\n"
+               "# TYPE db_replica_healthy gauge\n";
+        for (const ReplicaRouter::ReplicaStatus &r : replicas) {
+            out += "db_replica_healthy{pool=\"" + Metrics::escapeLabel(r.name).toUtf8() + "\",address=\""
+                   + Metrics::escapeLabel(r.address).toUtf8() + "\"} " + (r.healthy ? "1" : "0") + '\n';
+        }
+        out += "# HELP db_replica_lag_seconds Replication lag seen by the last health check\n"
+               "# TYPE db_replica_lag_seconds gauge\n";
+        for (const ReplicaRouter::ReplicaStatus &r : replicas) {
+            out += "db_replica_lag_seconds{pool=\"" + Metrics::escapeLabel(r.name).toUtf8() + "\"} "
+                   + QByteArray::number(r.lagSec) + '\n';
+        }
+    }
+
+    // 3. 内存航班库、工作线程
+    appendSample(out, "flight_store_flights", "gauge", "Flights held in the in-memory flight store (0 when not loaded)",
+                 QString(), FlightStore::instance().isLoaded() ? FlightStore::instance().size() : 0);
+    appendSample(out, "worker_threads_active", "gauge", "Request worker threads currently running a handler",
+                 QString(), workerPool()->activeThreadCount());
+    appendSample(out, "worker_threads_max", "gauge", "Request worker thread limit", QString(), workerPool()->maxThreadCount());
+
+    return QHttpServerResponse("text/plain; version=0.0.4; charset=utf-8", out, QHttpServerResponse::StatusCode::Ok);
+}
+
+// ------------------------------------------------------------------
+// 管理员功能：SQL 执行统计
+// 请求示例: { "sort": "total", "limit": 50, "reset": false }
+//   sort: total (默认) / avg / max / count / errors；reset=true 时返回后清空统计
+// ------------------------------------------------------------------
+QHttpServerResponse MonitorController::handleSqlStats(const QHttpServerRequest &request)
+{
+    const QJsonObject reqObj = QJsonDocument::fromJson(request.body()).object();
+    const QString sort = reqObj["sort"].toString("total");
+    const int limit = reqObj["limit"].toInt(50);
+
+    if (!SqlProfiler::instance().isEnabled()) {
+        QJsonObject err; err["status"] = "failed"; err["message"] = "SQL 统计未开启 (SqlProfiler/Enabled)";
+        return QHttpServerResponse(err, QHttpServerResponse::StatusCode::NotFound);
+    }
+
+    QJsonObject response;
+    response["status"] = "success";
+    response["data"] = SqlProfiler::instance().snapshot(sort, limit);
+    if (reqObj["reset"].toBool()) SqlProfiler::instance().reset();
+    return QHttpServerResponse(response, QHttpServerResponse::StatusCode::Ok);
+}
@@ -0,0 +1,27 @@
+#ifndef MONITORCONTROLLER_H
+#define MONITORCONTROLLER_H
+
+#include "BaseController.h"
+#include <QHttpServerResponse>
+#include <QHttpServerRequest>
+
+// ==============================================================================
+//  运行指标
+//  GET /metrics：Prometheus 文本格式，包含
+//    - Metrics 注册表里的计数器/直方图 (路由、SQL、连接池等待、大模型调用、缓存命中)
+//    - 抓取时读取的瞬时值 (连接池状态、预编译语句缓存、内存航班库、工作线程)
+//  POST /api/admin/sql_stats：按归一化 SQL 汇总的执行统计和慢查询的 EXPLAIN (SqlProfiler)
+// ==============================================================================
+class MonitorController : public BaseController
+{
+    Q_OBJECT
+public:
+    explicit MonitorController(QObject *parent = nullptr);
+    void registerRoutes(QHttpServer *server) override;
+
+private:
+    QHttpServerResponse handleMetrics(const QHttpServerRequest &request);
+    QHttpServerResponse handleSqlStats(const QHttpServerRequest &request);
+};
+
+#endif // MONITORCONTROLLER_H
@@ -1,99 +1,21 @@
 #include "OrderController.h"
 #include "DatabaseManager.h"
+#include "SeatInventory.h"
+#include "SeatCounters.h"
+#include "OrderQueries.h"
+#include "OrderExpiryScheduler.h"
+#include "UserProfileCache.h"
 
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QSqlRecord>
 #include <QDateTime>
+#include <QHash>
 #include <QDebug>
-#include <QRandomGenerator>
-#include <cmath>
-#include <QSet>
-
-// ==============================================================================
-//  内部辅助类：座位分配器 (SeatAllocator)
-//  负责在内存中计算虚拟座位表，并执行随机/指定筛选
-// ==============================================================================
-class SeatAllocator {
-public:
-    // 根据舱位配置，生成指定舱位的所有座位号列表 (例如: "1A", "1B", "2A"...)
-    static QStringList generateAllSeats(int firstCount, int businessCount, int economyCount, int targetType) {
-        QStringList allSeats;
-
-        // 1. 计算各舱位需要的行数 (向上取整)
-        int firstRows = std::ceil((double)firstCount / 2.0);      // 头等舱每排2座 (AB)
-        int businessRows = std::ceil((double)businessCount / 4.0); // 商务舱每排4座 (ABCD)
-        int economyRows = std::ceil((double)economyCount / 6.0);   // 经济舱每排6座 (ABCDEF)
-
-        int startRow = 1;
-        int endRow = 0;
-        QString layout = "";
-
-        // 2. 根据目标舱位确定 行号范围 和 列布局
-        if (targetType == 2) { // 头等舱
-            startRow = 1;
-            endRow = firstRows;
-            layout = "AB";
-        } else if (targetType == 1) { // 商务舱
-            startRow = 1 + firstRows; // 紧接头等舱之后
-            endRow = startRow + businessRows - 1;
-            layout = "ABCD";
-        } else { // 经济舱 (默认 Type 0)
-            startRow = 1 + firstRows + businessRows; // 紧接商务舱之后
-            endRow = startRow + economyRows - 1;
-            layout = "ABCDEF";
-        }
-
-        // 3. 生成虚拟座位表
-        for (int r = startRow; r <= endRow; ++r) {
-            for (const QChar &col : layout) {
-                allSeats.append(QString::number(r) + col);
-            }
-        }
-
-        // 4. 裁剪多余座位 (因为行数是向上取整生成的，可能会多出几个空座)
-        int maxCount = (targetType == 2 ? firstCount : (targetType == 1 ? businessCount : economyCount));
-        // 如果生成的比总数多，裁掉末尾的
-        while(allSeats.size() > maxCount) {
-            allSeats.removeLast();
-        }
-
-        return allSeats;
-    }
-
-    // 核心分配逻辑：从全量座位中剔除已占用的，然后根据偏好随机抽取
-    static QString assignSeat(const QStringList& fullSeatMap, const QSet<QString>& occupiedSeats, const QString& preferLetter) {
-        // 1. 筛选可用座位 (Available = Full - Occupied)
-        QStringList availableSeats;
-        for (const QString& seat : fullSeatMap) {
-            if (!occupiedSeats.contains(seat)) {
-                availableSeats.append(seat);
-            }
-        }
-
-        // 如果该舱位已满
-        if (availableSeats.isEmpty()) return "";
-
-        // 2. 尝试筛选符合用户偏好字母的 (比如用户想要 "A")
-        QStringList candidates;
-        if (!preferLetter.isEmpty()) {
-            for (const QString& seat : availableSeats) {
-                if (seat.endsWith(preferLetter, Qt::CaseInsensitive)) {
-                    candidates.append(seat);
-                }
-            }
-        }
-
-        // 3. 执行随机抽取
-        // 如果有符合偏好的，就在candidates里随机；否则在所有available里随机 (降级策略)
-        const QStringList& finalPool = candidates.isEmpty() ? availableSeats : candidates;
-
-        int idx = QRandomGenerator::global()->bounded(finalPool.size());
-        return finalPool[idx];
-    }
-};
+#include <vector>
 
 // ==============================================================================
 //  OrderController 实现
@@ -106,24 +28,30 @@ OrderController::OrderController(QObject *parent) : BaseController(parent)
 void OrderController::registerRoutes(QHttpServer *server)
 {
     // 1. 下单 (自动分配座位)
-    server->route("/api/create_order", QHttpServerRequest::Method::Post,
+    routeConcurrent(server, "/api/create_order", QHttpServerRequest::Method::Post,
                   [this](const QHttpServerRequest &req) {
                       return handleCreateOrder(req);
                   });
 
-    // 2. 查单
-    server->route("/api/get_orders", QHttpServerRequest::Method::Post,
+    // 1.1 团体下单 (一次分配多个相邻座位)
+    routeConcurrent(server, "/api/create_group_order", QHttpServerRequest::Method::Post,
                   [this](const QHttpServerRequest &req) {
-                      return handleGetOrders(req);
+                      return handleCreateGroupOrder(req);
+                  });
+
+    // 2. 查单
+    routeStreaming(server, "/api/get_orders", QHttpServerRequest::Method::Post,
+                  [this](const QHttpServerRequest &req, JsonStreamWriter &out) {
+                      return handleGetOrders(req, out);
                   });
 
     // 3. 删除单
-    server->route("/api/delete_order", QHttpServerRequest::Method::Post,
+    routeConcurrent(server, "/api/delete_order", QHttpServerRequest::Method::Post,
                   [this](const QHttpServerRequest &req) {
                       return handleDeleteOrder(req);
                   });
 
-    server->route("/api/refund_order", QHttpServerRequest::Method::Post,
+    routeConcurrent(server, "/api/refund_order", QHttpServerRequest::Method::Post,
                   [this](const QHttpServerRequest &req) {
                       return handleRefundOrder(req);
                   });
@@ -132,6 +60,7 @@ void OrderController::registerRoutes(QHttpServer *server)
 // ----------------------------------------------------------------------------
 // 1. 创建订单 (自动分配)
 // 请求示例: { "user_id": 1, "flight_id": 10, "seat_type": 0, "prefer_letter": "A" }
+// 指定座位: { "user_id": 1, "flight_id": 10, "seat_type": 0, "seat_number": "23C" } (座位号见 /api/flight/seat_map)
 // ----------------------------------------------------------------------------
 QHttpServerResponse OrderController::handleCreateOrder(const QHttpServerRequest &request)
 {
@@ -149,34 +78,36 @@ QHttpServerResponse OrderController::handleCreateOrder(const QHttpServerRequest
     int flightId = jsonObj["flight_id"].toInt();
     int seatType = jsonObj["seat_type"].toInt(0); // 0:经济, 1:商务, 2:头等
     QString preferLetter = jsonObj["prefer_letter"].toString().toUpper(); // 用户想要的字母
+    QString requestedSeat = jsonObj["seat_number"].toString().trimmed().toUpper(); // 用户指定的座位，可选
 
     // 数据库连接
-    QSqlDatabase db = DatabaseManager::getConnection();
+    PooledConnection db = DatabaseManager::getConnection();
     if (!db.isOpen()){
         QJsonObject err; err["status"] = "failed"; err["message"] = "数据库连接失败";
         return QHttpServerResponse(err,QHttpServerResponse::StatusCode::InternalServerError);
     }
 
-    // --- 开启事务 (保证查占座和插入的原子性) ---
+    // --- 开启事务 ---
+    // 不再锁整个航班：座位唯一性由 orders 表的 uniq_flight_active_seat 唯一键保证，
+    // 这里乐观地挑一个座位直接插入，撞上唯一键就换一个座位重试
     db.transaction();
 
-    QSqlQuery query(db);
-
-    // 2. 获取航班的总座位配置 (用于生成虚拟座位表)
-    query.prepare("SELECT economy_seats, business_seats, first_class_seats, "
-                  "economy_price, business_price, first_class_price " // <--- 新增查询价格
-                  "FROM flights WHERE ID = ?");
+    // 2. 获取航班的总座位配置 (用于确定舱位布局)
+    QSqlQuery &query = db.prepared("SELECT economy_seats, business_seats, first_class_seats, "
+                                   "economy_price, business_price, first_class_price " // <--- 新增查询价格
+                                   "FROM flights WHERE ID = ?");
     query.addBindValue(flightId);
-    if (!query.exec() || !query.next()) {
+    if (!DatabaseManager::exec(query) || !query.next()) {
         db.rollback();
         QJsonObject err; err["status"] = "failed"; err["message"] = "航班不存在";
         return QHttpServerResponse(err, QHttpServerResponse::StatusCode::NotFound);
     }
 
     // 获取座位数
-    int ecoCount = query.value("economy_seats").toInt();
-    int busCount = query.value("business_seats").toInt();
-    int firCount = query.value("first_class_seats").toInt();
+    FlightCapacity capacity;
+    capacity.economy = query.value("economy_seats").toInt();
+    capacity.business = query.value("business_seats").toInt();
+    capacity.first = query.value("first_class_seats").toInt();
 
     int ecoPrice = query.value("economy_price").toInt();
     int busPrice = query.value("business_price").toInt();
@@ -190,58 +121,124 @@ QHttpServerResponse OrderController::handleCreateOrder(const QHttpServerRequest
         // 防止非法 seatType
         orderAmount = ecoPrice;
     }
-    // 3. 获取当前已占用的座位 (排除已取消的)
-    // 使用 FOR UPDATE 锁住相关行，防止并发下同一座位被重复分配，事务锁
-    QSqlQuery occupiedQuery(db);
-    occupiedQuery.prepare("SELECT seat_number FROM orders WHERE flight_id = ? AND status != '已取消' FOR UPDATE");
-    occupiedQuery.addBindValue(flightId);
 
-    if (!occupiedQuery.exec()) {
-        db.rollback();
-        QJsonObject err; err["status"] = "failed"; err["message"] = "系统繁忙 (Lock Error)";
-        return QHttpServerResponse(err, QHttpServerResponse::StatusCode::InternalServerError);
+    // 指定了座位：先确认座位号属于所选舱位，并统一写法 ("01A" -> "1A")
+    if (!requestedSeat.isEmpty()) {
+        const CabinLayout layout = CabinLayout::forCabin(capacity, seatType);
+        const int index = layout.seatIndex(requestedSeat);
+        if (index < 0) {
+            db.rollback();
+            QJsonObject err; err["status"] = "failed"; err["message"] = "座位号不属于所选舱位";
+            return QHttpServerResponse(err, QHttpServerResponse::StatusCode::BadRequest);
+        }
+        requestedSeat = layout.seatLabel(index);
     }
 
-    QSet<QString> occupiedSeats;
-    while(occupiedQuery.next()) {
-        occupiedSeats.insert(occupiedQuery.value("seat_number").toString());
-    }
+    // 3. 挑座 + 写入订单 (Status: 未支付)，唯一键冲突时重试 (指定座位时不重试)
+    const int maxAttempts = requestedSeat.isEmpty() ? 5 : 1;
+    QString assignedSeat;
+    int newOrderId = 0;
+    static const QString insertSql = "INSERT INTO orders (user_id, flight_id, seat_type, seat_number, status, order_date, total_amount) "
+                                     "VALUES (?, ?, ?, ?, '未支付', " + SqlDialect::now() + ", ?)"; // <--- 增加了一个占位符
+    QSqlQuery &insertQuery = db.prepared(insertSql);
+
+    for (int attempt = 1; attempt <= maxAttempts; ++attempt) {
+        // A. 在内存座位位图里按用户偏好抢占一个空座 (首次访问该航班时从 orders 表重建位图)
+        bool inventoryOk = true;
+        if (!requestedSeat.isEmpty()) {
+            if (SeatInventory::instance().claimExactSeat(db, flightId, capacity, seatType, requestedSeat, &inventoryOk)) {
+                assignedSeat = requestedSeat;
+            } else if (inventoryOk) {
+                db.rollback();
+                QJsonObject err; err["status"] = "failed"; err["message"] = "该座位已被占用，请重新选择";
+                return QHttpServerResponse(err, QHttpServerResponse::StatusCode::Conflict);
+            }
+        } else {
+            assignedSeat = SeatInventory::instance().claimSeat(db, flightId, capacity, seatType, preferLetter, &inventoryOk);
+        }
+
+        if (!inventoryOk) {
+            db.rollback();
+            QJsonObject err; err["status"] = "failed"; err["message"] = "系统繁忙 (Seat Error)";
+            return QHttpServerResponse(err, QHttpServerResponse::StatusCode::InternalServerError);
+        }
+
+        if (assignedSeat.isEmpty()) {
+            db.rollback();
+            QJsonObject err; err["status"] = "failed"; err["message"] = "该舱位已售罄，无法分配座位";
+            return QHttpServerResponse(err, QHttpServerResponse::StatusCode::Conflict);
+        }
 
-    // 4. 执行分配算法
-    // A. 在内存中生成该舱位的完整座位表
-    QStringList fullSeatMap = SeatAllocator::generateAllSeats(firCount, busCount, ecoCount, seatType);
+        // B. 只插入选中的这一个座位
+        insertQuery.addBindValue(userId);
+        insertQuery.addBindValue(flightId);
+        insertQuery.addBindValue(seatType);
+        insertQuery.addBindValue(assignedSeat);
+        insertQuery.addBindValue(orderAmount); // <--- 绑定计算好的价格
+
+        if (DatabaseManager::exec(insertQuery)) {
+            // 获取新生成的订单ID
+            newOrderId = insertQuery.lastInsertId().toInt();
+            break;
+        }
 
-    // B. 根据占用情况和用户偏好，计算出分配的座位
-    QString assignedSeat = SeatAllocator::assignSeat(fullSeatMap, occupiedSeats, preferLetter);
+        if (!DatabaseManager::isDuplicateKeyError(insertQuery.lastError())) {
+            db.rollback();
+            SeatInventory::instance().releaseSeat(flightId, seatType, assignedSeat); // 座位还回去
+            qWarning() << "Create Order Error:" << insertQuery.lastError().text();
+            QJsonObject err; err["status"] = "failed"; err["message"] = "下单失败";
+            return QHttpServerResponse(err, QHttpServerResponse::StatusCode::InternalServerError);
+        }
+
+        // C. 座位已被别的请求抢走 (内存位图落后于数据库)：
+        //    该座位在位图里保持"已占用"，换一个座位再试
+        static MetricCounter *seatConflicts = Metrics::instance().counter(
+            "order_seat_conflicts_total", "Seat claims lost to a concurrent order (retried with another seat)");
+        seatConflicts->inc();
+        qInfo() << "Seat conflict on flight" << flightId << "seat" << assignedSeat << "attempt" << attempt;
+        assignedSeat.clear();
+    }
+
+    if (assignedSeat.isEmpty() && !requestedSeat.isEmpty()) {
+        // 指定的座位在数据库里已被占用 (位图里保持已占用)
+        db.rollback();
+        QJsonObject err; err["status"] = "failed"; err["message"] = "该座位已被占用，请重新选择";
+        return QHttpServerResponse(err, QHttpServerResponse::StatusCode::Conflict);
+    }
 
     if (assignedSeat.isEmpty()) {
         db.rollback();
-        QJsonObject err; err["status"] = "failed"; err["message"] = "该舱位已售罄，无法分配座位";
+        // 连续冲突说明位图已经明显过期，丢掉让下一个请求从数据库重建
+        SeatInventory::instance().invalidateFlight(flightId);
+        QJsonObject err; err["status"] = "failed"; err["message"] = "座位分配冲突，请稍后重试";
         return QHttpServerResponse(err, QHttpServerResponse::StatusCode::Conflict);
     }
 
-    // 5. 写入订单 (Status: 未支付)
-    QSqlQuery insertQuery(db);
-    insertQuery.prepare("INSERT INTO orders (user_id, flight_id, seat_type, seat_number, status, order_date, total_amount) "
-                        "VALUES (?, ?, ?, ?, '未支付', CURRENT_TIMESTAMP, ?)"); // <--- 增加了一个占位符
-    insertQuery.addBindValue(userId);
-    insertQuery.addBindValue(flightId);
-    insertQuery.addBindValue(seatType);
-    insertQuery.addBindValue(assignedSeat);
-    insertQuery.addBindValue(orderAmount); // <--- 绑定计算好的价格
-
-    if (!insertQuery.exec()) {
+    // 余座计数减一 (与订单插入在同一个事务里)；放在提交前最后一步，计数行上的锁持有时间最短
+    bool counterOk = true;
+    if (!SeatCounters::take(db, flightId, seatType, 1, &counterOk)) {
         db.rollback();
-        qWarning() << "Create Order Error:" << insertQuery.lastError().text();
+        SeatInventory::instance().releaseSeat(flightId, seatType, assignedSeat);
+        QJsonObject err; err["status"] = "failed";
+        err["message"] = counterOk ? "该舱位已售罄，无法分配座位" : "下单失败";
+        return QHttpServerResponse(err, counterOk ? QHttpServerResponse::StatusCode::Conflict
+                                                  : QHttpServerResponse::StatusCode::InternalServerError);
+    }
+
+    if (!db.commit()) { // 提交事务
+        SeatInventory::instance().releaseSeat(flightId, seatType, assignedSeat);
         QJsonObject err; err["status"] = "failed"; err["message"] = "下单失败";
         return QHttpServerResponse(err, QHttpServerResponse::StatusCode::InternalServerError);
     }
 
-    // 获取新生成的订单ID
-    int newOrderId = insertQuery.lastInsertId().toInt();
-    db.commit(); // 提交事务
+    // 余座变了：同步内存航班库，作废含有该航班的搜索缓存
+    SeatCounters::committed(flightId, seatType, -1);
+    // 新订单要马上出现在该用户的订单列表里，接下来的读走主库
+    DatabaseManager::noteWrite(userId);
+    // 超过保留时间仍未支付就自动取消
+    OrderExpiryScheduler::instance().schedule(newOrderId, QDateTime::currentDateTime());
 
-    // 6. 返回成功响应 (带回分配的座位号)
+    // 4. 返回成功响应 (带回分配的座位号)
     QJsonObject success;
     success["status"] = "success";
     success["message"] = "预订成功";
@@ -254,98 +251,305 @@ QHttpServerResponse OrderController::handleCreateOrder(const QHttpServerRequest
 
 
 // ----------------------------------------------------------------------------
-// 2. 查询用户订单
+// 1.1 团体下单 (一个事务里预订 count 个座位，尽量同一排相邻)
+// 请求示例: { "user_id": 1, "flight_id": 10, "seat_type": 0, "count": 3 }
+// 返回: { "status": "success", "order_ids": [..], "seat_numbers": ["23A", "23B", "23C"] }
 // ----------------------------------------------------------------------------
-QHttpServerResponse OrderController::handleGetOrders(const QHttpServerRequest &request)
+QHttpServerResponse OrderController::handleCreateGroupOrder(const QHttpServerRequest &request)
 {
+    // 1. 解析请求 JSON
     QJsonDocument jsonDoc = QJsonDocument::fromJson(request.body());
+    if (!jsonDoc.isObject()) return QHttpServerResponse(QHttpServerResponse::StatusCode::BadRequest);
     QJsonObject jsonObj = jsonDoc.object();
 
-    if (!jsonObj.contains("user_id")) {
+    if (!jsonObj.contains("user_id") || !jsonObj.contains("flight_id") || !jsonObj.contains("count")) {
         QJsonObject err; err["status"] = "failed"; err["message"] = "参数缺失";
         return QHttpServerResponse(err, QHttpServerResponse::StatusCode::BadRequest);
     }
+
+    const int maxGroupSize = 9;
     int userId = jsonObj["user_id"].toInt();
+    int flightId = jsonObj["flight_id"].toInt();
+    int seatType = jsonObj["seat_type"].toInt(0); // 0:经济, 1:商务, 2:头等
+    int count = jsonObj["count"].toInt();
+    if (count < 1 || count > maxGroupSize) {
+        QJsonObject err; err["status"] = "failed"; err["message"] = QString("人数应在 1 到 %1 之间").arg(maxGroupSize);
+        return QHttpServerResponse(err, QHttpServerResponse::StatusCode::BadRequest);
+    }
 
-    QSqlDatabase db = DatabaseManager::getConnection();
+    PooledConnection db = DatabaseManager::getConnection();
     if (!db.isOpen()){
-        return QHttpServerResponse(QHttpServerResponse::StatusCode::InternalServerError);
+        QJsonObject err; err["status"] = "failed"; err["message"] = "数据库连接失败";
+        return QHttpServerResponse(err,QHttpServerResponse::StatusCode::InternalServerError);
     }
 
-    QSqlQuery query(db);
-    // 【修改点 1】SQL语句增加价格字段查询
-    QString sql = R"(
-        SELECT
-            o.ID as order_id, o.seat_type, o.seat_number, o.order_date, o.status,
-            f.flight_number, f.airline, f.origin, f.destination,
-            f.departure_time, f.landing_time, f.aircraft_model,
-            f.economy_price, f.business_price, f.first_class_price
-        FROM orders o
-        JOIN flights f ON o.flight_id = f.ID
-        WHERE o.user_id = ?
-        ORDER BY o.order_date DESC
-    )";
-
-    query.prepare(sql);
-    query.addBindValue(userId);
+    db.transaction();
 
-    if (!query.exec()) {
-        QJsonObject err; err["status"] = "failed"; err["message"] = "数据库查询失败";
-        return QHttpServerResponse(err,QHttpServerResponse::StatusCode::InternalServerError);
+    // 2. 航班座位配置和价格
+    QSqlQuery &query = db.prepared("SELECT economy_seats, business_seats, first_class_seats, "
+                                   "economy_price, business_price, first_class_price "
+                                   "FROM flights WHERE ID = ?");
+    query.addBindValue(flightId);
+    if (!DatabaseManager::exec(query) || !query.next()) {
+        db.rollback();
+        QJsonObject err; err["status"] = "failed"; err["message"] = "航班不存在";
+        return QHttpServerResponse(err, QHttpServerResponse::StatusCode::NotFound);
     }
 
-    QJsonArray list;
-    while (query.next()) {
-        QJsonObject item;
-        item["order_id"] = query.value("order_id").toInt();
-        if(query.value("status").toString() == "未支付")
-            item["status"] = 0;
-        else if(query.value("status").toString()=="已支付")
-            item["status"] = 1;
-        else
-            item["status"] = 2;
-        item["flight_number"] = query.value("flight_number").toString();
-        item["airline"] = query.value("airline").toString();
-        // 前端对应 dep_city, arr_city，这里后端字段名为 origin, destination
-        // 建议后端保持数据库字段名，前端去适配；或者在这里做别名转换
-        item["dep_city"] = query.value("origin").toString();
-        item["arr_city"] = query.value("destination").toString();
-        item["aircraft_model"] = query.value("aircraft_model").toString();
-
-        // 时间格式化
-        QDateTime dep = query.value("departure_time").toDateTime();
-        QDateTime arr = query.value("landing_time").toDateTime();
-        item["dep_time"] = dep.toString("yyyy-MM-dd HH:mm");
-        item["arr_time"] = arr.toString("HH:mm");
-
-        item["seat_number"] = query.value("seat_number").toString();
-
-        // 【修改点 2】根据舱位类型计算具体价格
-        int type = query.value("seat_type").toInt();
-        int price = 0;
-        QString seatClassStr = "经济舱";
-
-        if (type == 0) {
-            seatClassStr = "经济舱";
-            price = query.value("economy_price").toInt();
-        } else if (type == 1) {
-            seatClassStr = "商务舱";
-            price = query.value("business_price").toInt();
-        } else if (type == 2) {
-            seatClassStr = "头等舱";
-            price = query.value("first_class_price").toInt();
+    FlightCapacity capacity;
+    capacity.economy = query.value(0).toInt();
+    capacity.business = query.value(1).toInt();
+    capacity.first = query.value(2).toInt();
+    const double orderAmount = query.value(3 + cabinIndex(seatType)).toInt();
+
+    // 3. 挑座 + 一条多行 INSERT 写入全部订单；唯一键冲突说明位图落后了，丢掉位图重建后再试
+    QStringList rowPlaceholders;
+    for (int i = 0; i < count; ++i) rowPlaceholders << "(?, ?, ?, ?, '未支付', " + SqlDialect::now() + ", ?)";
+    QSqlQuery insertQuery(db);
+    insertQuery.prepare("INSERT INTO orders (user_id, flight_id, seat_type, seat_number, status, order_date, total_amount) "
+                        "VALUES " + rowPlaceholders.join(", "));
+
+    const int maxAttempts = 3;
+    QStringList seats;
+    for (int attempt = 1; attempt <= maxAttempts; ++attempt) {
+        bool inventoryOk = true;
+        seats = SeatInventory::instance().claimSeats(db, flightId, capacity, seatType, count, &inventoryOk);
+
+        if (!inventoryOk) {
+            db.rollback();
+            QJsonObject err; err["status"] = "failed"; err["message"] = "系统繁忙 (Seat Error)";
+            return QHttpServerResponse(err, QHttpServerResponse::StatusCode::InternalServerError);
+        }
+        if (seats.isEmpty()) {
+            db.rollback();
+            QJsonObject err; err["status"] = "failed"; err["message"] = "该舱位余座不足";
+            return QHttpServerResponse(err, QHttpServerResponse::StatusCode::Conflict);
         }
 
-        item["seat_class"] = seatClassStr;
-        item["price"] = price; // ✅ 补全前端需要的价格字段
+        for (const QString &seat : seats) {
+            insertQuery.addBindValue(userId);
+            insertQuery.addBindValue(flightId);
+            insertQuery.addBindValue(seatType);
+            insertQuery.addBindValue(seat);
+            insertQuery.addBindValue(orderAmount);
+        }
+        if (DatabaseManager::exec(insertQuery)) break;
+
+        for (const QString &seat : seats) SeatInventory::instance().releaseSeat(flightId, seatType, seat);
+        if (!DatabaseManager::isDuplicateKeyError(insertQuery.lastError())) {
+            db.rollback();
+            qWarning() << "Create Group Order Error:" << insertQuery.lastError().text();
+            QJsonObject err; err["status"] = "failed"; err["message"] = "下单失败";
+            return QHttpServerResponse(err, QHttpServerResponse::StatusCode::InternalServerError);
+        }
+
+        // 不知道是哪个座位冲突，整个航班的位图从数据库重建
+        qInfo() << "Group seat conflict on flight" << flightId << "attempt" << attempt;
+        SeatInventory::instance().invalidateFlight(flightId);
+        seats.clear();
+    }
+
+    if (seats.isEmpty()) {
+        db.rollback();
+        QJsonObject err; err["status"] = "failed"; err["message"] = "座位分配冲突，请稍后重试";
+        return QHttpServerResponse(err, QHttpServerResponse::StatusCode::Conflict);
+    }
+
+    auto fail = [&](const QString &message, QHttpServerResponse::StatusCode code) {
+        db.rollback();
+        for (const QString &seat : seats) SeatInventory::instance().releaseSeat(flightId, seatType, seat);
+        QJsonObject err; err["status"] = "failed"; err["message"] = message;
+        return QHttpServerResponse(err, code);
+    };
+
+    // 4. 取回新订单的 ID (多行 INSERT 的自增 ID 不保证连续，按唯一键查回来)
+    QStringList seatPlaceholders;
+    for (int i = 0; i < count; ++i) seatPlaceholders << "?";
+    QSqlQuery idQuery(db);
+    idQuery.prepare("SELECT ID, seat_number FROM orders WHERE flight_id = ? AND active_seat IN ("
+                    + seatPlaceholders.join(", ") + ")");
+    idQuery.addBindValue(flightId);
+    for (const QString &seat : seats) idQuery.addBindValue(seat);
+    if (!DatabaseManager::exec(idQuery)) {
+        return fail("下单失败", QHttpServerResponse::StatusCode::InternalServerError);
+    }
+    QHash<QString, int> orderIdOfSeat;
+    while (idQuery.next()) orderIdOfSeat.insert(idQuery.value(1).toString(), idQuery.value(0).toInt());
+
+    // 5. 余座计数一次扣掉 count 个
+    bool counterOk = true;
+    if (!SeatCounters::take(db, flightId, seatType, count, &counterOk)) {
+        return counterOk ? fail("该舱位余座不足", QHttpServerResponse::StatusCode::Conflict)
+                         : fail("下单失败", QHttpServerResponse::StatusCode::InternalServerError);
+    }
+
+    if (!db.commit()) {
+        return fail("下单失败", QHttpServerResponse::StatusCode::InternalServerError);
+    }
 
-        list.append(item);
+    SeatCounters::committed(flightId, seatType, -count);
+    DatabaseManager::noteWrite(userId);
+
+    // 6. 返回全部订单号和座位号 (顺序一致)
+    QJsonArray orderIds;
+    QJsonArray seatNumbers;
+    const QDateTime now = QDateTime::currentDateTime();
+    for (const QString &seat : seats) {
+        const int orderId = orderIdOfSeat.value(seat);
+        OrderExpiryScheduler::instance().schedule(orderId, now);
+        orderIds.append(orderId);
+        seatNumbers.append(seat);
     }
 
-    QJsonObject resp;
-    resp["status"] = "success";
-    resp["data"] = list;
-    return QHttpServerResponse(resp, QHttpServerResponse::StatusCode::Ok);
+    QJsonObject success;
+    success["status"] = "success";
+    success["message"] = "预订成功";
+    success["order_ids"] = orderIds;
+    success["seat_numbers"] = seatNumbers;
+    success["seat_type"] = seatType;
+    return QHttpServerResponse(success, QHttpServerResponse::StatusCode::Ok);
+}
+
+// ----------------------------------------------------------------------------
+// 2. 查询用户订单 (按下单时间倒序，keyset 翻页)
+// ----------------------------------------------------------------------------
+QHttpServerResponse::StatusCode OrderController::handleGetOrders(const QHttpServerRequest &request, JsonStreamWriter &out)
+{
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(request.body());
+    QJsonObject jsonObj = jsonDoc.object();
+
+    if (!jsonObj.contains("user_id")) {
+        out.beginObject(); out.field("status", "failed"); out.field("message", "参数缺失"); out.endObject();
+        return QHttpServerResponse::StatusCode::BadRequest;
+    }
+
+    // 翻页和过滤参数 (都可选)
+    // { "user_id": 1, "limit": 50, "cursor": "上一页返回的 next_cursor", "status": 0, "from_date": "2025-01-01", "to_date": "2025-12-31" }
+    // 带了 limit 或 cursor 才翻页 (没带 limit 时每页 50 条)；都不带时和以前一样返回全部订单，has_more 为 false
+    OrderHistoryFilter filter;
+    filter.userId = jsonObj["user_id"].toInt();
+    const bool paged = jsonObj.contains("limit") || !jsonObj["cursor"].toString().isEmpty();
+    filter.limit = paged ? qBound(1, jsonObj["limit"].toInt(50), OrderQueries::kMaxPageSize) : 0;
+    filter.status = jsonObj.contains("status") ? jsonObj["status"].toInt(-1) : -1;
+    if (jsonObj.contains("from_date")) filter.fromDate = QDate::fromString(jsonObj["from_date"].toString(), "yyyy-MM-dd");
+    if (jsonObj.contains("to_date")) filter.toDate = QDate::fromString(jsonObj["to_date"].toString(), "yyyy-MM-dd");
+    if (!jsonObj["cursor"].toString().isEmpty()) {
+        filter.hasCursor = OrderQueries::decodeCursor(jsonObj["cursor"].toString(), &filter.cursorDate, &filter.cursorId);
+        if (!filter.hasCursor) {
+            out.beginObject(); out.field("status", "failed"); out.field("message", "cursor 无效"); out.endObject();
+            return QHttpServerResponse::StatusCode::BadRequest;
+        }
+    }
+
+    // 先把这一页读进内存、归还连接，再开始写：客户端收得慢时写出会等待 (见 StreamBackpressure)，
+    // 不能让慢客户端同时占着数据库连接和还没读完的结果集
+    std::vector<OrderRecord> orders;
+    bool hasMore = false;
+    QDateTime lastDate;
+    {
+        // 只读查询走只读副本 (该用户刚下单/支付过则走主库)
+        PooledConnection db = DatabaseManager::getReadConnection(filter.userId);
+        if (!db.isOpen()){
+            return QHttpServerResponse::StatusCode::InternalServerError;
+        }
+
+        QSqlQuery query(db);
+        query.setForwardOnly(true); // 只往前读，驱动不用缓存已经读过的行
+        query.prepare(OrderQueries::historyPageSql(filter));
+        OrderQueries::bindHistoryPage(query, filter);
+
+        if (!DatabaseManager::exec(query)) {
+            qWarning() << "Get Orders Error:" << query.lastError().text();
+            out.beginObject(); out.field("status", "failed"); out.field("message", "数据库查询失败"); out.endObject();
+            return QHttpServerResponse::StatusCode::InternalServerError;
+        }
+
+        // 列下标只解析一次，逐行按下标取值
+        const QSqlRecord rec = query.record();
+        const int cOrderId = rec.indexOf("order_id");
+        const int cOrderDate = rec.indexOf("order_date");
+        const int cStatus = rec.indexOf("status");
+        const int cFlightNumber = rec.indexOf("flight_number");
+        const int cAirline = rec.indexOf("airline");
+        const int cOrigin = rec.indexOf("origin");
+        const int cDestination = rec.indexOf("destination");
+        const int cModel = rec.indexOf("aircraft_model");
+        const int cDeparture = rec.indexOf("departure_time");
+        const int cLanding = rec.indexOf("landing_time");
+        const int cSeatNumber = rec.indexOf("seat_number");
+        const int cSeatType = rec.indexOf("seat_type");
+        const int cPrices[3] = { rec.indexOf("economy_price"), rec.indexOf("business_price"),
+                                 rec.indexOf("first_class_price") };
+
+        if (filter.limit > 0) orders.reserve(filter.limit);
+        while (query.next()) {
+            // 多取的那一行只用来判断还有没有下一页
+            if (filter.limit > 0 && int(orders.size()) == filter.limit) {
+                hasMore = true;
+                break;
+            }
+            lastDate = query.value(cOrderDate).toDateTime();
+
+            OrderRecord r;
+            r.orderId = query.value(cOrderId).toInt();
+            r.status = query.value(cStatus).toString();
+            r.flightNumber = query.value(cFlightNumber).toString();
+            r.airline = query.value(cAirline).toString();
+            r.origin = query.value(cOrigin).toString();
+            r.destination = query.value(cDestination).toString();
+            r.aircraftModel = query.value(cModel).toString();
+            r.departureTime = query.value(cDeparture).toDateTime();
+            r.landingTime = query.value(cLanding).toDateTime();
+            r.seatNumber = query.value(cSeatNumber).toString();
+            // 【修改点 2】根据舱位类型计算具体价格
+            r.seatType = query.value(cSeatType).toInt();
+            r.price = (r.seatType >= 0 && r.seatType <= 2) ? query.value(cPrices[r.seatType]).toInt() : 0;
+            orders.push_back(std::move(r));
+        }
+    } // 连接在这里归还
+
+    out.beginObject();
+    out.field("status", "success");
+    out.key("data");
+    out.beginArray();
+    for (const OrderRecord &r : orders) writeOrderRow(out, r);
+    out.endArray();
+    out.field("has_more", hasMore);
+    out.key("next_cursor");
+    if (hasMore) out.value(OrderQueries::encodeCursor(lastDate, orders.back().orderId));
+    else out.nullValue();
+    out.endObject();
+    return QHttpServerResponse::StatusCode::Ok;
+}
+
+void OrderController::writeOrderRow(JsonStreamWriter &out, const OrderRecord &r)
+{
+    out.beginObject();
+    out.field("order_id", r.orderId);
+    if(r.status == "未支付")
+        out.field("status", 0);
+    else if(r.status == "已支付")
+        out.field("status", 1);
+    else
+        out.field("status", 2);
+    out.field("flight_number", r.flightNumber);
+    out.field("airline", r.airline);
+    // 前端对应 dep_city, arr_city，这里后端字段名为 origin, destination
+    // 建议后端保持数据库字段名，前端去适配；或者在这里做别名转换
+    out.field("dep_city", r.origin);
+    out.field("arr_city", r.destination);
+    out.field("aircraft_model", r.aircraftModel);
+
+    // 时间格式化
+    out.field("dep_time", r.departureTime.toString("yyyy-MM-dd HH:mm"));
+    out.field("arr_time", r.landingTime.toString("HH:mm"));
+
+    out.field("seat_number", r.seatNumber);
+
+    static const char *const kSeatClassNames[3] = { "经济舱", "商务舱", "头等舱" };
+    out.field("seat_class", kSeatClassNames[cabinIndex(r.seatType)]);
+    out.field("price", r.price); // ✅ 补全前端需要的价格字段
+    out.endObject();
 }
 
 QHttpServerResponse OrderController::handleDeleteOrder(const QHttpServerRequest &request)
@@ -362,20 +566,51 @@ QHttpServerResponse OrderController::handleDeleteOrder(const QHttpServerRequest
     }
     // QString orderId = jsonObj["order_id"].toString();
     QString orderId = jsonObj["order_id"].toVariant().toString();
-    QSqlDatabase db = DatabaseManager::getConnection();
+    PooledConnection db = DatabaseManager::getConnection();
     if (!db.isOpen()){
         return QHttpServerResponse(QHttpServerResponse::StatusCode::InternalServerError);
     }
 
-    QSqlQuery query(db);
+    db.transaction();
+
+    // 先锁住这条订单，取出座位信息，删除后要把座位还给内存库存
+    static const QString lockSql = "SELECT flight_id, seat_type, seat_number, status FROM orders WHERE ID = ? AND user_id = ?"
+                                   + SqlDialect::forUpdate();
+    QSqlQuery &lockQuery = db.prepared(lockSql);
+    lockQuery.addBindValue(orderId);
+    lockQuery.addBindValue(userId);
+    if (!DatabaseManager::exec(lockQuery)) {
+        db.rollback();
+        QJsonObject err;
+        qInfo()<<"error2: "<<orderId;
+        err["status"] = "failed";
+        err["message"] = "删除失败: " + lockQuery.lastError().text();
+        return QHttpServerResponse(err, QHttpServerResponse::StatusCode::InternalServerError);
+    }
+    if (!lockQuery.next()) {
+        db.rollback();
+        QJsonObject fail;
+        qInfo()<<"error3: "<<orderId;
+        fail["status"] = "failed";
+        fail["message"] = "订单不存在或无权操作";
+        return QHttpServerResponse(fail, QHttpServerResponse::StatusCode::NotFound);
+    }
+    int flightId = lockQuery.value("flight_id").toInt();
+    int seatType = lockQuery.value("seat_type").toInt();
+    QString seatNumber = lockQuery.value("seat_number").toString();
+    QString status = lockQuery.value("status").toString();
+    // 已取消/已退款的订单早就不占座了，不能重复释放
+    const bool holdsSeat = (status != "已取消" && status != "已退款");
 
     // 【核心修改】执行物理删除
     // 加上 user_id 是为了安全，防止用户删除别人的订单
-    query.prepare("DELETE FROM orders WHERE ID = ? AND user_id = ?");
+    QSqlQuery &query = db.prepared("DELETE FROM orders WHERE ID = ? AND user_id = ?");
     query.addBindValue(orderId);
     query.addBindValue(userId);
 
-    if (!query.exec()) {
+    // 占座的订单删除后余座加一，和删除放在同一个事务里
+    if (!DatabaseManager::exec(query) || (holdsSeat && !SeatCounters::give(db, flightId, seatType, 1)) || !db.commit()) {
+        db.rollback();
         QJsonObject err;
         qInfo()<<"error2: "<<orderId;
         err["status"] = "failed";
@@ -384,6 +619,12 @@ QHttpServerResponse OrderController::handleDeleteOrder(const QHttpServerRequest
         return QHttpServerResponse(err, QHttpServerResponse::StatusCode::InternalServerError);
     }
 
+    if (holdsSeat) {
+        SeatInventory::instance().releaseSeat(flightId, seatType, seatNumber);
+        SeatCounters::committed(flightId, seatType, +1);
+    }
+    DatabaseManager::noteWrite(userId);
+
     if (query.numRowsAffected() > 0) {
         QJsonObject success;
         success["status"] = "success";
@@ -416,20 +657,21 @@ QHttpServerResponse OrderController::handleRefundOrder(const QHttpServerRequest
     int orderId = jsonObj["order_id"].toString().toInt();
 
     // 2. 连接数据库
-    QSqlDatabase db = DatabaseManager::getConnection();
+    PooledConnection db = DatabaseManager::getConnection();
     if (!db.isOpen()) {
         return QHttpServerResponse(QHttpServerResponse::StatusCode::InternalServerError);
     }
 
     // 3. 开启事务 (非常重要：涉及资金变动)
     db.transaction();
-    QSqlQuery query(db);
 
-    // 4. 查询订单状态及支付金额 (使用 FOR UPDATE 锁行，防止并发重复退款)
-    query.prepare("SELECT status, paid_amount, user_id FROM orders WHERE ID = ? FOR UPDATE");
+    // 4. 查询订单状态及支付金额 (使用 FOR UPDATE 锁行，防止并发重复退款；SQLite 的事务开启时已持有写锁)
+    static const QString refundSql = "SELECT status, paid_amount, user_id, flight_id, seat_type, seat_number FROM orders WHERE ID = ?"
+                                     + SqlDialect::forUpdate();
+    QSqlQuery &query = db.prepared(refundSql);
     query.addBindValue(orderId);
 
-    if (!query.exec() || !query.next()) {
+    if (!DatabaseManager::exec(query) || !query.next()) {
         db.rollback();
         QJsonObject err; err["status"] = "failed"; err["message"] = "订单不存在";
         qInfo()<<"找不到订单号："<<orderId;
@@ -440,6 +682,9 @@ QHttpServerResponse OrderController::handleRefundOrder(const QHttpServerRequest
     int dbUserId = query.value("user_id").toInt();
     QString status = query.value("status").toString();
     double paidAmount = query.value("paid_amount").toDouble();
+    int flightId = query.value("flight_id").toInt();
+    int seatType = query.value("seat_type").toInt();
+    QString seatNumber = query.value("seat_number").toString();
 
     // 校验归属权
     if (dbUserId != userId) {
@@ -463,30 +708,46 @@ QHttpServerResponse OrderController::handleRefundOrder(const QHttpServerRequest
     // 6. 执行退款操作
 
     // A. 增加用户余额
-    QSqlQuery updateUser(db);
-    updateUser.prepare("UPDATE users SET balance = balance + ? WHERE U_ID = ?");
+    QSqlQuery &updateUser = db.prepared("UPDATE users SET balance = balance + ? WHERE U_ID = ?");
     updateUser.addBindValue(paidAmount);
     updateUser.addBindValue(userId);
 
-    if (!updateUser.exec()) {
+    if (!DatabaseManager::exec(updateUser)) {
         db.rollback();
         QJsonObject err; err["status"] = "failed"; err["message"] = "退款到余额失败";
         return QHttpServerResponse(err, QHttpServerResponse::StatusCode::InternalServerError);
     }
 
     // B. 更新订单状态为 "已退款"
-    QSqlQuery updateOrder(db);
-    updateOrder.prepare("UPDATE orders SET status = '已退款' WHERE ID = ?");
+    QSqlQuery &updateOrder = db.prepared("UPDATE orders SET status = '已退款' WHERE ID = ?");
     updateOrder.addBindValue(orderId);
 
-    if (!updateOrder.exec()) {
+    if (!DatabaseManager::exec(updateOrder)) {
         db.rollback();
         QJsonObject err; err["status"] = "failed"; err["message"] = "更新订单状态失败";
         return QHttpServerResponse(err, QHttpServerResponse::StatusCode::InternalServerError);
     }
 
+    // C. 余座加一
+    if (!SeatCounters::give(db, flightId, seatType, 1)) {
+        db.rollback();
+        QJsonObject err; err["status"] = "failed"; err["message"] = "退款失败";
+        return QHttpServerResponse(err, QHttpServerResponse::StatusCode::InternalServerError);
+    }
+
     // 7. 提交事务
-    db.commit();
+    if (!db.commit()) {
+        db.rollback();
+        QJsonObject err; err["status"] = "failed"; err["message"] = "退款失败";
+        return QHttpServerResponse(err, QHttpServerResponse::StatusCode::InternalServerError);
+    }
+
+    // 退款后座位重新开放销售
+    SeatInventory::instance().releaseSeat(flightId, seatType, seatNumber);
+    SeatCounters::committed(flightId, seatType, +1);
+    // 余额变了，缓存的用户资料作废
+    DatabaseManager::noteWrite(userId);
+    UserProfileCache::instance().invalidate(userId);
 
     QJsonObject success;
     success["status"] = "success";
@@ -5,6 +5,9 @@
 #include <QHttpServerResponse>
 #include <QHttpServerRequest>
 
+class JsonStreamWriter;
+struct OrderRecord;
+
 class OrderController : public BaseController
 {
     Q_OBJECT
@@ -12,12 +15,18 @@ public:
     explicit OrderController(QObject *parent = nullptr);
     void registerRoutes(QHttpServer *server) override;
 
+    // 订单列表里的一个订单 (一个 JSON 对象)，每个结果行都会调用
+    static void writeOrderRow(JsonStreamWriter &out, const OrderRecord &r);
+
 private:
     // 1. 创建订单 (POST)
     QHttpServerResponse handleCreateOrder(const QHttpServerRequest &request);
 
-    // 2. 查询我的订单 (POST)
-    QHttpServerResponse handleGetOrders(const QHttpServerRequest &request);
+    // 1.1 团体下单：一次预订多个相邻座位 (POST)
+    QHttpServerResponse handleCreateGroupOrder(const QHttpServerRequest &request);
+
+    // 2. 查询我的订单 (POST)，结果直接流式写成 JSON
+    QHttpServerResponse::StatusCode handleGetOrders(const QHttpServerRequest &request, JsonStreamWriter &out);
 
     // 3. 退票/取消订单 (POST)
     QHttpServerResponse handleDeleteOrder(const QHttpServerRequest &request);
@@ -0,0 +1,198 @@
+#include "OrderExpiryScheduler.h"
+#include "AppConfig.h"
+#include "BaseController.h"
+#include "DatabaseManager.h"
+#include "SeatInventory.h"
+#include "SeatCounters.h"
+
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QHash>
+#include <QPair>
+#include <QDebug>
+
+// 批量取消失败 (例如数据库暂时不可用) 后多久重试
+static const qint64 kRetryDelayMs = 60 * 1000;
+
+OrderExpiryScheduler &OrderExpiryScheduler::instance()
+{
+    static OrderExpiryScheduler scheduler;
+    return scheduler;
+}
+
+OrderExpiryScheduler::OrderExpiryScheduler(QObject *parent)
+    : QObject(parent), m_wheel(kSlots)
+{
+    // HoldMinutes=0 表示不自动取消
+    m_holdMs = AppConfig::value("Order/HoldMinutes", 15).toLongLong() * 60 * 1000;
+    m_batchSize = qMax(1, AppConfig::value("Order/ExpiryBatchSize", 200).toInt());
+    m_wheelTimeMs = QDateTime::currentMSecsSinceEpoch();
+
+    connect(&m_timer, &QTimer::timeout, this, &OrderExpiryScheduler::tick);
+}
+
+bool OrderExpiryScheduler::start(const QSqlDatabase &db)
+{
+    if (!isEnabled()) return true;
+
+    // 走 idx_status，只读未支付的订单
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!DatabaseManager::exec(query, "SELECT ID, order_date FROM orders WHERE status = '未支付'")) {
+        qWarning() << "Load Unpaid Orders Error:" << query.lastError().text();
+        return false;
+    }
+
+    int count = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_wheelTimeMs = QDateTime::currentMSecsSinceEpoch();
+        while (query.next()) {
+            // 已经超时的订单排到下一个 tick
+            scheduleAtLocked(query.value(0).toInt(), query.value(1).toDateTime().toMSecsSinceEpoch() + m_holdMs);
+            ++count;
+        }
+    }
+
+    m_timer.start(int(m_tickMs));
+    qInfo() << "未支付订单超时取消已启动: 保留" << m_holdMs / 60000 << "分钟, 待处理" << count << "单";
+    return true;
+}
+
+void OrderExpiryScheduler::schedule(int orderId, const QDateTime &createdAt)
+{
+    if (!isEnabled()) return;
+    QMutexLocker locker(&m_mutex);
+    scheduleAtLocked(orderId, createdAt.toMSecsSinceEpoch() + m_holdMs);
+}
+
+void OrderExpiryScheduler::scheduleAtLocked(int orderId, qint64 deadlineMs)
+{
+    // 距离当前格子还有几个 tick (至少 1 个，当前格子已经处理过了)
+    const qint64 ticks = qMax<qint64>(1, (deadlineMs - m_wheelTimeMs + m_tickMs - 1) / m_tickMs);
+    const int slot = int((m_cursor + ticks) % kSlots);
+    m_wheel[slot].push_back({orderId, int((ticks - 1) / kSlots)});
+}
+
+void OrderExpiryScheduler::tick()
+{
+    QList<int> due;
+    {
+        QMutexLocker locker(&m_mutex);
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        // 定时器可能被主线程耽误，落后几个 tick 就补走几格
+        while (m_wheelTimeMs + m_tickMs <= now) {
+            m_wheelTimeMs += m_tickMs;
+            m_cursor = (m_cursor + 1) % kSlots;
+
+            std::vector<Timer> &slot = m_wheel[m_cursor];
+            size_t kept = 0;
+            for (const Timer &t : slot) {
+                if (t.rounds == 0) {
+                    due.append(t.orderId);
+                } else {
+                    slot[kept++] = {t.orderId, t.rounds - 1};
+                }
+            }
+            slot.resize(kept);
+        }
+    }
+
+    if (!due.isEmpty()) dispatch(due);
+}
+
+void OrderExpiryScheduler::dispatch(const QList<int> &orderIds)
+{
+    // 数据库操作放到工作线程，主线程只负责走表
+    for (qsizetype i = 0; i < orderIds.size(); i += m_batchSize) {
+        const QList<int> batch = orderIds.mid(i, m_batchSize);
+        QtConcurrent::run(BaseController::workerPool(), [this, batch]() {
+            expireBatch(batch);
+        });
+    }
+}
+
+void OrderExpiryScheduler::expireBatch(const QList<int> &orderIds)
+{
+    auto retryLater = [this, &orderIds]() {
+        QMutexLocker locker(&m_mutex);
+        const qint64 retryAt = QDateTime::currentMSecsSinceEpoch() + kRetryDelayMs;
+        for (int id : orderIds) scheduleAtLocked(id, retryAt);
+    };
+
+    PooledConnection db = DatabaseManager::getConnection();
+    if (!db.isOpen()) {
+        retryLater();
+        return;
+    }
+
+    QStringList placeholders;
+    for (qsizetype i = 0; i < orderIds.size(); ++i) placeholders << "?";
+    const QString idList = placeholders.join(", ");
+
+    db.transaction();
+
+    // 1. 锁住仍然未支付的订单 (这期间支付请求会等待，提交后它们的 UPDATE ... AND status = '未支付' 不再命中)
+    QSqlQuery select(db);
+    select.prepare("SELECT ID, flight_id, seat_type, seat_number FROM orders "
+                   "WHERE ID IN (" + idList + ") AND status = '未支付'" + SqlDialect::forUpdate());
+    for (int id : orderIds) select.addBindValue(id);
+    if (!DatabaseManager::exec(select)) {
+        qWarning() << "Expire Orders Error:" << select.lastError().text();
+        db.rollback();
+        retryLater();
+        return;
+    }
+
+    struct Held { int orderId; int flightId; int seatType; QString seatNumber; };
+    QList<Held> held;
+    while (select.next()) {
+        held.append({select.value(0).toInt(), select.value(1).toInt(),
+                     select.value(2).toInt(), select.value(3).toString()});
+    }
+    if (held.isEmpty()) { // 都已支付或被删除
+        db.rollback();
+        return;
+    }
+
+    // 2. 一条 UPDATE 取消整批
+    QStringList heldPlaceholders;
+    for (qsizetype i = 0; i < held.size(); ++i) heldPlaceholders << "?";
+    QSqlQuery cancel(db);
+    cancel.prepare("UPDATE orders SET status = '已取消' WHERE ID IN (" + heldPlaceholders.join(", ") + ")");
+    for (const Held &h : held) cancel.addBindValue(h.orderId);
+    if (!DatabaseManager::exec(cancel)) {
+        qWarning() << "Expire Orders Error:" << cancel.lastError().text();
+        db.rollback();
+        retryLater();
+        return;
+    }
+
+    // 3. 余座计数按 (航班, 舱位) 合并后归还，同一个事务
+    QHash<QPair<int, int>, int> released;
+    for (const Held &h : held) {
+        released[qMakePair(h.flightId, cabinIndex(h.seatType))] += 1;
+    }
+    for (auto it = released.constBegin(); it != released.constEnd(); ++it) {
+        if (!SeatCounters::give(db, it.key().first, it.key().second, it.value())) {
+            db.rollback();
+            retryLater();
+            return;
+        }
+    }
+    if (!db.commit()) {
+        db.rollback();
+        retryLater();
+        return;
+    }
+
+    // 4. 提交之后再释放内存里的座位，同步内存航班库和搜索缓存
+    for (const Held &h : held) {
+        SeatInventory::instance().releaseSeat(h.flightId, h.seatType, h.seatNumber);
+    }
+    for (auto it = released.constBegin(); it != released.constEnd(); ++it) {
+        SeatCounters::committed(it.key().first, it.key().second, it.value());
+    }
+
+    qInfo() << "已取消超时未支付订单:" << held.size() << "单";
+}
@@ -0,0 +1,59 @@
+#ifndef ORDEREXPIRYSCHEDULER_H
+#define ORDEREXPIRYSCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QMutex>
+#include <QList>
+#include <QDateTime>
+#include <QSqlDatabase>
+#include <vector>
+
+// ==============================================================================
+//  未支付订单超时取消
+//  下单后订单处于 "未支付" 并占着座位，超过 Order/HoldMinutes 仍未支付就自动取消、释放座位。
+//  用哈希时间轮排程：每个订单只在下单 (或启动时) 登记一次，之后每个 tick 只看当前格子，
+//  不需要定期扫描 orders 表。到期的订单按批放进一个事务里取消，并同步座位位图和搜索缓存。
+//  已经支付/删除的订单到期时在 SQL 里按 status = '未支付' 过滤掉，不需要从时间轮里撤销。
+// ==============================================================================
+class OrderExpiryScheduler : public QObject {
+    Q_OBJECT
+public:
+    static OrderExpiryScheduler &instance();
+
+    // 从数据库读出所有未支付订单排进时间轮并开始走表 (在主线程调用一次)
+    bool start(const QSqlDatabase &db);
+
+    bool isEnabled() const { return m_holdMs > 0; }
+
+    // 新订单创建成功后登记，createdAt 为下单时间
+    void schedule(int orderId, const QDateTime &createdAt);
+
+private slots:
+    void tick();
+
+private:
+    struct Timer {
+        int orderId;
+        int rounds;     // 还要再转几圈
+    };
+
+    explicit OrderExpiryScheduler(QObject *parent = nullptr);
+
+    void scheduleAtLocked(int orderId, qint64 deadlineMs);
+    void dispatch(const QList<int> &orderIds);
+    void expireBatch(const QList<int> &orderIds);
+
+    static constexpr int kSlots = 512;
+
+    QMutex m_mutex;
+    std::vector<std::vector<Timer>> m_wheel;
+    int m_cursor = 0;
+    qint64 m_wheelTimeMs = 0;   // 当前格子对应的时间
+    qint64 m_tickMs = 1000;
+    qint64 m_holdMs = 0;
+    int m_batchSize = 200;
+    QTimer m_timer;
+};
+
+#endif // ORDEREXPIRYSCHEDULER_H
@@ -0,0 +1,104 @@
+#ifndef ORDERQUERIES_H
+#define ORDERQUERIES_H
+
+#include <QSqlQuery>
+#include <QDate>
+#include <QDateTime>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+
+// 订单历史的翻页/过滤条件
+struct OrderHistoryFilter {
+    int userId = 0;
+    int limit = 50;                 // 每页条数；0 表示不翻页，一次返回全部
+    int status = -1;                // 与返回值一致：0 未支付, 1 已支付, 2 其他；-1 不限
+    QDate fromDate;                 // 下单日期范围 [fromDate, toDate]，无效表示不限
+    QDate toDate;
+    bool hasCursor = false;         // 上一页最后一条的 (order_date, ID)
+    QDateTime cursorDate;
+    int cursorId = 0;
+};
+
+// 订单列表里的一行 (handleGetOrders 按行物化出来，再交给 OrderController::writeOrderRow)
+struct OrderRecord {
+    int orderId = 0;
+    QString status;                 // 库里的中文状态
+    QString flightNumber;
+    QString airline;
+    QString origin;
+    QString destination;
+    QString aircraftModel;
+    QDateTime departureTime;
+    QDateTime landingTime;
+    QString seatNumber;
+    int seatType = 0;
+    int price = 0;                  // 所订舱位的票价
+};
+
+// ==============================================================================
+//  订单查询共用的 SQL (OrderController 以及 --check-query-plans 共用同一份文本)
+// ==============================================================================
+class OrderQueries {
+public:
+    static constexpr int kMaxPageSize = 200;
+
+    // 按 (order_date, ID) 倒序的 keyset 翻页：
+    // 带着上一页最后一条的 (order_date, ID) 往后取，而不是 OFFSET，
+    // 配合 idx_user_date (user_id, order_date, ID)，每页只读 limit+1 行，和用户订单总数无关
+    // 多取一行用来判断是否还有下一页；limit 为 0 时不加 LIMIT
+    static QString historyPageSql(const OrderHistoryFilter &f) {
+        QString sql = QStringLiteral(
+            "SELECT "
+            "o.ID as order_id, o.seat_type, o.seat_number, o.order_date, o.status, "
+            "f.flight_number, f.airline, f.origin, f.destination, "
+            "f.departure_time, f.landing_time, f.aircraft_model, "
+            "f.economy_price, f.business_price, f.first_class_price "
+            "FROM orders o "
+            "JOIN flights f ON o.flight_id = f.ID "
+            "WHERE o.user_id = ?");
+        if (f.status == 0 || f.status == 1) sql += " AND o.status = ?";
+        else if (f.status == 2) sql += " AND o.status NOT IN ('未支付', '已支付')";
+        if (f.fromDate.isValid()) sql += " AND o.order_date >= ?";
+        if (f.toDate.isValid()) sql += " AND o.order_date < ?";
+        // 写成展开形式而不是 (o.order_date, o.ID) < (?, ?)，MySQL 对行构造器比较不一定能走范围扫描
+        if (f.hasCursor) sql += " AND (o.order_date < ? OR (o.order_date = ? AND o.ID < ?))";
+        sql += " ORDER BY o.order_date DESC, o.ID DESC";
+        if (f.limit > 0) sql += " LIMIT " + QString::number(f.limit + 1);
+        return sql;
+    }
+
+    // 按 historyPageSql() 里占位符的顺序绑定参数
+    static void bindHistoryPage(QSqlQuery &query, const OrderHistoryFilter &f) {
+        query.addBindValue(f.userId);
+        if (f.status == 0) query.addBindValue(QStringLiteral("未支付"));
+        else if (f.status == 1) query.addBindValue(QStringLiteral("已支付"));
+        if (f.fromDate.isValid()) query.addBindValue(f.fromDate.toString("yyyy-MM-dd") + " 00:00:00");
+        if (f.toDate.isValid()) query.addBindValue(f.toDate.addDays(1).toString("yyyy-MM-dd") + " 00:00:00");
+        if (f.hasCursor) {
+            const QString date = f.cursorDate.toString("yyyy-MM-dd HH:mm:ss");
+            query.addBindValue(date);
+            query.addBindValue(date);
+            query.addBindValue(f.cursorId);
+        }
+    }
+
+    // 游标对前端是不透明的字符串："yyyy-MM-dd HH:mm:ss|ID" 做 base64url
+    static QString encodeCursor(const QDateTime &orderDate, int id) {
+        const QByteArray raw = (orderDate.toString("yyyy-MM-dd HH:mm:ss") + '|' + QString::number(id)).toUtf8();
+        return QString::fromLatin1(raw.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals));
+    }
+
+    // 解析失败返回 false
+    static bool decodeCursor(const QString &cursor, QDateTime *orderDate, int *id) {
+        const QString raw = QString::fromUtf8(QByteArray::fromBase64(cursor.toLatin1(), QByteArray::Base64UrlEncoding));
+        const QStringList parts = raw.split('|');
+        if (parts.size() != 2) return false;
+        bool ok = false;
+        *id = parts[1].toInt(&ok);
+        *orderDate = QDateTime::fromString(parts[0], "yyyy-MM-dd HH:mm:ss");
+        return ok && orderDate->isValid();
+    }
+};
+
+#endif // ORDERQUERIES_H
@@ -1,5 +1,6 @@
 #include "PaymentController.h"
 #include "DatabaseManager.h"
+#include "UserProfileCache.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -19,13 +20,13 @@ PaymentController::PaymentController(QObject *parent)
 void PaymentController::registerRoutes(QHttpServer *server)
 {
     // 1. 用户充值接口
-    server->route("/api/user/recharge", QHttpServerRequest::Method::Post,
+    routeConcurrent(server, "/api/user/recharge", QHttpServerRequest::Method::Post,
                   [this](const QHttpServerRequest &req) {
                       return handleRecharge(req);
                   });
 
     // 2. 订单支付接口
-    server->route("/api/payment", QHttpServerRequest::Method::Post,
+    routeConcurrent(server, "/api/payment", QHttpServerRequest::Method::Post,
                   [this](const QHttpServerRequest &req) {
                       return handlePayment(req);
                   });
@@ -49,17 +50,16 @@ QHttpServerResponse PaymentController::handleRecharge(const QHttpServerRequest &
         return createErrorResponse("参数无效: 用户ID或金额不正确");
     }
 
-    QSqlDatabase db = DatabaseManager::getConnection();
+    PooledConnection db = DatabaseManager::getConnection();
     if (!db.isOpen()) {
         return createErrorResponse("数据库连接失败", QHttpServerResponse::StatusCode::InternalServerError);
     }
 
-    QSqlQuery query(db);
-    query.prepare("UPDATE users SET balance = balance + ? WHERE U_ID = ?");
+    QSqlQuery &query = db.prepared("UPDATE users SET balance = balance + ? WHERE U_ID = ?");
     query.addBindValue(amount);
     query.addBindValue(uid);
 
-    if (!query.exec()) {
+    if (!DatabaseManager::exec(query)) {
         return createErrorResponse("充值失败: " + query.lastError().text(), QHttpServerResponse::StatusCode::InternalServerError);
     }
 
@@ -68,6 +68,10 @@ QHttpServerResponse PaymentController::handleRecharge(const QHttpServerRequest &
         return createErrorResponse("用户不存在", QHttpServerResponse::StatusCode::NotFound);
     }
 
+    // 余额变了，缓存的用户资料作废；该用户接下来的读走主库
+    DatabaseManager::noteWrite(uid);
+    UserProfileCache::instance().invalidate(uid);
+
     return createSuccessResponse("充值成功");
 }
 
@@ -90,15 +94,14 @@ QHttpServerResponse PaymentController::handlePayment(const QHttpServerRequest &r
     if (userId <= 0 || orderId.isEmpty()) {
         return createErrorResponse("参数不完整 (uid, order_id)");
     }
-    QSqlDatabase db = DatabaseManager::getConnection();
+    PooledConnection db = DatabaseManager::getConnection();
     if (!db.isOpen()) {
         return createErrorResponse("数据库连接失败", QHttpServerResponse::StatusCode::InternalServerError);
     }
     // 2. 查询订单信息
-    QSqlQuery orderQuery(db);
-    orderQuery.prepare("SELECT ID, user_id, status, total_amount FROM orders WHERE ID = ?");
+    QSqlQuery &orderQuery = db.prepared("SELECT ID, user_id, status, total_amount FROM orders WHERE ID = ?");
     orderQuery.addBindValue(orderId);
-    if (!orderQuery.exec() || !orderQuery.next()) {
+    if (!DatabaseManager::exec(orderQuery) || !orderQuery.next()) {
         return createErrorResponse("订单不存在", QHttpServerResponse::StatusCode::NotFound);
     }
 
@@ -119,8 +122,7 @@ QHttpServerResponse PaymentController::handlePayment(const QHttpServerRequest &r
     db.transaction();
     try {
         // --- 核心步骤：直接在 users 表扣除全款 ---
-        QSqlQuery deductQuery(db);
-        deductQuery.prepare(
+        QSqlQuery &deductQuery = db.prepared(
             "UPDATE users "
             "SET balance = balance - ? "
             "WHERE U_ID = ? AND balance >= ?"
@@ -129,23 +131,29 @@ QHttpServerResponse PaymentController::handlePayment(const QHttpServerRequest &r
         deductQuery.addBindValue(userId);
         deductQuery.addBindValue(totalAmount);
 
-        if (!deductQuery.exec()) {
+        if (!DatabaseManager::exec(deductQuery)) {
             throw std::runtime_error("数据库执行错误: " + deductQuery.lastError().text().toStdString());
         }
         if (deductQuery.numRowsAffected() == 0) {
             throw std::runtime_error("余额不足，支付失败");
         }
-        QSqlQuery updateOrder(db);
-        updateOrder.prepare(
+        QSqlQuery &updateOrder = db.prepared(
             "UPDATE orders SET status = '已支付', paid_amount = ?,payment_method = 'balance' "
-            "WHERE ID = ?"
+            "WHERE ID = ? AND status = '未支付'"
             );
         updateOrder.addBindValue(totalAmount); // 已付金额 = 总金额
         updateOrder.addBindValue(orderId);
-        if (!updateOrder.exec()) {
+        if (!DatabaseManager::exec(updateOrder)) {
             throw std::runtime_error("更新订单状态失败");
         }
+        // 查询之后订单可能刚好超时被取消了，这时连同扣款一起回滚
+        if (updateOrder.numRowsAffected() == 0) {
+            throw std::runtime_error("订单已超时取消，请重新下单");
+        }
         db.commit();
+        // 余额变了，缓存的用户资料作废；该用户接下来的读走主库
+        DatabaseManager::noteWrite(userId);
+        UserProfileCache::instance().invalidate(userId);
         QJsonObject response = createSuccessResponse("支付成功");
         response["data"] = QJsonObject{
             {"order_id", orderId},
@@ -188,7 +196,7 @@ bool PaymentController::userExists(QSqlDatabase &db, int userId)
     QSqlQuery q(db);
     q.prepare("SELECT U_ID FROM users WHERE U_ID = ?");
     q.addBindValue(userId);
-    return q.exec() && q.next();
+    return DatabaseManager::exec(q) && q.next();
 }
 
 QJsonObject PaymentController::createSuccessResponse(const QString &message)
@@ -0,0 +1,81 @@
+#include "QueryPlanCheck.h"
+#include "FlightQueries.h"
+#include "OrderQueries.h"
+#include "SqlDialect.h"
+
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlError>
+#include <QDate>
+#include <QDebug>
+
+QList<QueryPlanCheck::Case> QueryPlanCheck::cases()
+{
+    QList<Case> list;
+
+    // 航班搜索 (FlightController::handleSearchFlights / AIController::searchFlightsInDB)
+    const QDate day(2025, 12, 1);
+    list.append({"search_flights", FlightQueries::searchByRouteDaySql(),
+                 {"北京", "上海",
+                  day.toString("yyyy-MM-dd") + " 00:00:00",
+                  day.addDays(1).toString("yyyy-MM-dd") + " 00:00:00"}});
+
+    // 订单历史翻页 (OrderController::handleGetOrders)，检查带游标的中间页
+    OrderHistoryFilter page;
+    page.userId = 1;
+    page.hasCursor = true;
+    page.cursorDate = QDateTime(day, QTime(12, 0));
+    page.cursorId = 1000;
+    Case history{"order_history_page", OrderQueries::historyPageSql(page), {}};
+    history.bindValues << page.userId << page.cursorDate.toString("yyyy-MM-dd HH:mm:ss")
+                       << page.cursorDate.toString("yyyy-MM-dd HH:mm:ss") << page.cursorId;
+    list.append(history);
+
+    // 启动时加载未支付订单 (OrderExpiryScheduler::start)
+    list.append({"unpaid_orders", "SELECT ID, order_date FROM orders WHERE status = '未支付'", {}});
+
+    return list;
+}
+
+bool QueryPlanCheck::run(const QSqlDatabase &db)
+{
+    bool allPassed = true;
+
+    for (const Case &c : cases()) {
+        QSqlQuery explain(db);
+        explain.prepare(SqlDialect::explainPrefix() + c.sql);
+        for (const QVariant &v : c.bindValues) explain.addBindValue(v);
+
+        if (!explain.exec()) {
+            qWarning() << "[PLAN]" << c.name << "EXPLAIN 执行失败:" << explain.lastError().text();
+            allPassed = false;
+            continue;
+        }
+
+        // EXPLAIN 每一行对应一张表的访问方式
+        bool passed = true;
+        while (explain.next()) {
+            const QSqlRecord rec = explain.record();
+            qInfo().noquote() << "[PLAN]" << c.name << SqlDialect::describePlanRow(rec);
+
+            // 全表扫描或全索引扫描，都说明过滤条件没有用上索引 (小表除外，见 kSmallTableRows)
+            if (SqlDialect::isFullScan(rec)) {
+                const qint64 rows = SqlDialect::planRowEstimate(rec);
+                if (rows >= 0 && rows < kSmallTableRows) {
+                    qInfo() << "[PLAN]" << c.name << "表只有约" << rows << "行，全表扫描不计为失败";
+                } else {
+                    passed = false;
+                }
+            }
+        }
+
+        if (!passed) {
+            qWarning() << "[PLAN]" << c.name << "FAILED: 查询退化为全表扫描\n" << c.sql;
+            allPassed = false;
+        } else {
+            qInfo() << "[PLAN]" << c.name << "OK";
+        }
+    }
+
+    return allPassed;
+}
@@ -0,0 +1,33 @@
+#ifndef QUERYPLANCHECK_H
+#define QUERYPLANCHECK_H
+
+#include <QSqlDatabase>
+#include <QVariantList>
+#include <QString>
+#include <QList>
+
+// ==============================================================================
+//  查询计划回归检查 (FlightBackendServer --check-query-plans)
+//  对热点查询跑一遍 EXPLAIN，出现全表扫描 (MySQL type = ALL / index，SQLite SCAN) 就判定失败，
+//  用来防止 DATE(departure_time) 这种写法再次让索引失效。
+//  表很小时 (示例数据) MySQL 优化器认为全表扫描更便宜，估算行数低于 kSmallTableRows 的全表扫描不算失败
+// ==============================================================================
+class QueryPlanCheck {
+public:
+    struct Case {
+        QString name;
+        QString sql;
+        QVariantList bindValues;
+    };
+
+    // 估算行数低于这个值的全表扫描放过 (SQLite 的查询计划没有行数估算，不适用)
+    static constexpr qint64 kSmallTableRows = 1000;
+
+    // 需要检查的查询列表
+    static QList<Case> cases();
+
+    // 全部通过返回 true，结果逐条打印到日志
+    static bool run(const QSqlDatabase &db);
+};
+
+#endif // QUERYPLANCHECK_H
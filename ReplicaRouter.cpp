@@ -0,0 +1,212 @@
+#include "ReplicaRouter.h"
+#include "AppConfig.h"
+#include "DatabaseManager.h"
+
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlError>
+#include <QMutexLocker>
+#include <QVarLengthArray>
+#include <QDebug>
+#include <algorithm>
+
+// 分片里的记录超过这个数时清理一次过期的 uid
+static const int kWriteShardPruneSize = 4096;
+
+ReplicaRouter &ReplicaRouter::instance()
+{
+    static ReplicaRouter router;
+    return router;
+}
+
+ReplicaRouter::ReplicaRouter()
+{
+    m_clock.start();
+
+    const QString help = "Read-only connection requests by routing decision";
+    m_toReplica = Metrics::instance().counter("db_read_routing_total", help, "route=\"replica\"");
+    m_toPrimaryRecent = Metrics::instance().counter("db_read_routing_total", help, "route=\"primary_recent_write\"");
+    m_toPrimaryFallback = Metrics::instance().counter("db_read_routing_total", help, "route=\"primary_fallback\"");
+
+    m_readYourWritesMs = qMax<qint64>(0, AppConfig::value("Replica/ReadYourWritesMs", m_readYourWritesMs).toLongLong());
+    m_retryAfterMs = qMax<qint64>(1, AppConfig::value("Replica/RetryAfterSec", m_retryAfterMs / 1000).toLongLong()) * 1000;
+    m_maxLagSec = qMax(0, AppConfig::value("Replica/MaxLagSec", m_maxLagSec).toInt());
+    m_borrowTimeoutMs = qMax(0, AppConfig::value("Replica/BorrowTimeoutMs", m_borrowTimeoutMs).toInt());
+
+    const QStringList hosts = AppConfig::value("Replica/Hosts").toString().split(',', Qt::SkipEmptyParts);
+    if (hosts.isEmpty()) return;
+    if (SqlDialect::isSqlite()) {
+        qWarning() << "SQLite 后端不支持只读副本，[Replica]/Hosts 被忽略";
+        return;
+    }
+
+    // 副本的库名、驱动、池参数沿用主库，账号可以单独配置 (只读账号)
+    const ConnectionOptions &primary = DatabaseManager::pool().options();
+    for (const QString &entry : hosts) {
+        const QString hostPort = entry.trimmed();
+        const int colon = hostPort.lastIndexOf(':');
+
+        ConnectionOptions opt = primary;
+        opt.host = colon > 0 ? hostPort.left(colon) : hostPort;
+        opt.port = colon > 0 ? hostPort.mid(colon + 1).toInt() : 3306;
+        opt.userName = AppConfig::value("Replica/User", primary.userName).toString();
+        opt.password = AppConfig::value("Replica/Password", primary.password).toString();
+        opt.minSize = 0; // 副本可能起不来，不预热，第一次借用时再连
+        opt.maxSize = qMax(1, AppConfig::value("Replica/PoolMaxSize", primary.maxSize).toInt());
+
+        auto replica = std::make_unique<Replica>();
+        replica->address = opt.host + ':' + QString::number(opt.port);
+        replica->pool = std::make_unique<ConnectionPool>("replica" + QString::number(m_replicas.size()), opt);
+        m_replicas.push_back(std::move(replica));
+    }
+    qInfo() << "读写分离：只读副本" << m_replicas.size() << "个, 写后读主库窗口" << m_readYourWritesMs << "ms";
+}
+
+PooledConnection ReplicaRouter::acquireRead(int uid)
+{
+    if (m_replicas.empty()) return DatabaseManager::pool().acquire();
+
+    // 1. 读自己的写：该用户刚写过，副本可能还没追上
+    if (uid > 0 && recentlyWrote(uid)) {
+        m_toPrimaryRecent->inc();
+        return DatabaseManager::pool().acquire();
+    }
+
+    // 2. 候选：健康的副本，以及被摘掉但已到重试时间的副本；池满的先跳过
+    struct Candidate { Replica *replica; int inUse; quint64 timeouts; };
+    QVarLengthArray<Candidate, 8> candidates;
+    const qint64 now = m_clock.elapsed();
+    const size_t n = m_replicas.size();
+    const size_t start = m_next.fetch_add(1, std::memory_order_relaxed) % n;
+    for (size_t i = 0; i < n; ++i) {
+        Replica *r = m_replicas[(start + i) % n].get();
+        if (!r->healthy.load(std::memory_order_relaxed) && now < r->retryAtMs.load(std::memory_order_relaxed)) continue;
+        const PoolStats s = r->pool->stats();
+        if (s.idle == 0 && s.total >= s.maxSize) continue;
+        candidates.append({r, s.inUse, s.timeoutCount});
+    }
+
+    // 3. 借出连接最少的优先 (稳定排序，负载相同时保持轮换顺序)
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const Candidate &a, const Candidate &b) { return a.inUse < b.inUse; });
+    for (const Candidate &c : candidates) {
+        PooledConnection db = c.replica->pool->acquire(m_borrowTimeoutMs);
+        if (db.isOpen()) {
+            m_toReplica->inc();
+            return db;
+        }
+        // 等待超时只说明这个副本忙，不算故障；连不上才摘掉
+        if (c.replica->pool->stats().timeoutCount == c.timeouts) {
+            markDown(c.replica, "连接失败");
+        }
+    }
+
+    // 4. 没有可用的副本，退回主库
+    m_toPrimaryFallback->inc();
+    return DatabaseManager::pool().acquire();
+}
+
+void ReplicaRouter::noteWrite(int uid)
+{
+    if (uid <= 0 || m_replicas.empty() || m_readYourWritesMs == 0) return;
+
+    const qint64 now = m_clock.elapsed();
+    WriteShard &shard = m_writes[uint(uid) % kWriteShards];
+    QMutexLocker locker(&shard.mutex);
+    shard.untilMs.insert(uid, now + m_readYourWritesMs);
+    if (shard.untilMs.size() > kWriteShardPruneSize) {
+        shard.untilMs.removeIf([now](QHash<int, qint64>::iterator it) { return it.value() <= now; });
+    }
+}
+
+bool ReplicaRouter::recentlyWrote(int uid) const
+{
+    const WriteShard &shard = m_writes[uint(uid) % kWriteShards];
+    QMutexLocker locker(&shard.mutex);
+    auto it = shard.untilMs.constFind(uid);
+    return it != shard.untilMs.constEnd() && it.value() > m_clock.elapsed();
+}
+
+void ReplicaRouter::markDown(Replica *replica, const QString &reason)
+{
+    // 启动后第一次检查就失败时副本本来就是摘掉的状态，也要打日志
+    const bool firstProbe = replica->retryAtMs.exchange(m_clock.elapsed() + m_retryAfterMs) == kNotProbed;
+    if (replica->healthy.exchange(false) || firstProbe) {
+        qWarning() << "只读副本" << replica->address << "暂停使用:" << reason;
+    }
+}
+
+void ReplicaRouter::checkHealth()
+{
+    // 上一轮还没做完 (例如副本连接超时) 就不再叠加一轮
+    if (m_checking.exchange(true)) return;
+
+    for (const std::unique_ptr<Replica> &r : m_replicas) {
+        const quint64 timeouts = r->pool->stats().timeoutCount;
+        PooledConnection db = r->pool->acquire(m_borrowTimeoutMs);
+        if (!db.isOpen()) {
+            // 池满等待超时说明副本正在正常服务，这一轮跳过
+            if (r->pool->stats().timeoutCount == timeouts) markDown(r.get(), "连接失败");
+            continue;
+        }
+
+        bool ok = true;
+        QString reason;
+        qint64 lag = -1;
+        if (m_maxLagSec > 0) {
+            ok = queryLag(db, &lag);
+            if (!ok) reason = "无法读取复制状态 (未配置复制、复制线程已停止或账号缺少 REPLICATION CLIENT 权限)";
+            else if (lag > m_maxLagSec) { ok = false; reason = QString("复制延迟 %1 秒").arg(lag); }
+        } else {
+            QSqlQuery ping(db);
+            ok = ping.exec("SELECT 1");
+            if (!ok) reason = ping.lastError().text();
+        }
+        r->lagSec.store(lag, std::memory_order_relaxed);
+
+        if (!ok) {
+            markDown(r.get(), reason);
+        } else if (!r->healthy.exchange(true)) {
+            qInfo() << "只读副本" << r->address << "恢复使用";
+        }
+    }
+    m_checking.store(false);
+}
+
+bool ReplicaRouter::queryLag(PooledConnection &db, qint64 *lagSec)
+{
+    // MySQL 8.0.22 起是 SHOW REPLICA STATUS / Seconds_Behind_Source，更早的版本只认旧写法
+    QSqlQuery query(db);
+    QString column = "Seconds_Behind_Source";
+    if (!query.exec("SHOW REPLICA STATUS")) {
+        column = "Seconds_Behind_Master";
+        if (!query.exec("SHOW SLAVE STATUS")) return false;
+    }
+    if (!query.next()) return false; // 不是副本
+
+    // 复制线程没在跑时为 NULL
+    const QVariant value = query.value(query.record().indexOf(column));
+    if (value.isNull()) return false;
+    *lagSec = value.toLongLong();
+    return true;
+}
+
+void ReplicaRouter::evictIdle()
+{
+    for (const std::unique_ptr<Replica> &r : m_replicas) r->pool->evictIdle();
+}
+
+QList<ReplicaRouter::ReplicaStatus> ReplicaRouter::status() const
+{
+    QList<ReplicaStatus> list;
+    for (const std::unique_ptr<Replica> &r : m_replicas) {
+        ReplicaStatus s;
+        s.name = r->pool->name();
+        s.address = r->address;
+        s.healthy = r->healthy.load(std::memory_order_relaxed);
+        s.lagSec = r->lagSec.load(std::memory_order_relaxed);
+        s.pool = r->pool->stats();
+        list.append(s);
+    }
+    return list;
+}
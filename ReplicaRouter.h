@@ -0,0 +1,98 @@
+#ifndef REPLICAROUTER_H
+#define REPLICAROUTER_H
+
+#include "ConnectionPool.h"
+#include "Metrics.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// ==============================================================================
+//  只读副本路由 (读写分离)
+//  - [Replica]/Hosts 配置 N 个 MySQL 只读副本，每个副本一个连接池，账号/库名与主库相同
+//  - 只读接口 (订单列表、AI 航班查询) 通过
+//    DatabaseManager::getReadConnection(uid) 借连接：在健康的副本里挑借出连接最少的那个
+//  - 读自己的写：用户写操作提交后调用 noteWrite(uid)，ReadYourWritesMs 之内该用户的读仍然走主库，
+//    避免刚下单/支付就在列表里看不到 (副本还没追上)
+//  - 健康检查 checkHealth() 由定时器放到工作线程执行：连不上或复制延迟超过 MaxLagSec 的副本暂时摘掉；
+//    借连接时连接失败也会立即摘掉，RetryAfterSec 之后再试；启动后第一次检查通过之前副本不接读请求
+//  - 检查复制延迟 (MaxLagSec > 0，默认 3) 需要副本账号有 REPLICATION CLIENT 权限，没有权限时副本会一直被摘掉；
+//    两个独立实例的本地测试可以设 MaxLagSec=0，只检查连通性
+//  - 航班搜索的 SQL 兜底查询和用户资料不走副本：结果会写进 SearchCache / UserProfileCache，缓存只随主库上的写入失效
+//  - 写操作提交后先 noteWrite(uid) 再作废缓存，之后的缓存未命中不会被路由到副本
+//  - 所有副本都不可用时退回主库；未配置副本或使用 SQLite 时读写都走主库
+//  - 下单/支付事务里的读 (锁座、扣余额前的检查) 仍然用 getConnection()，只有主库的数据是准的
+// ==============================================================================
+class ReplicaRouter {
+public:
+    static ReplicaRouter &instance();
+
+    bool hasReplicas() const { return !m_replicas.empty(); }
+
+    // 借一条读连接：uid 最近写过、或没有可用副本时返回主库连接
+    PooledConnection acquireRead(int uid);
+
+    // 用户写操作提交之后调用 (uid <= 0 时忽略)
+    void noteWrite(int uid);
+
+    // 探测每个副本的连通性和复制延迟 (会借连接、阻塞，放在工作线程里调用)
+    void checkHealth();
+
+    // 回收副本连接池里的空闲连接
+    void evictIdle();
+
+    struct ReplicaStatus {
+        QString name;         // 连接池名 (replica0, replica1 ...)
+        QString address;      // host:port
+        bool healthy = true;
+        qint64 lagSec = -1;   // 最近一次探测到的复制延迟，-1 表示未知
+        PoolStats pool;
+    };
+    QList<ReplicaStatus> status() const;
+
+private:
+    struct Replica {
+        std::unique_ptr<ConnectionPool> pool;
+        QString address;
+        std::atomic<bool> healthy{false};       // 第一次健康检查通过之后才接读请求
+        std::atomic<qint64> retryAtMs{kNotProbed}; // 被摘掉后，到这个时间 (m_clock) 之前不再尝试
+        std::atomic<qint64> lagSec{-1};
+    };
+
+    static constexpr qint64 kNotProbed = std::numeric_limits<qint64>::max();
+
+    ReplicaRouter();
+
+    bool recentlyWrote(int uid) const;
+    void markDown(Replica *replica, const QString &reason);
+    bool queryLag(PooledConnection &db, qint64 *lagSec);
+
+    std::vector<std::unique_ptr<Replica>> m_replicas;
+    std::atomic<quint32> m_next{0}; // 负载相同时从这里开始轮换
+    std::atomic<bool> m_checking{false};
+
+    // uid -> 截止时间 (m_clock)，按 uid 分片减少锁竞争；过期的记录在分片变大时顺带清理
+    static constexpr int kWriteShards = 16;
+    struct WriteShard {
+        mutable QMutex mutex;
+        QHash<int, qint64> untilMs;
+    };
+    WriteShard m_writes[kWriteShards];
+
+    QElapsedTimer m_clock;
+    qint64 m_readYourWritesMs = 3000;
+    qint64 m_retryAfterMs = 10000;
+    int m_maxLagSec = 3;          // 0 表示不检查复制延迟 (只检查连通性)
+    int m_borrowTimeoutMs = 200;  // 副本池满时最多等多久，超时换下一个副本或主库
+
+    MetricCounter *m_toReplica = nullptr;     // 读请求路由结果见 /metrics
+    MetricCounter *m_toPrimaryRecent = nullptr;
+    MetricCounter *m_toPrimaryFallback = nullptr;
+};
+
+#endif // REPLICAROUTER_H
@@ -0,0 +1,153 @@
+#include "SearchCache.h"
+#include "AppConfig.h"
+
+#include <QDateTime>
+#include <QMutexLocker>
+
+SearchCache &SearchCache::instance()
+{
+    static SearchCache cache;
+    return cache;
+}
+
+SearchCache::SearchCache()
+{
+    // MaxMB=0 表示关闭缓存
+    m_maxBytes = AppConfig::value("SearchCache/MaxMB", 64).toLongLong() * 1024 * 1024;
+    m_ttlMs = AppConfig::value("SearchCache/TtlSec", 60).toLongLong() * 1000;
+
+    m_hits = Metrics::instance().counter("cache_lookups_total", "In-memory cache lookups by cache and result",
+                                         "cache=\"search\",result=\"hit\"");
+    m_misses = Metrics::instance().counter("cache_lookups_total", "In-memory cache lookups by cache and result",
+                                           "cache=\"search\",result=\"miss\"");
+}
+
+QString SearchCache::routeDayKey(const QString &origin, const QString &destination, const QDate &date)
+{
+    return origin + '|' + destination + '|' + date.toString("yyyy-MM-dd");
+}
+
+bool SearchCache::lookup(const QString &key, QByteArray *body)
+{
+    if (!isEnabled()) return false;
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.constFind(key);
+    if (it == m_entries.constEnd()) {
+        m_misses->inc();
+        return false;
+    }
+
+    EntryList::iterator entry = it.value();
+    if (entry->expiresAtMs <= QDateTime::currentMSecsSinceEpoch()) {
+        removeLocked(entry);
+        m_misses->inc();
+        return false;
+    }
+
+    m_lru.splice(m_lru.begin(), m_lru, entry); // 移到头部
+    *body = entry->body;                        // QByteArray 隐式共享，这里不拷贝数据
+    m_hits->inc();
+    return true;
+}
+
+quint64 SearchCache::generation() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_generation;
+}
+
+void SearchCache::insert(const QString &key, const QString &routeDay, const QList<int> &flightIds,
+                         const QByteArray &body, quint64 generation)
+{
+    if (!isEnabled() || body.size() > m_maxBytes) return;
+
+    QMutexLocker locker(&m_mutex);
+    // 计算期间本条结果涉及的数据变了，结果可能已过期
+    if (m_clearedAt > generation || m_routeDayInvalidatedAt.value(routeDay) > generation) return;
+    for (int id : flightIds) {
+        if (m_flightInvalidatedAt.value(id) > generation) return;
+    }
+
+    auto old = m_entries.find(key);
+    if (old != m_entries.end()) removeLocked(old.value());
+
+    Entry entry;
+    entry.key = key;
+    entry.routeDay = routeDay;
+    entry.flightIds = flightIds;
+    entry.body = body;
+    entry.expiresAtMs = QDateTime::currentMSecsSinceEpoch() + m_ttlMs;
+    m_lru.push_front(std::move(entry));
+
+    m_entries.insert(key, m_lru.begin());
+    for (int id : flightIds) m_byFlight[id].insert(key);
+    m_byRouteDay[routeDay].insert(key);
+    m_bytes += body.size() + key.size() * 2;
+
+    // 超出字节上限，从尾部淘汰最久未用的
+    while (m_bytes > m_maxBytes && !m_lru.empty()) {
+        removeLocked(std::prev(m_lru.end()));
+    }
+}
+
+void SearchCache::invalidateFlight(int flightId)
+{
+    if (!isEnabled()) return;
+
+    QMutexLocker locker(&m_mutex);
+    m_flightInvalidatedAt.insert(flightId, ++m_generation);
+    const QSet<QString> keys = m_byFlight.take(flightId);
+    for (const QString &key : keys) {
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) removeLocked(it.value());
+    }
+}
+
+void SearchCache::invalidateRouteDay(const QString &origin, const QString &destination, const QDate &date)
+{
+    if (!isEnabled()) return;
+
+    QMutexLocker locker(&m_mutex);
+    const QString routeDay = routeDayKey(origin, destination, date);
+    m_routeDayInvalidatedAt.insert(routeDay, ++m_generation);
+    const QSet<QString> keys = m_byRouteDay.take(routeDay);
+    for (const QString &key : keys) {
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) removeLocked(it.value());
+    }
+}
+
+void SearchCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_clearedAt = ++m_generation;
+    m_flightInvalidatedAt.clear();      // 早于 m_clearedAt 的记录不再有用
+    m_routeDayInvalidatedAt.clear();
+    m_lru.clear();
+    m_entries.clear();
+    m_byFlight.clear();
+    m_byRouteDay.clear();
+    m_bytes = 0;
+}
+
+void SearchCache::removeLocked(EntryList::iterator it)
+{
+    // 反向索引里可能残留已删除的 key，这里顺手清掉
+    for (int id : it->flightIds) {
+        auto f = m_byFlight.find(id);
+        if (f != m_byFlight.end()) {
+            f->remove(it->key);
+            if (f->isEmpty()) m_byFlight.erase(f);
+        }
+    }
+    auto r = m_byRouteDay.find(it->routeDay);
+    if (r != m_byRouteDay.end()) {
+        r->remove(it->key);
+        if (r->isEmpty()) m_byRouteDay.erase(r);
+    }
+
+    m_bytes -= it->body.size() + it->key.size() * 2;
+    m_entries.remove(it->key);
+    m_lru.erase(it);
+}
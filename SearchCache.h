@@ -0,0 +1,77 @@
+#ifndef SEARCHCACHE_H
+#define SEARCHCACHE_H
+
+#include "Metrics.h"
+
+#include <QString>
+#include <QByteArray>
+#include <QDate>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QMutex>
+#include <list>
+
+// ==============================================================================
+//  航班搜索响应缓存
+//  key 为 (出发城市, 到达城市, 日期, 舱位 [, 其他过滤条件])，value 是已经序列化好的响应 JSON，
+//  命中时直接把字节写回，不再构造 QJsonObject。
+//  按总字节数做 LRU 淘汰，每条记录另有 TTL 兜底。
+//  失效是精确的：
+//    - 航班 ID -> 包含该航班的缓存条目 (修改/删除航班、下单退票影响余票)
+//    - 航线+日期 -> 该航线当天的所有缓存条目 (新增航班、航班改到别的航线/日期)
+// ==============================================================================
+class SearchCache {
+public:
+    static SearchCache &instance();
+
+    // 航线+日期的统一写法，搜索时用中文城市名
+    static QString routeDayKey(const QString &origin, const QString &destination, const QDate &date);
+
+    bool isEnabled() const { return m_maxBytes > 0; }
+
+    // 命中返回 true 并写入 *body
+    bool lookup(const QString &key, QByteArray *body);
+
+    // 计算结果之前先取一次代数；插入时若这次结果涉及的航班或航线+日期在此之后失效过，就放弃插入，
+    // 避免把旧结果写回缓存。只比较本条结果相关的失效，其他航线上的下单退票不影响插入
+    quint64 generation() const;
+    void insert(const QString &key, const QString &routeDay, const QList<int> &flightIds,
+                const QByteArray &body, quint64 generation);
+
+    void invalidateFlight(int flightId);
+    void invalidateRouteDay(const QString &origin, const QString &destination, const QDate &date);
+    void clear();
+
+private:
+    struct Entry {
+        QString key;
+        QString routeDay;
+        QList<int> flightIds;
+        QByteArray body;
+        qint64 expiresAtMs = 0;
+    };
+    using EntryList = std::list<Entry>;
+
+    SearchCache();
+
+    void removeLocked(EntryList::iterator it);
+
+    mutable QMutex m_mutex;
+    EntryList m_lru;                                   // 头部最近使用
+    QHash<QString, EntryList::iterator> m_entries;
+    QHash<int, QSet<QString>> m_byFlight;
+    QHash<QString, QSet<QString>> m_byRouteDay;
+    qint64 m_bytes = 0;
+    qint64 m_maxBytes = 0;
+    qint64 m_ttlMs = 0;
+    MetricCounter *m_hits = nullptr;    // 命中率见 /metrics
+    MetricCounter *m_misses = nullptr;
+    // 每次失效把 m_generation 加一，并记下失效对象最后一次失效时的代数
+    quint64 m_generation = 0;
+    quint64 m_clearedAt = 0;
+    QHash<int, quint64> m_flightInvalidatedAt;        // 条数不超过航班数
+    QHash<QString, quint64> m_routeDayInvalidatedAt;  // 条数不超过 (航线, 日期) 数
+};
+
+#endif // SEARCHCACHE_H
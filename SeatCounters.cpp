@@ -0,0 +1,200 @@
+#include "SeatCounters.h"
+#include "SeatInventory.h"
+#include "FlightStore.h"
+#include "SearchCache.h"
+#include "DatabaseManager.h"
+
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QRandomGenerator>
+#include <QDebug>
+
+static int randomShard()
+{
+    return QRandomGenerator::global()->bounded(SeatCounters::kShards);
+}
+
+// 锁住一个舱位的全部分片逐个扣减 (快售罄、团体票，或随机挑的分片都不够时)
+// 返回值同 take；*missing 为 true 表示这个舱位没有计数行
+static bool takeAcrossShards(PooledConnection &db, int flightId, int cabin, int count, bool *ok, bool *missing)
+{
+    *missing = false;
+    QSqlQuery &select = db.prepared("SELECT shard, remaining FROM flight_seat_inventory "
+                                    "WHERE flight_id = ? AND seat_type = ? ORDER BY shard" + SqlDialect::forUpdate());
+    select.addBindValue(flightId);
+    select.addBindValue(cabin);
+    if (!DatabaseManager::exec(select)) {
+        qWarning() << "Take Seat Counter Error:" << select.lastError().text();
+        if (ok) *ok = false;
+        return false;
+    }
+
+    QList<QPair<int, int>> shards; // (shard, remaining)
+    int total = 0;
+    while (select.next()) {
+        shards.append({select.value(0).toInt(), select.value(1).toInt()});
+        total += qMax(0, shards.last().second);
+    }
+    if (shards.isEmpty()) {
+        *missing = true;
+        return false;
+    }
+    if (total < count) return false;
+
+    QSqlQuery &update = db.prepared("UPDATE flight_seat_inventory SET remaining = remaining - ? "
+                                    "WHERE flight_id = ? AND seat_type = ? AND shard = ?");
+    int need = count;
+    for (const QPair<int, int> &shard : shards) {
+        const int amount = qMin(need, shard.second);
+        if (amount <= 0) continue;
+        update.addBindValue(amount);
+        update.addBindValue(flightId);
+        update.addBindValue(cabin);
+        update.addBindValue(shard.first);
+        if (!DatabaseManager::exec(update)) {
+            qWarning() << "Take Seat Counter Error:" << update.lastError().text();
+            if (ok) *ok = false;
+            return false;
+        }
+        need -= amount;
+        if (need == 0) break;
+    }
+    return true;
+}
+
+bool SeatCounters::take(PooledConnection &db, int flightId, int seatType, int count, bool *ok)
+{
+    if (ok) *ok = true;
+    const int cabin = cabinIndex(seatType);
+
+    // 1. 随机挑两个分片各试一次，只锁一行；remaining >= count 写在 WHERE 里，计数永远不会被扣成负数
+    QSqlQuery &query = db.prepared("UPDATE flight_seat_inventory SET remaining = remaining - ? "
+                                   "WHERE flight_id = ? AND seat_type = ? AND shard = ? AND remaining >= ?");
+    const int first = randomShard();
+    for (int i = 0; i < 2; ++i) {
+        query.addBindValue(count);
+        query.addBindValue(flightId);
+        query.addBindValue(cabin);
+        query.addBindValue((first + i * (kShards / 2)) % kShards);
+        query.addBindValue(count);
+        if (!DatabaseManager::exec(query)) {
+            qWarning() << "Take Seat Counter Error:" << query.lastError().text();
+            if (ok) *ok = false;
+            return false;
+        }
+        if (query.numRowsAffected() > 0) return true;
+    }
+
+    // 2. 单个分片不够扣：锁住全部分片合起来扣
+    bool missing = false;
+    if (takeAcrossShards(db, flightId, cabin, count, ok, &missing)) return true;
+    if (!missing) return false;
+
+    // 3. 没有计数行：按 orders 重建 (本事务刚插入的订单已经算在占座里，不用再扣)
+    qInfo() << "Seat counters missing for flight" << flightId << ", rebuilding";
+    if (!rebuild(db, flightId)) {
+        if (ok) *ok = false;
+        return false;
+    }
+    return true;
+}
+
+bool SeatCounters::give(PooledConnection &db, int flightId, int seatType, int count)
+{
+    // 还到随机的一个分片上，不和其他事务抢同一行
+    QSqlQuery &query = db.prepared("UPDATE flight_seat_inventory SET remaining = remaining + ? "
+                                   "WHERE flight_id = ? AND seat_type = ? AND shard = ?");
+    query.addBindValue(count);
+    query.addBindValue(flightId);
+    query.addBindValue(cabinIndex(seatType));
+    query.addBindValue(randomShard());
+    if (!DatabaseManager::exec(query)) {
+        qWarning() << "Give Seat Counter Error:" << query.lastError().text();
+        return false;
+    }
+    // 没有计数行：按 orders 重建 (本事务里已经不再占座的订单不会被算进去)
+    if (query.numRowsAffected() == 0) return rebuild(db, flightId);
+    return true;
+}
+
+bool SeatCounters::rebuild(const QSqlDatabase &db, int flightId)
+{
+    // 1. 各舱位的座位数
+    QSqlQuery seats(db);
+    seats.prepare("SELECT economy_seats, business_seats, first_class_seats FROM flights WHERE ID = ?");
+    seats.addBindValue(flightId);
+    if (!DatabaseManager::exec(seats) || !seats.next()) {
+        qWarning() << "Rebuild Seat Counter Error: flight" << flightId << seats.lastError().text();
+        return false;
+    }
+    int remaining[3] = {seats.value(0).toInt(), seats.value(1).toInt(), seats.value(2).toInt()};
+
+    // 2. 减去仍占座的订单 (走 uniq_flight_active_seat 的前缀)
+    QSqlQuery held(db);
+    held.prepare("SELECT seat_type, COUNT(*) FROM orders "
+                 "WHERE flight_id = ? AND active_seat IS NOT NULL GROUP BY seat_type");
+    held.addBindValue(flightId);
+    if (!DatabaseManager::exec(held)) {
+        qWarning() << "Rebuild Seat Counter Error:" << held.lastError().text();
+        return false;
+    }
+    while (held.next()) remaining[cabinIndex(held.value(0).toInt())] -= held.value(1).toInt();
+
+    // 3. 每个舱位平均拆到 kShards 行 (余数放在前几个分片)，一条语句写入，已有的行覆盖
+    QStringList rows;
+    for (int i = 0; i < 3 * kShards; ++i) rows << "(?, ?, ?, ?)";
+    QSqlQuery upsert(db);
+    upsert.prepare("INSERT INTO flight_seat_inventory (flight_id, seat_type, shard, remaining) VALUES "
+                   + rows.join(", ") + SqlDialect::upsert("flight_id, seat_type, shard", {"remaining"}));
+    for (int cabin = 0; cabin < 3; ++cabin) {
+        const int total = qMax(0, remaining[cabin]);
+        for (int shard = 0; shard < kShards; ++shard) {
+            upsert.addBindValue(flightId);
+            upsert.addBindValue(cabin);
+            upsert.addBindValue(shard);
+            upsert.addBindValue(total / kShards + (shard < total % kShards ? 1 : 0));
+        }
+    }
+    if (!DatabaseManager::exec(upsert)) {
+        qWarning() << "Rebuild Seat Counter Error:" << upsert.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool SeatCounters::backfill(PooledConnection &db)
+{
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!DatabaseManager::exec(query, "SELECT f.ID FROM flights f WHERE NOT EXISTS "
+                                      "(SELECT 1 FROM flight_seat_inventory i WHERE i.flight_id = f.ID)")) {
+        qWarning() << "Backfill Seat Counter Error:" << query.lastError().text();
+        return false;
+    }
+    QList<int> flightIds;
+    while (query.next()) flightIds.append(query.value(0).toInt());
+    query.finish();
+    if (flightIds.isEmpty()) return true;
+
+    // 启动时还没有并发请求，整批放在一个事务里 (SQLite 逐条提交会很慢)
+    db.transaction();
+    for (int flightId : flightIds) {
+        if (!rebuild(db, flightId)) {
+            db.rollback();
+            return false;
+        }
+    }
+    if (!db.commit()) {
+        qWarning() << "Backfill Seat Counter Error:" << db.database().lastError().text();
+        db.rollback();
+        return false;
+    }
+    qInfo() << "已为" << flightIds.size() << "个航班补齐余座计数";
+    return true;
+}
+
+void SeatCounters::committed(int flightId, int seatType, int delta)
+{
+    FlightStore::instance().adjustRemaining(flightId, cabinIndex(seatType), delta);
+    SearchCache::instance().invalidateFlight(flightId);
+}
@@ -0,0 +1,40 @@
+#ifndef SEATCOUNTERS_H
+#define SEATCOUNTERS_H
+
+#include "ConnectionPool.h"
+
+#include <QSqlDatabase>
+
+// ==============================================================================
+//  余座计数器：flight_seat_inventory 表里每个 (航班, 舱位) 拆成 kShards 行 remaining，合计为余座数
+//  下单、取消、退款、删除订单、超时取消时，在同一个事务里加减，
+//  搜索时直接读计数 (按舱位求和)，不再对 orders 做聚合。
+//  拆行是为了避免热点行锁：同一航班同一舱位的并发下单各自随机扣一行，不会在一行上排队；
+//  只有随机挑的分片都不够扣时 (快售罄、团体票) 才锁住该舱位的全部分片逐个扣。
+//  事务提交后调用 committed()，把变化同步到内存航班库并作废搜索缓存。
+// ==============================================================================
+class SeatCounters {
+public:
+    // 每个 (航班, 舱位) 的分片数 (flight_seat_inventory.shard 取 0 .. kShards-1)
+    static constexpr int kShards = 8;
+
+    // take/give 在每个下单、退票事务里都会执行，用连接上缓存的预编译语句
+    // 在当前事务里扣减 count 个余座；余座不足返回 false
+    // SQL 执行出错时 *ok 为 false (区分 "售罄" 和 "系统错误")
+    // 航班还没有计数行时 (爬虫直接写入的航班等) 按 orders 现场重建，重建结果已经算上本事务里插入的订单
+    static bool take(PooledConnection &db, int flightId, int seatType, int count, bool *ok = nullptr);
+
+    // 在当前事务里归还 count 个余座 (没有计数行时同样现场重建)
+    static bool give(PooledConnection &db, int flightId, int seatType, int count);
+
+    // 按 flights 的座位数和 orders 里仍占座的订单重算某个航班的全部计数行 (新增航班、修改座位数后调用)
+    static bool rebuild(const QSqlDatabase &db, int flightId);
+
+    // 启动时调用：给还没有计数行的航班补上 (旧库、爬虫写入的航班)，已有的不动，可以重复执行
+    static bool backfill(PooledConnection &db);
+
+    // 事务提交后调用：内存航班库的余座加上 delta，并作废含有该航班的搜索缓存
+    static void committed(int flightId, int seatType, int delta);
+};
+
+#endif // SEATCOUNTERS_H
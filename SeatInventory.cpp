@@ -0,0 +1,343 @@
+#include "SeatInventory.h"
+#include "DatabaseManager.h"
+
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QRandomGenerator>
+#include <QtAlgorithms>
+#include <QDebug>
+#include <cmath>
+
+// 在 64 位字里找第 n 个 (从 0 开始) 为 1 的位
+static int nthSetBit(quint64 word, int n)
+{
+    for (int i = 0; i < n; ++i) {
+        word &= word - 1; // 清掉最低位的 1
+    }
+    return qCountTrailingZeroBits(word);
+}
+
+// ------------------------------------------------------------------
+// CabinLayout
+// ------------------------------------------------------------------
+CabinLayout CabinLayout::forCabin(const FlightCapacity &cap, int seatType)
+{
+    // 1. 计算各舱位需要的行数 (向上取整)
+    int firstRows = std::ceil((double)cap.first / 2.0);       // 头等舱每排2座 (AB)
+    int businessRows = std::ceil((double)cap.business / 4.0); // 商务舱每排4座 (ABCD)
+
+    // 2. 根据目标舱位确定 起始行号 和 列布局
+    CabinLayout layout;
+    switch (cabinIndex(seatType)) {
+    case 2: // 头等舱
+        layout.startRow = 1;
+        layout.letters = "AB";
+        layout.capacity = cap.first;
+        break;
+    case 1: // 商务舱
+        layout.startRow = 1 + firstRows; // 紧接头等舱之后
+        layout.letters = "ABCD";
+        layout.capacity = cap.business;
+        break;
+    default: // 经济舱
+        layout.startRow = 1 + firstRows + businessRows; // 紧接商务舱之后
+        layout.letters = "ABCDEF";
+        layout.capacity = cap.economy;
+        break;
+    }
+    layout.columns = layout.letters.size();
+    layout.capacity = qMax(0, layout.capacity);
+    return layout;
+}
+
+QString CabinLayout::seatLabel(int index) const
+{
+    return QString::number(startRow + index / columns) + letters.at(index % columns);
+}
+
+int CabinLayout::seatIndex(const QString &seatNumber) const
+{
+    if (seatNumber.size() < 2 || columns == 0) return -1;
+
+    bool ok = false;
+    int row = QStringView(seatNumber).left(seatNumber.size() - 1).toInt(&ok);
+    int col = letters.indexOf(seatNumber.back().toUpper());
+    if (!ok || col < 0 || row < startRow) return -1;
+
+    int index = (row - startRow) * columns + col;
+    return index < capacity ? index : -1;
+}
+
+int CabinLayout::columnOf(const QString &letter) const
+{
+    if (letter.size() != 1) return -1;
+    return letters.indexOf(letter.at(0).toUpper());
+}
+
+// ------------------------------------------------------------------
+// SeatBitmap
+// ------------------------------------------------------------------
+SeatBitmap::SeatBitmap(const CabinLayout &layout)
+    : m_layout(layout), m_free(layout.capacity)
+{
+    const size_t words = (size_t(layout.capacity) + 63) / 64;
+    m_occupied.assign(words, 0);
+    m_valid.assign(words, ~quint64(0));
+    if (layout.capacity % 64 != 0 && words > 0) {
+        m_valid.back() = (quint64(1) << (layout.capacity % 64)) - 1;
+    }
+
+    m_columnMasks.assign(layout.columns, std::vector<quint64>(words, 0));
+    for (int i = 0; i < layout.capacity; ++i) {
+        m_columnMasks[i % layout.columns][i / 64] |= quint64(1) << (i % 64);
+    }
+}
+
+bool SeatBitmap::isOccupied(int index) const
+{
+    if (index < 0 || index >= m_layout.capacity) return true;
+    return m_occupied[index / 64] & (quint64(1) << (index % 64));
+}
+
+bool SeatBitmap::occupy(int index)
+{
+    if (isOccupied(index)) return false;
+    m_occupied[index / 64] |= quint64(1) << (index % 64);
+    --m_free;
+    return true;
+}
+
+void SeatBitmap::release(int index)
+{
+    if (index < 0 || index >= m_layout.capacity || !isOccupied(index)) return;
+    m_occupied[index / 64] &= ~(quint64(1) << (index % 64));
+    ++m_free;
+}
+
+int SeatBitmap::pickFree(int column) const
+{
+    if (m_free == 0) return -1;
+
+    // 有符合偏好字母的就在该列里随机；否则在全舱空座里随机 (降级策略)
+    if (column >= 0 && column < int(m_columnMasks.size())) {
+        int index = pickFromMask(m_columnMasks[column]);
+        if (index >= 0) return index;
+    }
+    return pickFromMask(m_valid);
+}
+
+QByteArray SeatBitmap::toBytes() const
+{
+    QByteArray bytes((m_layout.capacity + 7) / 8, '\0');
+    for (int i = 0; i < bytes.size(); ++i) {
+        // 每个 64 位字按小端顺序拆成 8 个字节
+        bytes[i] = char((m_occupied[i / 8] >> ((i % 8) * 8)) & 0xFF);
+    }
+    return bytes;
+}
+
+std::vector<int> SeatBitmap::pickBlock(int count) const
+{
+    std::vector<int> seats;
+    if (count <= 0 || count > m_free) return seats;
+
+    const int columns = m_layout.columns;
+    const int capacity = m_layout.capacity;
+
+    // 1. 同一排里找连续 count 个空座 (从前往后第一个能坐下的排)
+    if (count <= columns) {
+        for (int rowStart = 0; rowStart < capacity; rowStart += columns) {
+            const int rowEnd = qMin(rowStart + columns, capacity);
+            int run = 0;
+            for (int i = rowStart; i < rowEnd; ++i) {
+                run = isOccupied(i) ? 0 : run + 1;
+                if (run == count) {
+                    for (int k = i - count + 1; k <= i; ++k) seats.push_back(k);
+                    return seats;
+                }
+            }
+        }
+    }
+
+    // 2. 降级：按行优先顺序取最靠前的空座
+    for (int i = 0; i < capacity && int(seats.size()) < count; ++i) {
+        if (!isOccupied(i)) seats.push_back(i);
+    }
+    return seats;
+}
+
+int SeatBitmap::pickFromMask(const std::vector<quint64> &mask) const
+{
+    // 1. 数一数候选空座
+    int total = 0;
+    for (size_t w = 0; w < mask.size(); ++w) {
+        total += qPopulationCount(mask[w] & ~m_occupied[w]);
+    }
+    if (total == 0) return -1;
+
+    // 2. 均匀随机取第 k 个
+    int k = QRandomGenerator::global()->bounded(total);
+    for (size_t w = 0; w < mask.size(); ++w) {
+        const quint64 freeBits = mask[w] & ~m_occupied[w];
+        const int count = qPopulationCount(freeBits);
+        if (k < count) {
+            return int(w * 64) + nthSetBit(freeBits, k);
+        }
+        k -= count;
+    }
+    return -1;
+}
+
+// ------------------------------------------------------------------
+// SeatInventory
+// ------------------------------------------------------------------
+SeatInventory &SeatInventory::instance()
+{
+    static SeatInventory inventory;
+    return inventory;
+}
+
+QString SeatInventory::claimSeat(const QSqlDatabase &db, int flightId, const FlightCapacity &cap,
+                                 int seatType, const QString &preferLetter, bool *ok)
+{
+    std::shared_ptr<FlightSeats> seats = flightSeats(db, flightId, cap, ok);
+    if (!seats) return QString();
+
+    QMutexLocker locker(&seats->mutex);
+    SeatBitmap &cabin = seats->cabins[cabinIndex(seatType)];
+    int index = cabin.pickFree(cabin.layout().columnOf(preferLetter));
+    if (index < 0) return QString(); // 该舱位已满
+
+    cabin.occupy(index);
+    return cabin.layout().seatLabel(index);
+}
+
+bool SeatInventory::claimExactSeat(const QSqlDatabase &db, int flightId, const FlightCapacity &cap,
+                                   int seatType, const QString &seatNumber, bool *ok)
+{
+    std::shared_ptr<FlightSeats> seats = flightSeats(db, flightId, cap, ok);
+    if (!seats) return false;
+
+    QMutexLocker locker(&seats->mutex);
+    SeatBitmap &cabin = seats->cabins[cabinIndex(seatType)];
+    return cabin.occupy(cabin.layout().seatIndex(seatNumber));
+}
+
+QList<SeatInventory::CabinMap> SeatInventory::seatMap(const QSqlDatabase &db, int flightId,
+                                                      const FlightCapacity &cap, bool *ok)
+{
+    std::shared_ptr<FlightSeats> seats = flightSeats(db, flightId, cap, ok);
+    if (!seats) return QList<CabinMap>();
+    return mapOf(*seats);
+}
+
+QList<SeatInventory::CabinMap> SeatInventory::cachedSeatMap(int flightId, const FlightCapacity &cap)
+{
+    std::shared_ptr<FlightSeats> seats;
+    {
+        QMutexLocker locker(&m_mutex);
+        seats = m_flights.value(flightId);
+    }
+    if (!seats || seats->capacity != cap) return QList<CabinMap>();
+    return mapOf(*seats);
+}
+
+QList<SeatInventory::CabinMap> SeatInventory::mapOf(FlightSeats &seats)
+{
+    QList<CabinMap> maps;
+    QMutexLocker locker(&seats.mutex);
+    for (const SeatBitmap &cabin : seats.cabins) {
+        maps.append({cabin.layout(), cabin.toBytes(), cabin.freeCount()});
+    }
+    return maps;
+}
+
+QStringList SeatInventory::claimSeats(const QSqlDatabase &db, int flightId, const FlightCapacity &cap,
+                                      int seatType, int count, bool *ok)
+{
+    QStringList labels;
+    std::shared_ptr<FlightSeats> seats = flightSeats(db, flightId, cap, ok);
+    if (!seats) return labels;
+
+    QMutexLocker locker(&seats->mutex);
+    SeatBitmap &cabin = seats->cabins[cabinIndex(seatType)];
+    const std::vector<int> picked = cabin.pickBlock(count);
+    for (int index : picked) {
+        cabin.occupy(index);
+        labels << cabin.layout().seatLabel(index);
+    }
+    return labels;
+}
+
+void SeatInventory::releaseSeat(int flightId, int seatType, const QString &seatNumber)
+{
+    std::shared_ptr<FlightSeats> seats;
+    {
+        QMutexLocker locker(&m_mutex);
+        seats = m_flights.value(flightId);
+    }
+    if (!seats) return;
+
+    QMutexLocker locker(&seats->mutex);
+    SeatBitmap &cabin = seats->cabins[cabinIndex(seatType)];
+    cabin.release(cabin.layout().seatIndex(seatNumber));
+}
+
+void SeatInventory::invalidateFlight(int flightId)
+{
+    QMutexLocker locker(&m_mutex);
+    m_flights.remove(flightId);
+}
+
+std::shared_ptr<SeatInventory::FlightSeats> SeatInventory::flightSeats(const QSqlDatabase &db, int flightId,
+                                                                       const FlightCapacity &cap, bool *ok)
+{
+    if (ok) *ok = true;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_flights.constFind(flightId);
+        // 座位配置没变就直接用缓存；管理员改了座位数则重建
+        if (it != m_flights.constEnd() && it.value()->capacity == cap) {
+            return it.value();
+        }
+    }
+
+    // 重建放在全局锁外面做，避免一次慢查询挡住其他航班
+    std::shared_ptr<FlightSeats> loaded = loadFlight(db, flightId, cap, ok);
+    if (!loaded) return nullptr;
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_flights.find(flightId);
+    if (it != m_flights.end() && it.value()->capacity == cap) {
+        return it.value(); // 别的线程先建好了，用它的 (可能已经有人抢了座)
+    }
+    m_flights.insert(flightId, loaded);
+    return loaded;
+}
+
+std::shared_ptr<SeatInventory::FlightSeats> SeatInventory::loadFlight(const QSqlDatabase &db, int flightId,
+                                                                      const FlightCapacity &cap, bool *ok)
+{
+    auto seats = std::make_shared<FlightSeats>();
+    seats->capacity = cap;
+    for (int type = 0; type < 3; ++type) {
+        seats->cabins[type] = SeatBitmap(CabinLayout::forCabin(cap, type));
+    }
+
+    // 已取消、已退款的订单不再占座
+    QSqlQuery query(db);
+    query.prepare("SELECT seat_type, seat_number FROM orders "
+                  "WHERE flight_id = ? AND status NOT IN ('已取消', '已退款')");
+    query.addBindValue(flightId);
+    if (!DatabaseManager::exec(query)) {
+        qWarning() << "Load Seat Inventory Error:" << query.lastError().text();
+        if (ok) *ok = false;
+        return nullptr;
+    }
+
+    while (query.next()) {
+        SeatBitmap &cabin = seats->cabins[cabinIndex(query.value(0).toInt())];
+        cabin.occupy(cabin.layout().seatIndex(query.value(1).toString()));
+    }
+    return seats;
+}
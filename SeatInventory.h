@@ -0,0 +1,149 @@
+#ifndef SEATINVENTORY_H
+#define SEATINVENTORY_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <memory>
+#include <vector>
+
+// 舱位类型，与 orders.seat_type 一致：0 经济舱, 1 商务舱, 2 头等舱
+// (其他取值按经济舱处理，与原 SeatAllocator 的行为一致)
+inline int cabinIndex(int seatType) {
+    return (seatType == 1 || seatType == 2) ? seatType : 0;
+}
+
+// 航班三个舱位的座位总数 (flights 表里的 *_seats 列)
+struct FlightCapacity {
+    int first = 0;
+    int business = 0;
+    int economy = 0;
+
+    bool operator==(const FlightCapacity &o) const {
+        return first == o.first && business == o.business && economy == o.economy;
+    }
+    bool operator!=(const FlightCapacity &o) const { return !(*this == o); }
+};
+
+// ==============================================================================
+//  舱位布局 (原 SeatAllocator 的行列模型)
+//  头等舱每排2座 (AB)、商务舱每排4座 (ABCD)、经济舱每排6座 (ABCDEF)，
+//  行号从头等舱开始依次衔接；座位按行优先编号为 0..capacity-1
+// ==============================================================================
+struct CabinLayout {
+    int startRow = 1;
+    int columns = 0;
+    QString letters;
+    int capacity = 0;
+
+    static CabinLayout forCabin(const FlightCapacity &cap, int seatType);
+
+    // 序号 -> 座位号，例如 0 -> "1A"
+    QString seatLabel(int index) const;
+    // 座位号 -> 序号，不属于本舱位时返回 -1 (兼容 "01A" 这种带前导零的写法)
+    int seatIndex(const QString &seatNumber) const;
+    // 列字母 -> 列号，无效时返回 -1
+    int columnOf(const QString &letter) const;
+};
+
+// ==============================================================================
+//  单个舱位的占用位图：第 i 位为 1 表示第 i 个座位已被占用
+//  每一列额外预计算一份掩码，按字母挑座只需要按 64 位字做与运算
+// ==============================================================================
+class SeatBitmap {
+public:
+    SeatBitmap() = default;
+    explicit SeatBitmap(const CabinLayout &layout);
+
+    const CabinLayout &layout() const { return m_layout; }
+    int freeCount() const { return m_free; }
+
+    bool isOccupied(int index) const;
+    // 标记占用，原本已被占用时返回 false
+    bool occupy(int index);
+    void release(int index);
+
+    // 随机挑一个空座 (不修改位图)；column >= 0 时优先在该列里挑，没有再降级到全舱
+    // 舱位已满时返回 -1
+    int pickFree(int column) const;
+
+    // 占用位图导出为字节串：第 i 个座位对应第 i/8 个字节的第 i%8 位 (低位在前)，1 表示已占用
+    QByteArray toBytes() const;
+
+    // 给团体挑 count 个空座 (不修改位图)：优先同一排里相邻的座位，
+    // 没有这样的排 (或人数超过一排) 就按行优先顺序取最靠前的空座，让大家尽量坐在一起
+    // 空座不够时返回空
+    std::vector<int> pickBlock(int count) const;
+
+private:
+    int pickFromMask(const std::vector<quint64> &mask) const;
+
+    CabinLayout m_layout;
+    std::vector<quint64> m_occupied;
+    std::vector<quint64> m_valid;                     // 超出 capacity 的尾部位为 0
+    std::vector<std::vector<quint64>> m_columnMasks;  // m_columnMasks[列][字]
+    int m_free = 0;
+};
+
+// ==============================================================================
+//  航班座位库存：按 航班 -> 舱位 缓存占用位图
+//  第一次访问某个航班时从 orders 表重建，之后由下单/退票/删除订单同步维护
+// ==============================================================================
+class SeatInventory {
+public:
+    static SeatInventory &instance();
+
+    // 在 seatType 舱位里抢占一个座位 (内存中立即标记为占用)，返回座位号
+    // 舱位已满返回空字符串；从数据库重建失败时 *ok 为 false
+    // 调用方的事务若最终回滚，需要调用 releaseSeat() 把座位还回来
+    QString claimSeat(const QSqlDatabase &db, int flightId, const FlightCapacity &cap,
+                      int seatType, const QString &preferLetter, bool *ok = nullptr);
+
+    // 抢占指定的座位号，座位空着才会成功 (座位号是否属于该舱位由调用方先用 CabinLayout 校验)
+    bool claimExactSeat(const QSqlDatabase &db, int flightId, const FlightCapacity &cap,
+                        int seatType, const QString &seatNumber, bool *ok = nullptr);
+
+    // 团体下单：一次抢占 count 个尽量相邻的座位，空座不够时返回空列表
+    QStringList claimSeats(const QSqlDatabase &db, int flightId, const FlightCapacity &cap,
+                           int seatType, int count, bool *ok = nullptr);
+
+    // 订单取消/退款/删除后释放座位 (航班未加载时忽略，下次重建自然会读到最新状态)
+    void releaseSeat(int flightId, int seatType, const QString &seatNumber);
+
+    // 座位图：三个舱位的布局和占用位图 (下标与 seat_type 一致)，从数据库重建失败时 *ok 为 false
+    struct CabinMap {
+        CabinLayout layout;
+        QByteArray occupied;    // SeatBitmap::toBytes()
+        int freeCount = 0;
+    };
+    QList<CabinMap> seatMap(const QSqlDatabase &db, int flightId, const FlightCapacity &cap, bool *ok = nullptr);
+    // 只看内存：航班位图还没加载 (或座位配置已变) 时返回空列表，不访问数据库
+    QList<CabinMap> cachedSeatMap(int flightId, const FlightCapacity &cap);
+
+    // 航班被删除或座位配置变化时丢弃缓存，下次访问时重建
+    void invalidateFlight(int flightId);
+
+private:
+    struct FlightSeats {
+        QMutex mutex;
+        FlightCapacity capacity;
+        SeatBitmap cabins[3];
+    };
+
+    SeatInventory() = default;
+
+    static QList<CabinMap> mapOf(FlightSeats &seats);
+    std::shared_ptr<FlightSeats> flightSeats(const QSqlDatabase &db, int flightId,
+                                             const FlightCapacity &cap, bool *ok);
+    std::shared_ptr<FlightSeats> loadFlight(const QSqlDatabase &db, int flightId,
+                                            const FlightCapacity &cap, bool *ok);
+
+    QMutex m_mutex;
+    QHash<int, std::shared_ptr<FlightSeats>> m_flights;
+};
+
+#endif // SEATINVENTORY_H
@@ -0,0 +1,201 @@
+#include "SqlDialect.h"
+#include "AppConfig.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QSqlQuery>
+#include <QDebug>
+
+// 相对路径按程序所在目录 (与 config.ini 一致)
+static QString resolvePath(const QString &path)
+{
+    if (path == ":memory:" || QDir::isAbsolutePath(path)) return path;
+    return QDir(QCoreApplication::applicationDirPath()).filePath(path);
+}
+
+SqlDialect::Backend SqlDialect::backend()
+{
+    static const Backend b = [] {
+        const QString driver = AppConfig::value("Database/Driver", "mysql").toString().trimmed().toLower();
+        if (driver == "sqlite") return Backend::Sqlite;
+        if (driver != "mysql") qWarning() << "未知的 Database/Driver:" << driver << "，按 mysql 处理";
+        return Backend::MySql;
+    }();
+    return b;
+}
+
+QString SqlDialect::driverName()
+{
+    return isSqlite() ? QStringLiteral("QSQLITE") : QStringLiteral("QMYSQL");
+}
+
+QString SqlDialect::sqlitePath()
+{
+    static const QString path = resolvePath(AppConfig::value("Database/SqlitePath", "flight_system.db").toString());
+    return path;
+}
+
+QStringList SqlDialect::sqliteInitStatements()
+{
+    QStringList statements{"PRAGMA foreign_keys = ON"};
+    if (!isSqliteInMemory()) {
+        // WAL：读不阻塞写；synchronous=NORMAL 在 WAL 下只在检查点时 fsync
+        statements << "PRAGMA journal_mode = WAL" << "PRAGMA synchronous = NORMAL";
+    }
+    return statements;
+}
+
+QString SqlDialect::forUpdate()
+{
+    return isSqlite() ? QString() : QStringLiteral(" FOR UPDATE");
+}
+
+QString SqlDialect::now()
+{
+    return isSqlite() ? QStringLiteral("datetime('now', 'localtime')") : QStringLiteral("CURRENT_TIMESTAMP");
+}
+
+QString SqlDialect::upsert(const QString &keyColumns, const QStringList &updateColumns)
+{
+    QStringList sets;
+    for (const QString &c : updateColumns) {
+        sets << (isSqlite() ? c + " = excluded." + c : c + " = VALUES(" + c + ")");
+    }
+    if (isSqlite()) return " ON CONFLICT (" + keyColumns + ") DO UPDATE SET " + sets.join(", ");
+    return " ON DUPLICATE KEY UPDATE " + sets.join(", ");
+}
+
+bool SqlDialect::isDuplicateKey(const QSqlError &error)
+{
+    if (isSqlite()) {
+        // SQLITE_CONSTRAINT (19) 还包括 NOT NULL、外键等，按错误信息区分
+        return error.text().contains("UNIQUE constraint failed");
+    }
+    return error.nativeErrorCode() == "1062" || error.text().contains("Duplicate");
+}
+
+bool SqlDialect::isDeadlock(const QSqlError &error)
+{
+    return !isSqlite() && error.nativeErrorCode() == "1213";
+}
+
+bool SqlDialect::isLockTimeout(const QSqlError &error)
+{
+    if (isSqlite()) return error.nativeErrorCode() == "5"; // SQLITE_BUSY
+    return error.nativeErrorCode() == "1205";
+}
+
+QString SqlDialect::explainPrefix()
+{
+    return isSqlite() ? QStringLiteral("EXPLAIN QUERY PLAN ") : QStringLiteral("EXPLAIN ");
+}
+
+bool SqlDialect::isFullScan(const QSqlRecord &planRow)
+{
+    if (isSqlite()) {
+        // "SCAN orders" 全表扫描，"SCAN orders USING COVERING INDEX ..." 全索引扫描；用上索引时是 "SEARCH ..."
+        const QString detail = planRow.value("detail").toString();
+        return detail.startsWith("SCAN ") && !detail.startsWith("SCAN CONSTANT ROW");
+    }
+    // ALL = 全表扫描，index = 全索引扫描，都说明过滤条件没有用上索引
+    const QString type = planRow.value("type").toString();
+    return type == "ALL" || type == "index";
+}
+
+QString SqlDialect::describePlanRow(const QSqlRecord &planRow)
+{
+    if (isSqlite()) return planRow.value("detail").toString();
+    const QString key = planRow.value("key").toString();
+    return QString("table: %1 type: %2 key: %3 rows: %4")
+        .arg(planRow.value("table").toString(), planRow.value("type").toString(),
+             key.isEmpty() ? QStringLiteral("NULL") : key)
+        .arg(planRow.value("rows").toLongLong());
+}
+
+qint64 SqlDialect::planRowEstimate(const QSqlRecord &planRow)
+{
+    if (isSqlite()) return -1;
+    bool ok = false;
+    const qint64 rows = planRow.value("rows").toLongLong(&ok);
+    return ok ? rows : -1;
+}
+
+bool SqlDialect::hasIndex(const QSqlDatabase &db, const QString &table, const QString &index)
+{
+    QSqlQuery query(db);
+    if (isSqlite()) {
+        query.prepare("SELECT COUNT(*) FROM sqlite_master WHERE type = 'index' AND tbl_name = ? AND name = ?");
+    } else {
+        query.prepare("SELECT COUNT(*) FROM information_schema.statistics "
+                      "WHERE table_schema = DATABASE() AND table_name = ? AND index_name = ?");
+    }
+    query.addBindValue(table);
+    query.addBindValue(index);
+    if (!query.exec() || !query.next()) {
+        qWarning() << "Check Index Error:" << query.lastError().text();
+        return false;
+    }
+    return query.value(0).toInt() > 0;
+}
+
+bool SqlDialect::hasColumn(const QSqlDatabase &db, const QString &table, const QString &column)
+{
+    QSqlQuery query(db);
+    if (isSqlite()) {
+        query.prepare("SELECT COUNT(*) FROM pragma_table_info(?) WHERE name = ?");
+    } else {
+        query.prepare("SELECT COUNT(*) FROM information_schema.columns "
+                      "WHERE table_schema = DATABASE() AND table_name = ? AND column_name = ?");
+    }
+    query.addBindValue(table);
+    query.addBindValue(column);
+    if (!query.exec() || !query.next()) {
+        qWarning() << "Check Column Error:" << query.lastError().text();
+        return false;
+    }
+    return query.value(0).toInt() > 0;
+}
+
+bool SqlDialect::ensureSchema(const QSqlDatabase &db)
+{
+    if (!isSqlite()) return true;
+    if (db.tables().contains("flights")) return true;
+
+    const QString schemaPath = resolvePath(AppConfig::value("Database/SqliteSchema", "flight_system.sqlite.sql").toString());
+    QFile file(schemaPath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qCritical() << "SQLite 建表脚本读取失败:" << schemaPath;
+        return false;
+    }
+
+    // 去掉整行注释，按行尾的分号切分语句 (脚本里的字符串常量不含分号)
+    QStringList statements;
+    QString current;
+    const QStringList lines = QString::fromUtf8(file.readAll()).split('\n');
+    for (const QString &raw : lines) {
+        const QString line = raw.trimmed();
+        if (line.isEmpty() || line.startsWith("--")) continue;
+        current += raw + '\n';
+        if (line.endsWith(';')) {
+            statements << current.trimmed();
+            current.clear();
+        }
+    }
+
+    QSqlQuery query(db);
+    query.exec("BEGIN IMMEDIATE");
+    for (const QString &sql : statements) {
+        if (!query.exec(sql)) {
+            qCritical() << "SQLite 建表失败:" << query.lastError().text() << "\n" << sql;
+            query.exec("ROLLBACK");
+            return false;
+        }
+    }
+    if (!query.exec("COMMIT")) {
+        qCritical() << "SQLite 建表提交失败:" << query.lastError().text();
+        return false;
+    }
+    qInfo() << "SQLite 库为空，已按" << schemaPath << "建表 (" << statements.size() << "条语句)";
+    return true;
+}
@@ -0,0 +1,64 @@
+#ifndef SQLDIALECT_H
+#define SQLDIALECT_H
+
+#include <QString>
+#include <QStringList>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlRecord>
+
+// ==============================================================================
+//  SQL 方言：存储后端 (config.ini 的 Database/Driver = mysql | sqlite) 之间不同的那部分 SQL
+//  控制器里的语句大部分两边通用，只有下面几处需要按后端生成：
+//  - 行锁：MySQL 用 SELECT ... FOR UPDATE；SQLite 没有行锁，事务用 BEGIN IMMEDIATE 开启，一开始就拿到写锁
+//  - 当前时间：SQLite 的 CURRENT_TIMESTAMP 是 UTC，改用 datetime('now', 'localtime')
+//  - 插入冲突时更新：ON DUPLICATE KEY UPDATE / ON CONFLICT (...) DO UPDATE
+//  - 唯一键冲突、锁冲突的错误码，EXPLAIN 的写法和结果格式
+//  SQLite 模式下库是空的 (新文件或内存库) 时，启动时按 flight_system.sqlite.sql 建表并写入示例数据
+// ==============================================================================
+class SqlDialect {
+public:
+    enum class Backend { MySql, Sqlite };
+
+    // 第一次调用时从 config.ini 读取，之后不变
+    static Backend backend();
+    static bool isSqlite() { return backend() == Backend::Sqlite; }
+
+    // Qt 驱动名
+    static QString driverName();
+
+    // SQLite 库文件 (相对路径按程序所在目录)；":memory:" 表示内存库
+    static QString sqlitePath();
+    static bool isSqliteInMemory() { return isSqlite() && sqlitePath() == ":memory:"; }
+    // 每条 SQLite 连接建立后执行的 PRAGMA (WAL、外键约束)
+    static QStringList sqliteInitStatements();
+
+    // 加在 SELECT 末尾的行锁子句 (带前导空格)；SQLite 返回空串
+    static QString forUpdate();
+    // 当前本地时间的 SQL 表达式 (写入 DATETIME 列)
+    static QString now();
+    // 插入时键冲突则更新：upsert("flight_id, seat_type", {"remaining"})
+    // SQLite 要求 INSERT ... SELECT 带 WHERE 子句才能接 ON CONFLICT
+    static QString upsert(const QString &keyColumns, const QStringList &updateColumns);
+
+    // 错误分类
+    static bool isDuplicateKey(const QSqlError &error);
+    static bool isDeadlock(const QSqlError &error);       // MySQL 1213 (SQLite 不会出现)
+    static bool isLockTimeout(const QSqlError &error);    // MySQL 1205 / SQLite SQLITE_BUSY (busy_timeout 到期)
+
+    // 查询计划：EXPLAIN 前缀、某一行是否为全表 (全索引) 扫描、日志里的一行描述
+    static QString explainPrefix();
+    static bool isFullScan(const QSqlRecord &planRow);
+    static QString describePlanRow(const QSqlRecord &planRow);
+    // 这一步估算要读的行数 (MySQL rows 列)；SQLite 没有这一列，返回 -1
+    static qint64 planRowEstimate(const QSqlRecord &planRow);
+
+    // 库里是否有某个索引 / 列 (旧库升级检查用；查询出错按没有处理)
+    static bool hasIndex(const QSqlDatabase &db, const QString &table, const QString &index);
+    static bool hasColumn(const QSqlDatabase &db, const QString &table, const QString &column);
+
+    // SQLite：还没有 flights 表时执行建表脚本 (Database/SqliteSchema)，其他后端直接返回 true
+    static bool ensureSchema(const QSqlDatabase &db);
+};
+
+#endif // SQLDIALECT_H
@@ -0,0 +1,247 @@
+#include "SqlProfiler.h"
+#include "AppConfig.h"
+#include "BaseController.h"
+#include "DatabaseManager.h"
+
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlError>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+
+// 超出条数上限后新出现的语句都记到这一条下面 (通常说明有拼接字面量的动态 SQL)
+static const char *const kOverflowSql = "(other statements)";
+
+SqlProfiler &SqlProfiler::instance()
+{
+    static SqlProfiler profiler;
+    return profiler;
+}
+
+SqlProfiler::SqlProfiler()
+{
+    m_enabled = AppConfig::value("SqlProfiler/Enabled", true).toBool();
+    m_slowUs = AppConfig::value("SqlProfiler/SlowMs", 200).toLongLong() * 1000;
+    m_explain = AppConfig::value("SqlProfiler/Explain", true).toBool();
+    m_maxStatementsPerShard = qMax(1, AppConfig::value("SqlProfiler/MaxStatements", 2000).toInt() / kShards);
+}
+
+QString SqlProfiler::normalize(const QString &sql)
+{
+    QString out;
+    out.reserve(sql.size());
+    bool lastSpace = true;
+
+    const qsizetype n = sql.size();
+    for (qsizetype i = 0; i < n; ++i) {
+        const QChar c = sql.at(i);
+
+        // 1. 字符串字面量 -> ? (支持 \' 和 '' 两种转义)
+        if (c == '\'' || c == '"') {
+            qsizetype j = i + 1;
+            while (j < n) {
+                if (sql.at(j) == '\\') { j += 2; continue; }
+                if (sql.at(j) == c) {
+                    if (j + 1 < n && sql.at(j + 1) == c) { j += 2; continue; }
+                    break;
+                }
+                ++j;
+            }
+            out += '?';
+            lastSpace = false;
+            i = j;
+            continue;
+        }
+
+        // 2. 数字字面量 -> ? (标识符里的数字，例如 i1.remaining，不动)
+        if (c.isDigit()) {
+            const QChar prev = out.isEmpty() ? QChar(' ') : out.back();
+            if (!prev.isLetterOrNumber() && prev != '_' && prev != '.') {
+                while (i + 1 < n && (sql.at(i + 1).isDigit() || sql.at(i + 1) == '.')) ++i;
+                out += '?';
+                lastSpace = false;
+                continue;
+            }
+        }
+
+        // 3. 连续空白合并成一个空格
+        if (c.isSpace()) {
+            if (!lastSpace) out += ' ';
+            lastSpace = true;
+            continue;
+        }
+
+        out += c;
+        lastSpace = false;
+    }
+
+    // 4. IN 列表长短不一，折叠成一条
+    static const QRegularExpression list(QStringLiteral("\\?(\\s*,\\s*\\?)+"));
+    out.replace(list, QStringLiteral("?, ..."));
+    return out.trimmed();
+}
+
+QString SqlProfiler::describeParams(const QVariantList &values)
+{
+    // 只输出个数和类型，不输出值 (可能是密码、身份证号、手机号)
+    QStringList types;
+    for (const QVariant &v : values) types << (v.isNull() ? QStringLiteral("null") : QString(v.typeName()));
+    return QString("%1 [%2]").arg(values.size()).arg(types.join(", "));
+}
+
+void SqlProfiler::record(const QString &sql, qint64 elapsedNs, bool ok, const QSqlQuery &query)
+{
+    if (!m_enabled) return;
+
+    // 同一条 SQL 文本在一个线程里只归一化一次
+    static thread_local QHash<QString, QString> normalizedCache;
+    QString normalized = normalizedCache.value(sql);
+    if (normalized.isEmpty()) {
+        if (normalizedCache.size() >= 1024) normalizedCache.clear();
+        normalized = normalize(sql);
+        normalizedCache.insert(sql, normalized);
+    }
+
+    const qint64 us = elapsedNs / 1000;
+    const bool slow = m_slowUs > 0 && us >= m_slowUs;
+    bool needExplain = false;
+
+    Shard &shard = m_shards[qHash(normalized) % kShards];
+    {
+        QMutexLocker locker(&shard.mutex);
+        auto it = shard.stats.find(normalized);
+        if (it == shard.stats.end()) {
+            if (shard.stats.size() >= m_maxStatementsPerShard) normalized = kOverflowSql;
+            it = shard.stats.find(normalized);
+            if (it == shard.stats.end()) {
+                it = shard.stats.insert(normalized, Stats());
+                it->sql = normalized;
+            }
+        }
+        Stats &s = it.value();
+        ++s.count;
+        if (!ok) ++s.errors;
+        s.totalUs += us;
+        s.maxUs = qMax(s.maxUs, us);
+        if (slow) {
+            ++s.slowCount;
+            if (m_explain && ok && !s.explainRequested && normalized != kOverflowSql) {
+                s.explainRequested = true;
+                needExplain = true;
+            }
+        }
+    }
+
+    if (!slow) return;
+
+    const QVariantList params = query.boundValues();
+    qWarning().noquote() << QString("Slow SQL (%1 ms): %2 | params: %3")
+                                .arg(us / 1000.0, 0, 'f', 1).arg(normalized, describeParams(params));
+    if (needExplain) explainLater(normalized, sql, params);
+}
+
+void SqlProfiler::explainLater(const QString &normalized, const QString &sql, const QVariantList &bindValues)
+{
+    // 放到工作线程里另借一条连接执行，不占用慢请求自己的连接和事务
+    QtConcurrent::run(BaseController::workerPool(), [this, normalized, sql, bindValues]() {
+        QJsonArray rows;
+        QString error;
+        bool fullScan = false;
+
+        PooledConnection db = DatabaseManager::getConnection();
+        if (!db.isOpen()) {
+            error = "数据库连接失败";
+        } else {
+            // 直接调用 exec()，EXPLAIN 本身不计入统计
+            QSqlQuery explain(db);
+            explain.prepare(SqlDialect::explainPrefix() + sql);
+            for (const QVariant &v : bindValues) explain.addBindValue(v);
+            if (!explain.exec()) {
+                error = explain.lastError().text();
+            } else {
+                while (explain.next()) {
+                    const QSqlRecord rec = explain.record();
+                    QJsonObject row;
+                    for (int i = 0; i < rec.count(); ++i) {
+                        row[rec.fieldName(i)] = QJsonValue::fromVariant(rec.value(i));
+                    }
+                    if (SqlDialect::isFullScan(rec)) fullScan = true;
+                    rows.append(row);
+                }
+            }
+        }
+
+        if (fullScan) {
+            qWarning().noquote() << "[PLAN] 慢查询退化为全表扫描:" << normalized;
+        } else if (!error.isEmpty()) {
+            qWarning().noquote() << "[PLAN] EXPLAIN 执行失败:" << error << "|" << normalized;
+        }
+
+        Shard &shard = m_shards[qHash(normalized) % kShards];
+        QMutexLocker locker(&shard.mutex);
+        auto it = shard.stats.find(normalized);
+        if (it == shard.stats.end()) return; // 期间被 reset 了
+        it->explain = rows;
+        it->explainError = error;
+    });
+}
+
+QJsonArray SqlProfiler::snapshot(const QString &sortBy, int limit) const
+{
+    QList<Stats> all;
+    Stats overflow;
+    overflow.sql = kOverflowSql;
+    for (const Shard &shard : m_shards) {
+        QMutexLocker locker(&shard.mutex);
+        for (const Stats &s : shard.stats) {
+            if (s.sql != kOverflowSql) {
+                all.append(s);
+                continue;
+            }
+            // 每个分片各有一条溢出记录，合并成一条输出
+            overflow.count += s.count;
+            overflow.errors += s.errors;
+            overflow.slowCount += s.slowCount;
+            overflow.totalUs += s.totalUs;
+            overflow.maxUs = qMax(overflow.maxUs, s.maxUs);
+        }
+    }
+    if (overflow.count > 0) all.append(overflow);
+
+    auto key = [&sortBy](const Stats &s) -> double {
+        if (sortBy == "avg") return s.count ? double(s.totalUs) / s.count : 0;
+        if (sortBy == "max") return double(s.maxUs);
+        if (sortBy == "count") return double(s.count);
+        if (sortBy == "errors") return double(s.errors);
+        return double(s.totalUs);
+    };
+    std::sort(all.begin(), all.end(), [&key](const Stats &a, const Stats &b) { return key(a) > key(b); });
+
+    QJsonArray out;
+    for (const Stats &s : all) {
+        if (limit > 0 && out.size() >= limit) break;
+        QJsonObject obj;
+        obj["sql"] = s.sql;
+        obj["count"] = qint64(s.count);
+        obj["errors"] = qint64(s.errors);
+        obj["slow_count"] = qint64(s.slowCount);
+        obj["total_ms"] = s.totalUs / 1000.0;
+        obj["avg_ms"] = s.count ? s.totalUs / 1000.0 / s.count : 0.0;
+        obj["max_ms"] = s.maxUs / 1000.0;
+        if (!s.explain.isEmpty()) obj["explain"] = s.explain;
+        if (!s.explainError.isEmpty()) obj["explain_error"] = s.explainError;
+        out.append(obj);
+    }
+    return out;
+}
+
+void SqlProfiler::reset()
+{
+    for (Shard &shard : m_shards) {
+        QMutexLocker locker(&shard.mutex);
+        shard.stats.clear();
+    }
+}
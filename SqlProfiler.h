@@ -0,0 +1,67 @@
+#ifndef SQLPROFILER_H
+#define SQLPROFILER_H
+
+#include <QString>
+#include <QHash>
+#include <QMutex>
+#include <QJsonArray>
+#include <QVariantList>
+
+class QSqlQuery;
+
+// ==============================================================================
+//  SQL 性能分析
+//  DatabaseManager::exec() 执行的每条语句都按 "归一化 SQL" 汇总：执行次数、出错次数、总耗时、最大耗时。
+//  归一化：字符串/数字字面量换成 ?，IN (?, ?, ?) 这种列表折叠成 (?, ...)，连续空白合并。
+//  超过 SqlProfiler/SlowMs 的语句记一条慢查询日志 (参数值不打印，只打印个数和类型)，
+//  每条归一化 SQL 第一次变慢时在后台用同样的参数跑一次 EXPLAIN，把执行计划保存下来，
+//  计划里出现全表扫描 (type = ALL / index) 时额外告警。
+//  汇总结果由 /api/admin/sql_stats 输出。
+// ==============================================================================
+class SqlProfiler {
+public:
+    static SqlProfiler &instance();
+
+    bool isEnabled() const { return m_enabled; }
+
+    // 语句执行完调用；query 用于在需要 EXPLAIN 时取绑定的参数
+    void record(const QString &sql, qint64 elapsedNs, bool ok, const QSqlQuery &query);
+
+    // 排序字段: total / avg / max / count / errors
+    QJsonArray snapshot(const QString &sortBy, int limit) const;
+    void reset();
+
+    static QString normalize(const QString &sql);
+
+private:
+    struct Stats {
+        QString sql;              // 归一化后的 SQL
+        quint64 count = 0;
+        quint64 errors = 0;
+        quint64 slowCount = 0;
+        qint64 totalUs = 0;
+        qint64 maxUs = 0;
+        bool explainRequested = false;
+        QJsonArray explain;       // EXPLAIN 的结果行
+        QString explainError;
+    };
+
+    // 按归一化 SQL 的哈希分片，不同语句基本不会争同一把锁
+    static constexpr int kShards = 16;
+    struct Shard {
+        mutable QMutex mutex;
+        QHash<QString, Stats> stats;
+    };
+
+    SqlProfiler();
+    void explainLater(const QString &normalized, const QString &sql, const QVariantList &bindValues);
+    static QString describeParams(const QVariantList &values);
+
+    bool m_enabled = true;
+    qint64 m_slowUs = 0;
+    bool m_explain = true;
+    int m_maxStatementsPerShard = 0;
+    Shard m_shards[kShards];
+};
+
+#endif // SQLPROFILER_H
@@ -0,0 +1,49 @@
+#include "StatementCache.h"
+
+QSqlQuery &StatementCache::acquire(const QSqlDatabase &db, const QString &sql)
+{
+    auto it = m_entries.constFind(sql);
+    if (it != m_entries.constEnd()) {
+        ++m_hits;
+        EntryList::iterator entry = it.value();
+        m_lru.splice(m_lru.begin(), m_lru, entry); // 移到头部
+        entry->query.finish();                     // 释放上一次的结果集，保留预编译语句
+        return entry->query;
+    }
+
+    ++m_misses;
+    QSqlQuery query(db);
+    const bool prepared = query.prepare(sql);
+    if (m_capacity <= 0 || !prepared) {
+        // 不缓存 (关闭缓存或 prepare 失败)，仍然交给调用方按原来的方式处理
+        m_transient.push_back({sql, std::move(query)});
+        return m_transient.back().query;
+    }
+
+    m_lru.push_front({sql, std::move(query)});
+    m_entries.insert(sql, m_lru.begin());
+
+    // 超出条数上限，从尾部淘汰最久未用的
+    // 可能仍被本次借用者引用：整个节点 splice 到 m_transient，QSqlQuery 对象本身不移动也不销毁
+    while (m_entries.size() > m_capacity) {
+        m_entries.remove(m_lru.back().sql);
+        m_transient.splice(m_transient.end(), m_lru, std::prev(m_lru.end()));
+        ++m_evictions;
+    }
+    return m_lru.front().query;
+}
+
+void StatementCache::clear()
+{
+    m_entries.clear();
+    m_lru.clear();
+    m_transient.clear();
+}
+
+void StatementCache::takeCounters(quint64 *hits, quint64 *misses, quint64 *evictions)
+{
+    *hits = m_hits;
+    *misses = m_misses;
+    *evictions = m_evictions;
+    m_hits = m_misses = m_evictions = 0;
+}
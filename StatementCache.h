@@ -0,0 +1,54 @@
+#ifndef STATEMENTCACHE_H
+#define STATEMENTCACHE_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QHash>
+#include <list>
+
+// ==============================================================================
+//  单条连接上的预编译语句缓存
+//  key 为 SQL 文本，value 是已经 prepare() 过的 QSqlQuery (QMYSQL 对应服务端的 prepared statement)。
+//  同一条连接上再次执行相同的 SQL 时直接绑定参数执行，省掉一次 prepare 往返。
+//  按条数做 LRU 淘汰；被淘汰的语句要等连接归还时才销毁，借用期间拿到的引用始终有效。
+//  只由持有连接的线程访问，不加锁。
+// ==============================================================================
+class StatementCache {
+public:
+    explicit StatementCache(int capacity) : m_capacity(capacity) {}
+    ~StatementCache() { clear(); }
+
+    StatementCache(const StatementCache &) = delete;
+    StatementCache &operator=(const StatementCache &) = delete;
+
+    // 返回一条已 prepare 的语句 (上一次的结果集已经 finish)
+    // prepare 失败时返回的语句 exec() 必然失败，lastError() 里是 prepare 的错误
+    QSqlQuery &acquire(const QSqlDatabase &db, const QString &sql);
+
+    // 连接归还时调用：销毁借用期间被淘汰/未缓存的语句
+    void releaseTransient() { m_transient.clear(); }
+
+    // 连接关闭或重连之前调用：服务端的 prepared statement 随连接一起失效
+    void clear();
+
+    // 取出并清零自上次调用以来的计数 (归还连接时汇总到连接池统计)
+    void takeCounters(quint64 *hits, quint64 *misses, quint64 *evictions);
+
+private:
+    struct Entry {
+        QString sql;
+        QSqlQuery query;
+    };
+    using EntryList = std::list<Entry>;
+
+    const int m_capacity;
+    EntryList m_lru;                               // 头部最近使用
+    QHash<QString, EntryList::iterator> m_entries;
+    EntryList m_transient;                         // 借用期间被淘汰/未缓存的语句，连接归还时销毁
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+    quint64 m_evictions = 0;
+};
+
+#endif // STATEMENTCACHE_H
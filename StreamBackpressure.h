@@ -0,0 +1,112 @@
+#ifndef STREAMBACKPRESSURE_H
+#define STREAMBACKPRESSURE_H
+
+#include <QObject>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QPointer>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QElapsedTimer>
+#include <QDeadlineTimer>
+#include <memory>
+
+// ==============================================================================
+//  流式响应的背压 (BaseController::routeStreaming)
+//  工作线程产出 chunk 的速度可能远超客户端接收的速度，不加限制时没发出去的数据全堆在事件队列和 socket 的写缓冲里。
+//  - 已投递未写出的字节 + socket 的 bytesToWrite() 超过上限时，工作线程在 waitForRoom() 里等，
+//    socket 每写出一批 (bytesWritten) 由服务器线程唤醒
+//  - 一个响应累计等待的时间有上限 (maxBlockedMs)：客户端不收或者收得太慢都不能无限期占着工作线程，
+//    超过后放弃这个响应并断开连接；连接断开时之后的 chunk 直接丢掉
+//  - 等待期间 handler 不应再占着数据库连接：流式 handler 先把结果读进内存、归还连接，再开始写
+//  QHttpServerResponder 不公开底层 socket，按请求的对端地址 + 端口在 server 的子对象里找，
+//  找不到时只限制已投递未写出的部分。
+// ==============================================================================
+class StreamBackpressure {
+public:
+    StreamBackpressure(qint64 maxBufferedBytes, int maxBlockedMs)
+        : m_maxBuffered(maxBufferedBytes), m_maxBlockedMs(maxBlockedMs) {}
+
+    // 工作线程：投递一个 chunk 之前调用；返回 false 表示连接已不可写，这个 chunk 应丢弃
+    bool waitForRoom(qint64 bytes) {
+        QMutexLocker locker(&m_mutex);
+        while (!m_closed && m_queued + m_socketBuffered >= m_maxBuffered) {
+            const qint64 remainingMs = m_maxBlockedMs - m_blockedMs;
+            if (remainingMs <= 0) {
+                m_stalled = m_closed = true; // 等待预算用完，不再占着工作线程
+                break;
+            }
+            QElapsedTimer waited;
+            waited.start();
+            m_progress.wait(&m_mutex, QDeadlineTimer(remainingMs));
+            m_blockedMs += waited.elapsed();
+        }
+        if (m_closed) return false;
+        m_queued += bytes;
+        return true;
+    }
+
+    // 服务器线程：写第一个 chunk 之前找到这个连接的 socket，之后跟踪它的写缓冲
+    // owner 是 socket 的祖先对象 (QHttpServer)
+    void attach(QObject *owner, const QHostAddress &peer, quint16 peerPort,
+                const std::shared_ptr<StreamBackpressure> &self) {
+        const QList<QTcpSocket *> sockets = owner->findChildren<QTcpSocket *>();
+        for (QTcpSocket *socket : sockets) {
+            if (socket->peerPort() != peerPort || !socket->peerAddress().isEqual(peer)) continue;
+            m_socket = socket;
+            const std::weak_ptr<StreamBackpressure> weak = self;
+            QObject::connect(socket, &QTcpSocket::bytesWritten, socket, [weak] {
+                if (auto s = weak.lock()) s->written(0);
+            });
+            QObject::connect(socket, &QTcpSocket::disconnected, socket, [weak] {
+                if (auto s = weak.lock()) s->close();
+            });
+            return;
+        }
+    }
+
+    // 服务器线程：一个 chunk 交给 responder 之后 (bytes 为 0 表示 socket 写出了一批)
+    void written(qint64 bytes) {
+        const qint64 buffered = m_socket ? m_socket->bytesToWrite() : 0;
+        QMutexLocker locker(&m_mutex);
+        m_queued -= bytes;
+        m_socketBuffered = buffered;
+        m_progress.wakeAll();
+    }
+
+    void close() {
+        QMutexLocker locker(&m_mutex);
+        m_closed = true;
+        m_progress.wakeAll();
+    }
+
+    // 服务器线程：因为等待超时而放弃时，断开连接，避免客户端收到一个被截断却 "完整" 的响应
+    bool abortIfStalled() {
+        {
+            QMutexLocker locker(&m_mutex);
+            if (!m_stalled) return false;
+        }
+        if (m_socket) m_socket->abort();
+        return true;
+    }
+
+    // 这个响应累计在 waitForRoom() 里等了多久
+    qint64 blockedMs() const {
+        QMutexLocker locker(&m_mutex);
+        return m_blockedMs;
+    }
+
+private:
+    const qint64 m_maxBuffered;
+    const qint64 m_maxBlockedMs;
+    mutable QMutex m_mutex;
+    QWaitCondition m_progress;
+    qint64 m_queued = 0;            // 已投递到服务器线程、还没交给 responder 的字节
+    qint64 m_socketBuffered = 0;    // 最近一次看到的 socket->bytesToWrite()
+    qint64 m_blockedMs = 0;
+    bool m_closed = false;
+    bool m_stalled = false;
+    QPointer<QTcpSocket> m_socket;  // 只在服务器线程里访问
+};
+
+#endif // STREAMBACKPRESSURE_H
@@ -0,0 +1,241 @@
+#include "Tracer.h"
+#include "AppConfig.h"
+#include "JsonStreamWriter.h"
+#include "Metrics.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QRandomGenerator>
+#include <QMutexLocker>
+#include <QDebug>
+#include <atomic>
+
+// SQL 等说明文字最多保留多少字符
+static const int kMaxDetailChars = 512;
+
+void RequestTrace::addSpan(const char *name, const char *category, qint64 startUs, qint64 endUs,
+                           const QString &detail)
+{
+    if (!m_sampled) return;
+    QMutexLocker locker(&m_mutex);
+    m_spans.push_back({name, category, startUs, endUs, detail.left(kMaxDetailChars)});
+}
+
+Tracer &Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Tracer()
+{
+    // SampleRate=0 且 SlowMs=0 表示关闭追踪
+    m_sampleRate = qBound(0.0, AppConfig::value("Trace/SampleRate", 0.01).toDouble(), 1.0);
+    m_slowUs = AppConfig::value("Trace/SlowMs", 1000).toLongLong() * 1000;
+    m_maxBytes = qMax<qint64>(1, AppConfig::value("Trace/MaxFileMB", 64).toLongLong()) * 1024 * 1024;
+    m_maxFiles = qMax(1, AppConfig::value("Trace/MaxFiles", 5).toInt());
+    m_maxQueuedBytes = qMax<qint64>(1, AppConfig::value("Trace/MaxQueueMB", 16).toLongLong()) * 1024 * 1024;
+    m_enabled = m_sampleRate > 0 || m_slowUs > 0;
+    if (!m_enabled) return;
+
+    // 相对路径按程序所在目录解析
+    const QString file = AppConfig::value("Trace/File", "traces/trace.json").toString();
+    m_path = QDir(QCoreApplication::applicationDirPath()).absoluteFilePath(file);
+
+    m_dropped = Metrics::instance().counter("trace_dropped_total",
+                                            "Finished traces dropped because the trace writer queue was full");
+    m_writer.reset(QThread::create([this] { writerLoop(); }));
+    m_writer->start(QThread::LowPriority);
+}
+
+Tracer::~Tracer()
+{
+    if (!m_writer) return;
+    {
+        QMutexLocker locker(&m_queueMutex);
+        m_stopping = true;
+        m_queueReady.wakeOne();
+    }
+    m_writer->wait(); // 写线程把队列里剩下的写完再退出
+}
+
+qint64 Tracer::nowUs()
+{
+    static const QElapsedTimer clock = [] {
+        QElapsedTimer t;
+        t.start();
+        return t;
+    }();
+    return clock.nsecsElapsed() / 1000;
+}
+
+RequestTrace *&Tracer::currentRaw()
+{
+    static thread_local RequestTrace *trace = nullptr;
+    return trace;
+}
+
+std::shared_ptr<RequestTrace> Tracer::current()
+{
+    RequestTrace *trace = currentRaw();
+    return trace ? trace->shared_from_this() : nullptr;
+}
+
+std::shared_ptr<RequestTrace> Tracer::begin(const QString &route)
+{
+    if (!m_enabled) return nullptr;
+
+    static std::atomic<quint64> nextId{1};
+    // 抽样在开始时决定；没抽中的请求只留起始时间，结束时超过慢请求阈值的写出整个请求这一条
+    const bool sampled = m_sampleRate > 0 && QRandomGenerator::global()->generateDouble() < m_sampleRate;
+    return std::make_shared<RequestTrace>(nextId.fetch_add(1, std::memory_order_relaxed), route, sampled, nowUs());
+}
+
+void Tracer::finish(const std::shared_ptr<RequestTrace> &trace, int statusCode)
+{
+    if (!trace) return;
+
+    const qint64 endUs = nowUs();
+    const bool slow = m_slowUs > 0 && endUs - trace->m_startUs >= m_slowUs;
+    if (!trace->m_sampled && !slow) return;
+
+    std::vector<RequestTrace::Span> spans;
+    {
+        QMutexLocker locker(&trace->m_mutex);
+        spans.swap(trace->m_spans);
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    const qint64 tid = qint64(trace->m_id);
+
+    // 每个事件一行，行尾带逗号 (JSON 数组格式允许最后不闭合)
+    QByteArray lines;
+    JsonStreamWriter out(1024);
+    auto endLine = [&]() {
+        lines += out.take();
+        lines += ",\n";
+    };
+
+    // 1. 查看器里这一行的标题
+    out.beginObject();
+    out.field("name", "thread_name");
+    out.field("ph", "M");
+    out.field("pid", pid);
+    out.field("tid", tid);
+    out.key("args");
+    out.beginObject();
+    out.field("name", QString("#%1 %2").arg(trace->m_id).arg(trace->m_route));
+    out.endObject();
+    out.endObject();
+    endLine();
+
+    // 2. 整个请求
+    out.beginObject();
+    out.field("name", trace->m_route);
+    out.field("cat", "request");
+    out.field("ph", "X");
+    out.field("ts", trace->m_startUs);
+    out.field("dur", endUs - trace->m_startUs);
+    out.field("pid", pid);
+    out.field("tid", tid);
+    out.key("args");
+    out.beginObject();
+    out.field("request_id", qint64(trace->m_id));
+    out.field("status", statusCode);
+    out.field("kept", slow ? "slow" : "sampled");
+    out.endObject();
+    out.endObject();
+    endLine();
+
+    // 3. 各个区间
+    for (const RequestTrace::Span &span : spans) {
+        out.beginObject();
+        out.field("name", span.name);
+        out.field("cat", span.category);
+        out.field("ph", "X");
+        out.field("ts", span.startUs);
+        out.field("dur", span.endUs - span.startUs);
+        out.field("pid", pid);
+        out.field("tid", tid);
+        if (!span.detail.isEmpty()) {
+            out.key("args");
+            out.beginObject();
+            out.field("detail", span.detail);
+            out.endObject();
+        }
+        out.endObject();
+        endLine();
+    }
+
+    enqueue(lines);
+}
+
+void Tracer::enqueue(const QByteArray &events)
+{
+    QMutexLocker locker(&m_queueMutex);
+    // 磁盘跟不上时丢掉新的追踪，不让队列无限增长
+    if (m_queue.size() + events.size() > m_maxQueuedBytes) {
+        m_dropped->inc();
+        return;
+    }
+    const bool wasEmpty = m_queue.isEmpty();
+    m_queue += events;
+    if (wasEmpty) m_queueReady.wakeOne();
+}
+
+void Tracer::writerLoop()
+{
+    QByteArray batch;
+    for (;;) {
+        {
+            QMutexLocker locker(&m_queueMutex);
+            while (m_queue.isEmpty() && !m_stopping) m_queueReady.wait(&m_queueMutex);
+            if (m_queue.isEmpty()) return; // m_stopping 且已经写完
+            batch.swap(m_queue);
+        }
+        // 一批只 flush 一次
+        write(batch);
+        batch.clear();
+    }
+}
+
+void Tracer::write(const QByteArray &events)
+{
+    if (!m_file.isOpen()) {
+        QDir().mkpath(QFileInfo(m_path).absolutePath());
+        m_file.setFileName(m_path);
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            qWarning() << "Trace File Error:" << m_file.errorString();
+            return;
+        }
+        if (m_file.size() == 0) m_file.write("[\n");
+    }
+
+    m_file.write(events);
+    m_file.flush();
+
+    if (m_file.size() >= m_maxBytes) rotate();
+}
+
+void Tracer::rotate()
+{
+    // trace.json -> trace.1.json -> trace.2.json ... 超出 MaxFiles 的删掉
+    m_file.close();
+    const QFileInfo info(m_path);
+    auto rotated = [&info](int n) {
+        return info.absolutePath() + '/' + info.completeBaseName() + '.' + QString::number(n) + '.' + info.suffix();
+    };
+
+    QFile::remove(rotated(m_maxFiles - 1));
+    for (int n = m_maxFiles - 2; n >= 1; --n) {
+        QFile::rename(rotated(n), rotated(n + 1));
+    }
+    if (m_maxFiles > 1) {
+        QFile::rename(m_path, rotated(1));
+    } else {
+        QFile::remove(m_path);
+    }
+    // 下一次 write() 重新打开新文件
+}
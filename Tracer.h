@@ -0,0 +1,152 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThread>
+#include <QFile>
+#include <memory>
+#include <vector>
+
+class MetricCounter;
+
+// ==============================================================================
+//  请求级追踪 (导出为 Chrome trace_event JSON，可以直接拖进 chrome://tracing 或 Perfetto 查看)
+//  - 路由分发时 Tracer::begin() 分配 request id，处理期间该请求是当前线程的 "当前追踪"
+//  - TraceSpan 是 RAII 区间：数据库语句、取连接、提交事务、大模型调用等处各包一个
+//  - 抽样 (Trace/SampleRate) 在 begin() 时决定，只有抽中的请求才记录各个区间；
+//    没抽中的请求只有一个起始时间，结束时慢于 Trace/SlowMs 的写出一条整个请求的事件
+//  - Tracer::finish() 只在请求线程上拼好事件文本，交给后台写线程排队；写线程批量追加到本地文件
+//    (超过 Trace/MaxFileMB 时轮转，最多保留 Trace/MaxFiles 个)，队列积压超过上限时丢弃并计数
+//  文件用 trace_event 的 JSON 数组格式 ("[" 开头、每行一个事件，结尾的 "]" 可以省略)，
+//  所以只需要追加写。每个请求在查看器里是单独的一行 (tid = request id)。
+//  异步链 (如 /api/ai_chat) 在每一步用 TraceScope 把追踪重新设为当前线程的当前追踪。
+// ==============================================================================
+class RequestTrace : public std::enable_shared_from_this<RequestTrace> {
+public:
+    RequestTrace(quint64 id, const QString &route, bool sampled, qint64 startUs)
+        : m_id(id), m_route(route), m_sampled(sampled), m_startUs(startUs) {}
+
+    quint64 id() const { return m_id; }
+    qint64 startUs() const { return m_startUs; }
+    bool isSampled() const { return m_sampled; }
+
+    // 记录一个已经结束的区间 (可以从任意线程调用；没抽中的请求直接忽略)
+    void addSpan(const char *name, const char *category, qint64 startUs, qint64 endUs,
+                 const QString &detail = QString());
+
+private:
+    friend class Tracer;
+    struct Span {
+        const char *name;
+        const char *category;
+        qint64 startUs;
+        qint64 endUs;
+        QString detail;
+    };
+
+    const quint64 m_id;
+    const QString m_route;
+    const bool m_sampled;
+    const qint64 m_startUs;
+    QMutex m_mutex;
+    std::vector<Span> m_spans;
+};
+
+class Tracer {
+public:
+    static Tracer &instance();
+
+    bool isEnabled() const { return m_enabled; }
+
+    // 进程内单调时钟 (微秒)，所有事件的时间戳都用它
+    static qint64 nowUs();
+
+    // 路由分发时调用；追踪关闭时返回空指针
+    std::shared_ptr<RequestTrace> begin(const QString &route);
+
+    // 请求处理完：抽中或者超过慢请求阈值就交给写线程
+    void finish(const std::shared_ptr<RequestTrace> &trace, int statusCode);
+
+    // 当前线程正在处理的请求 (没有时为空)
+    static std::shared_ptr<RequestTrace> current();
+
+private:
+    friend class TraceScope;
+    friend class TraceSpan;
+    static RequestTrace *&currentRaw();
+
+    Tracer();
+    ~Tracer();
+    void enqueue(const QByteArray &events);
+    void writerLoop();
+    void write(const QByteArray &events);   // 只在写线程里调用
+    void rotate();
+
+    bool m_enabled = false;
+    double m_sampleRate = 0;
+    qint64 m_slowUs = 0;
+    QString m_path;
+    qint64 m_maxBytes = 0;
+    int m_maxFiles = 1;
+    qint64 m_maxQueuedBytes = 0;
+
+    // 请求线程 -> 写线程
+    QMutex m_queueMutex;
+    QWaitCondition m_queueReady;
+    QByteArray m_queue;
+    bool m_stopping = false;
+    MetricCounter *m_dropped = nullptr;
+    std::unique_ptr<QThread> m_writer;
+
+    QFile m_file; // 只有写线程访问
+};
+
+// 在当前线程上设置当前追踪，析构时恢复原来的值
+class TraceScope {
+public:
+    explicit TraceScope(const std::shared_ptr<RequestTrace> &trace)
+        : m_trace(trace), m_previous(Tracer::currentRaw()) {
+        Tracer::currentRaw() = trace.get();
+    }
+    ~TraceScope() { Tracer::currentRaw() = m_previous; }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    std::shared_ptr<RequestTrace> m_trace;
+    RequestTrace *m_previous;
+};
+
+// RAII 区间：当前线程没有追踪或没抽中时什么也不做 (只有一次 thread_local 读取)
+// name / category 必须是字符串字面量
+class TraceSpan {
+public:
+    explicit TraceSpan(const char *name, const char *category = "app")
+        : m_trace(Tracer::currentRaw()), m_name(name), m_category(category) {
+        if (m_trace && !m_trace->isSampled()) m_trace = nullptr; // 没抽中的请求不记区间
+        if (m_trace) m_startUs = Tracer::nowUs();
+    }
+    ~TraceSpan() {
+        if (m_trace) m_trace->addSpan(m_name, m_category, m_startUs, Tracer::nowUs(), m_detail);
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+    bool isActive() const { return m_trace != nullptr; }
+    // 附加说明 (例如 SQL 文本)，只在 isActive() 时才值得构造
+    void setDetail(const QString &detail) { m_detail = detail; }
+
+private:
+    RequestTrace *m_trace;
+    const char *m_name;
+    const char *m_category;
+    qint64 m_startUs = 0;
+    QString m_detail;
+};
+
+#endif // TRACER_H
@@ -0,0 +1,93 @@
+#include "UserProfileCache.h"
+#include "AppConfig.h"
+
+#include <QDateTime>
+#include <QMutexLocker>
+
+UserProfileCache &UserProfileCache::instance()
+{
+    static UserProfileCache cache;
+    return cache;
+}
+
+UserProfileCache::UserProfileCache()
+{
+    // MaxEntries=0 表示关闭缓存
+    m_maxEntries = qMax(0, AppConfig::value("UserCache/MaxEntries", 100000).toInt());
+    m_ttlMs = AppConfig::value("UserCache/TtlSec", 300).toLongLong() * 1000;
+
+    m_hits = Metrics::instance().counter("cache_lookups_total", "In-memory cache lookups by cache and result",
+                                         "cache=\"user_profile\",result=\"hit\"");
+    m_misses = Metrics::instance().counter("cache_lookups_total", "In-memory cache lookups by cache and result",
+                                           "cache=\"user_profile\",result=\"miss\"");
+}
+
+bool UserProfileCache::lookup(int uid, QJsonObject *profile)
+{
+    if (!isEnabled()) return false;
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.constFind(uid);
+    if (it == m_entries.constEnd()) {
+        m_misses->inc();
+        return false;
+    }
+
+    EntryList::iterator entry = it.value();
+    if (entry->expiresAtMs <= QDateTime::currentMSecsSinceEpoch()) {
+        m_entries.remove(uid);
+        m_lru.erase(entry);
+        m_misses->inc();
+        return false;
+    }
+
+    m_lru.splice(m_lru.begin(), m_lru, entry); // 移到头部
+    *profile = entry->profile;                  // QJsonObject 隐式共享，这里不拷贝数据
+    m_hits->inc();
+    return true;
+}
+
+quint64 UserProfileCache::generation(int uid) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_generations[uint(uid) % kGenerationShards];
+}
+
+void UserProfileCache::insert(int uid, const QJsonObject &profile, quint64 generation)
+{
+    if (!isEnabled()) return;
+
+    QMutexLocker locker(&m_mutex);
+    if (generation != generationLocked(uid)) return; // 查库期间资料被改过，结果可能已过期
+
+    const qint64 expiresAtMs = QDateTime::currentMSecsSinceEpoch() + m_ttlMs;
+    auto old = m_entries.find(uid);
+    if (old != m_entries.end()) {
+        EntryList::iterator entry = old.value();
+        entry->profile = profile;
+        entry->expiresAtMs = expiresAtMs;
+        m_lru.splice(m_lru.begin(), m_lru, entry);
+        return;
+    }
+
+    m_lru.push_front({uid, profile, expiresAtMs});
+    m_entries.insert(uid, m_lru.begin());
+
+    // 超出条数上限，从尾部淘汰最久未用的
+    while (m_entries.size() > m_maxEntries) {
+        m_entries.remove(m_lru.back().uid);
+        m_lru.pop_back();
+    }
+}
+
+void UserProfileCache::invalidate(int uid)
+{
+    if (!isEnabled()) return;
+
+    QMutexLocker locker(&m_mutex);
+    ++generationLocked(uid);
+    auto it = m_entries.find(uid);
+    if (it == m_entries.end()) return;
+    m_lru.erase(it.value());
+    m_entries.erase(it);
+}
@@ -0,0 +1,58 @@
+#ifndef USERPROFILECACHE_H
+#define USERPROFILECACHE_H
+
+#include "Metrics.h"
+
+#include <QJsonObject>
+#include <QHash>
+#include <QMutex>
+#include <list>
+
+// ==============================================================================
+//  用户资料缓存 (/api/user/info 的 data 部分)
+//  key 为 U_ID，按条数做 LRU 淘汰，每条记录另有 TTL 兜底 (覆盖绕过本服务直接改库的情况)。
+//  资料修改 (昵称/电话/邮箱、实名认证) 和余额变化 (充值、支付、退款) 提交后都作废该用户的缓存，
+//  下次读取再从数据库加载：并发修改的提交顺序和写缓存的顺序可能不一致，以数据库为准；
+//  余额也始终是数据库 DECIMAL 的值，不在内存里做浮点加减。
+// ==============================================================================
+class UserProfileCache {
+public:
+    static UserProfileCache &instance();
+
+    bool isEnabled() const { return m_maxEntries > 0; }
+
+    // 命中返回 true 并写入 *profile
+    bool lookup(int uid, QJsonObject *profile);
+
+    // 查库之前先取该用户的代数，插入时代数变了 (期间被修改过) 就放弃插入
+    quint64 generation(int uid) const;
+    void insert(int uid, const QJsonObject &profile, quint64 generation);
+
+    // 资料或余额修改提交之后调用
+    void invalidate(int uid);
+
+private:
+    struct Entry {
+        int uid;
+        QJsonObject profile;
+        qint64 expiresAtMs = 0;
+    };
+    using EntryList = std::list<Entry>;
+
+    UserProfileCache();
+
+    // 代数按 uid 分片，一个用户的修改不会让其他用户的加载结果作废
+    static constexpr int kGenerationShards = 64;
+    quint64 &generationLocked(int uid) { return m_generations[uint(uid) % kGenerationShards]; }
+
+    mutable QMutex m_mutex;
+    EntryList m_lru;                               // 头部最近使用
+    QHash<int, EntryList::iterator> m_entries;
+    quint64 m_generations[kGenerationShards] = {};
+    int m_maxEntries = 0;
+    qint64 m_ttlMs = 0;
+    MetricCounter *m_hits = nullptr;    // 命中率见 /metrics
+    MetricCounter *m_misses = nullptr;
+};
+
+#endif // USERPROFILECACHE_H
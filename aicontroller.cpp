@@ -1,28 +1,26 @@
 #include "aicontroller.h"
 #include "DatabaseManager.h"
+#include "FlightQueries.h"
+#include "CityDirectory.h"
+#include "FlightStore.h"
 #include <QNetworkRequest>
 #include <QUrl>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
-#include <QEventLoop>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QPromise>
+#include <memory>
 #include <QDate>
 #include <QDebug>
 #include <QSqlQuery>
 #include <QSqlError>
-#include <QSettings>
-#include <QCoreApplication>
-#include <QFileInfo>
+#include <QSqlRecord>
 
-// 辅助函数：读取配置文件
+// 辅助函数：读取配置文件 (AppConfig 只在启动时解析一次 config.ini)
 QString getAiConfig(const QString &key, const QString &defaultValue = "") {
-    QString configPath = QCoreApplication::applicationDirPath() + "/config.ini";
-    if (!QFileInfo::exists(configPath)) {
-        // 如果没有配置文件，可以使用默认值或者硬编码
-        return defaultValue;
-    }
-    QSettings settings(configPath, QSettings::IniFormat);
-    return settings.value("AI/" + key, defaultValue).toString();
+    return AppConfig::value("AI/" + key, defaultValue).toString();
 }
 
 AIController::AIController(QObject *parent) : BaseController(parent)
@@ -38,13 +36,36 @@ void AIController::registerRoutes(QHttpServer *server)
     //   "message": "明天",
     //   "history": [ {"role":"user", "content":"我想去北京"}, {"role":"assistant", "content":"请问您从哪里出发？"} ]
     // }
-    server->route("/api/ai_chat", QHttpServerRequest::Method::Post,
-                  [this](const QHttpServerRequest &req) {
-                      return handleAIChat(req);
-                  });
+    routeAsync(server, "/api/ai_chat", QHttpServerRequest::Method::Post,
+               [this](const QHttpServerRequest &req) {
+                   return handleAIChat(req);
+               });
 }
 
-QHttpServerResponse AIController::handleAIChat(const QHttpServerRequest &request)
+// 辅助函数：组装 /api/ai_chat 的返回 JSON
+static QJsonObject makeChatResponse(const QString &aiReplyText, const QJsonArray &flightData)
+{
+    QJsonObject responseObj;
+    responseObj["status"] = "success";
+
+    QJsonObject dataObj;
+    dataObj["chat"] = aiReplyText; // AI 的自然语言回复
+
+    // 如果查到了数据，也带上（前端可用于渲染卡片）
+    if (!flightData.isEmpty()) {
+        dataObj["data"] = flightData;
+        dataObj["type"] = "flight_list_with_chat";
+    } else {
+        dataObj["type"] = "chat_only";
+    }
+
+    responseObj["data"] = dataObj;
+    return responseObj;
+}
+
+// 整个对话流程是一条异步链：意图解析 -> (查库) -> 生成回复
+// 每一步都不阻塞服务器线程，大模型慢也不会影响其他接口
+QFuture<QHttpServerResponse> AIController::handleAIChat(const QHttpServerRequest &request)
 {
     // 1. 解析请求体
     QJsonDocument jsonDoc = QJsonDocument::fromJson(request.body());
@@ -54,17 +75,29 @@ QHttpServerResponse AIController::handleAIChat(const QHttpServerRequest &request
     QJsonArray history = reqObj["history"].toArray(); // 获取前端传来的历史上下文
 
     // 2. 意图解析 (传入 history，让 AI 结合上下文理解 "明天" 指的是 "明天去哪")
-    QJsonObject intent = callLLMToParseIntent(userMessage, history);
+    // 后续步骤在别的回调里执行，把本请求的追踪带过去
+    auto trace = Tracer::current();
+    return callLLMToParseIntent(userMessage, history)
+        .then(this, [this, userMessage, history, trace](const QJsonObject &intent) {
+            TraceScope scope(trace);
+            return replyForIntent(intent, userMessage, history);
+        })
+        .unwrap()
+        .then([](const QJsonObject &responseObj) {
+            // 3. 构造返回 JSON
+            return QHttpServerResponse(responseObj, QHttpServerResponse::StatusCode::Ok);
+        });
+}
 
+// 根据意图走不同的分支，返回最终的响应 JSON
+QFuture<QJsonObject> AIController::replyForIntent(const QJsonObject &intent, const QString &userMessage, const QJsonArray &history)
+{
     // 提取解析结果
     QString type = intent["type"].toString();
     QString from = intent["from"].toString();
     QString to = intent["to"].toString();
     QString date = intent["date"].toString();
 
-    QString aiReplyText;
-    QJsonArray flightData;
-
     // --- 分支 A：意图是查票，且信息完整 ---
     if (type == "query" && !from.isEmpty() && !to.isEmpty()) {
 
@@ -75,70 +108,67 @@ QHttpServerResponse AIController::handleAIChat(const QHttpServerRequest &request
             isDateGuessed = true;
         }
 
-        // 查库
-        flightData = searchFlightsInDB(from, to, date);
-        QString dataStr = QJsonDocument(flightData).toJson(QJsonDocument::Compact);
-
-        // 构造 System Prompt (注入查询结果)
-        QString systemPrompt = QString(
-                                   "你是一个专业的票务专家。用户查询：%1 -> %2 在 %3 的航班。\n"
-                                   "%4" // 插入日期推断提示
-                                   "数据库查询结果如下(JSON)：\n%5\n"
-                                   "要求：\n"
-                                   "1. 如果有数据：直接推荐性价比最高和时间最早的航班。不要罗列JSON代码，用自然语言回答。\n"
-                                   "2. 如果无数据：礼貌告知，并建议用户换个日期。\n"
-                                   "3. 语气热情专业。"
-                                   ).arg(from, to, date,
-                                        isDateGuessed ? "(注意：用户未指定日期，我已默认帮他查询了明天的航班，请在回复中说明这一点)。" : "",
-                                        dataStr);
-
-        // 生成回复 (传入 history 以保持对话连贯性)
-        aiReplyText = callLLMToChat(systemPrompt, userMessage, history);
-
+        // 查库放到工作线程池，查完回到本线程继续调用大模型
+        auto trace = Tracer::current();
+        return QtConcurrent::run(workerPool(), [this, from, to, date, trace]() {
+                   TraceScope scope(trace);
+                   TraceSpan span("searchFlightsInDB", "ai");
+                   return searchFlightsInDB(from, to, date);
+               })
+            .then(this, [this, from, to, date, isDateGuessed, userMessage, history, trace](const QJsonArray &flightData) {
+                TraceScope scope(trace);
+                QString dataStr = QJsonDocument(flightData).toJson(QJsonDocument::Compact);
+
+                // 构造 System Prompt (注入查询结果)
+                QString systemPrompt = QString(
+                                           "你是一个专业的票务专家。用户查询：%1 -> %2 在 %3 的航班。\n"
+                                           "%4" // 插入日期推断提示
+                                           "数据库查询结果如下(JSON)：\n%5\n"
+                                           "要求：\n"
+                                           "1. 如果有数据：直接推荐性价比最高和时间最早的航班。不要罗列JSON代码，用自然语言回答。\n"
+                                           "2. 如果无数据：礼貌告知，并建议用户换个日期。\n"
+                                           "3. 语气热情专业。"
+                                           ).arg(from, to, date,
+                                                isDateGuessed ? "(注意：用户未指定日期，我已默认帮他查询了明天的航班，请在回复中说明这一点)。" : "",
+                                                dataStr);
+
+                // 生成回复 (传入 history 以保持对话连贯性)
+                return callLLMToChat(systemPrompt, userMessage, history)
+                    .then([flightData](const QString &aiReplyText) {
+                        return makeChatResponse(aiReplyText, flightData);
+                    });
+            })
+            .unwrap();
     }
+
+    QString systemPrompt;
     // --- 分支 B：意图是查票，但缺少关键信息 ---
-    else if (type == "query" && (!from.isEmpty() || !to.isEmpty())) {
+    if (type == "query" && (!from.isEmpty() || !to.isEmpty())) {
 
         // 确定缺什么
         QString missingInfo;
         if (from.isEmpty()) missingInfo += "出发地";
         if (to.isEmpty()) missingInfo += (missingInfo.isEmpty() ? "" : "和") + QString("目的地");
 
-        QString systemPrompt = QString(
-                                   "你是一个航班助手。用户想查票，但缺少: %1。\n"
-                                   "当前已识别: from=%2, to=%3。\n"
-                                   "请礼貌地根据当前已知信息追问缺失信息。例如：'收到，去%3，请问您从哪里出发？'"
-                                   ).arg(missingInfo, from.isEmpty() ? "?" : from, to.isEmpty() ? "?" : to);
-
-        aiReplyText = callLLMToChat(systemPrompt, userMessage, history);
+        systemPrompt = QString(
+                           "你是一个航班助手。用户想查票，但缺少: %1。\n"
+                           "当前已识别: from=%2, to=%3。\n"
+                           "请礼貌地根据当前已知信息追问缺失信息。例如：'收到，去%3，请问您从哪里出发？'"
+                           ).arg(missingInfo, from.isEmpty() ? "?" : from, to.isEmpty() ? "?" : to);
     }
     // --- 分支 C：闲聊或其他 ---
     else {
-        QString systemPrompt = "你是一个风趣的航空旅行助手。简短热情地回复用户。如果用户提到旅行计划，可以主动问是否需要查票。可以尝试推荐一些热门的旅游景点。";
-        aiReplyText = callLLMToChat(systemPrompt, userMessage, history);
+        systemPrompt = "你是一个风趣的航空旅行助手。简短热情地回复用户。如果用户提到旅行计划，可以主动问是否需要查票。可以尝试推荐一些热门的旅游景点。";
     }
 
-    // 3. 构造返回 JSON
-    QJsonObject responseObj;
-    responseObj["status"] = "success";
-
-    QJsonObject dataObj;
-    dataObj["chat"] = aiReplyText; // AI 的自然语言回复
-
-    // 如果查到了数据，也带上（前端可用于渲染卡片）
-    if (!flightData.isEmpty()) {
-        dataObj["data"] = flightData;
-        dataObj["type"] = "flight_list_with_chat";
-    } else {
-        dataObj["type"] = "chat_only";
-    }
-
-    responseObj["data"] = dataObj;
-    return QHttpServerResponse(responseObj, QHttpServerResponse::StatusCode::Ok);
+    return callLLMToChat(systemPrompt, userMessage, history)
+        .then([](const QString &aiReplyText) {
+            return makeChatResponse(aiReplyText, QJsonArray());
+        });
 }
 
 // 意图解析函数
-QJsonObject AIController::callLLMToParseIntent(const QString &userText, const QJsonArray &history)
+QFuture<QJsonObject> AIController::callLLMToParseIntent(const QString &userText, const QJsonArray &history)
 {
     QString currentDate = QDate::currentDate().toString("yyyy-MM-dd");
 
@@ -181,20 +211,20 @@ QJsonObject AIController::callLLMToParseIntent(const QString &userText, const QJ
     payload["messages"] = messages;
     payload["temperature"] = 0.1; // 低温以保证 JSON 格式稳定
 
-    QJsonObject resp = performLLMRequest(payload);
+    return performLLMRequest(payload, "callLLMToParseIntent").then([](const QJsonObject &resp) {
+        // 解析返回的 JSON 字符串
+        QString content = resp["content_str"].toString();
+        // 清理 Markdown 代码块标记
+        content.remove("```json");
+        content.remove("```");
 
-    // 解析返回的 JSON 字符串
-    QString content = resp["content_str"].toString();
-    // 清理 Markdown 代码块标记
-    content.remove("```json");
-    content.remove("```");
-
-    QJsonDocument doc = QJsonDocument::fromJson(content.toUtf8());
-    return doc.object();
+        QJsonDocument doc = QJsonDocument::fromJson(content.toUtf8());
+        return doc.object();
+    });
 }
 
 // 对话生成函数
-QString AIController::callLLMToChat(const QString &systemPrompt, const QString &userText, const QJsonArray &history)
+QFuture<QString> AIController::callLLMToChat(const QString &systemPrompt, const QString &userText, const QJsonArray &history)
 {
     QJsonArray messages;
 
@@ -221,39 +251,76 @@ QString AIController::callLLMToChat(const QString &systemPrompt, const QString &
     payload["messages"] = messages;
     payload["temperature"] = 0.7; // 稍高温度让回答自然
 
-    QJsonObject resp = performLLMRequest(payload);
-    return resp["content_str"].toString();
+    return performLLMRequest(payload, "callLLMToChat").then([](const QJsonObject &resp) {
+        return resp["content_str"].toString();
+    });
 }
 
-// 查库函数 (保持不变)
+// 查库函数 (在工作线程中执行)
 QJsonArray AIController::searchFlightsInDB(const QString &from, const QString &to, const QString &date)
 {
-    QSqlDatabase db = DatabaseManager::getConnection();
     QJsonArray flightList;
+    QDate day = QDate::fromString(date, "yyyy-MM-dd");
+    if (!day.isValid()) return flightList;
+
+    // 大模型可能返回拼音或三字码，统一转成 flights 表里的中文城市名
+    const QString origin = CityDirectory::instance().cityName(from);
+    const QString destination = CityDirectory::instance().cityName(to);
+
+    // 内存航班库已加载时直接查内存
+    if (FlightStore::instance().isLoaded()) {
+        FlightFilter filter;
+        filter.origin = origin;
+        filter.destination = destination;
+        filter.date = day;
+        for (const FlightRecord &f : FlightStore::instance().search(filter)) {
+            QJsonObject flight;
+            flight["id"] = f.id;
+            flight["flight_number"] = f.flightNumber;
+            flight["airline"] = f.airline;
+            flight["aircraft_model"] = f.aircraftModel;
+            flight["departure_time"] = f.departureTime.toString("HH:mm");
+            flight["landing_time"] = f.landingTime.toString("HH:mm");
+            flight["price"] = f.prices[0];
+            flight["remaining"] = f.remaining[0];
+            flightList.append(flight);
+        }
+        return flightList;
+    }
+
+    // 只读查询，走只读副本 (未配置时就是主库)
+    PooledConnection db = DatabaseManager::getReadConnection();
     if (!db.isOpen()) return flightList;
 
-    QSqlQuery query(db);
     // 注意：flights 表结构应与 flight_system.sql 一致
-    QString sql = "SELECT * FROM flights WHERE origin = ? AND destination = ? AND DATE(departure_time) = ?";
-
-    query.prepare(sql);
-    query.addBindValue(from);
-    query.addBindValue(to);
-    query.addBindValue(date);
+    QSqlQuery &query = db.prepared(FlightQueries::searchByRouteDaySql());
+    FlightQueries::bindRouteDay(query, origin, destination, day);
+
+    if (DatabaseManager::exec(query)) {
+        // 列下标只解析一次
+        const QSqlRecord rec = query.record();
+        const int cId = rec.indexOf("ID");
+        const int cFlightNumber = rec.indexOf("flight_number");
+        const int cAirline = rec.indexOf("airline");
+        const int cModel = rec.indexOf("aircraft_model");
+        const int cDeparture = rec.indexOf("departure_time");
+        const int cLanding = rec.indexOf("landing_time");
+        const int cPrice = rec.indexOf("economy_price");
+        const int cRemaining = rec.indexOf("economy_remaining");
 
-    if (query.exec()) {
         while (query.next()) {
             QJsonObject flight;
-            flight["id"] = query.value("ID").toInt();
-            flight["flight_number"] = query.value("flight_number").toString();
-            flight["airline"] = query.value("airline").toString();
-            flight["aircraft_model"] = query.value("aircraft_model").toString();
+            flight["id"] = query.value(cId).toInt();
+            flight["flight_number"] = query.value(cFlightNumber).toString();
+            flight["airline"] = query.value(cAirline).toString();
+            flight["aircraft_model"] = query.value(cModel).toString();
 
-            QDateTime depTime = query.value("departure_time").toDateTime();
-            QDateTime arrTime = query.value("landing_time").toDateTime();
+            QDateTime depTime = query.value(cDeparture).toDateTime();
+            QDateTime arrTime = query.value(cLanding).toDateTime();
             flight["departure_time"] = depTime.toString("HH:mm");
             flight["landing_time"] = arrTime.toString("HH:mm");
-            flight["price"] = query.value("economy_price").toInt();
+            flight["price"] = query.value(cPrice).toInt();
+            flight["remaining"] = query.value(cRemaining).toInt();
 
             flightList.append(flight);
         }
@@ -261,12 +328,33 @@ QJsonArray AIController::searchFlightsInDB(const QString &from, const QString &t
     return flightList;
 }
 
-// 通用 LLM 请求函数
-QJsonObject AIController::performLLMRequest(const QJsonObject &payload)
+// 大模型调用指标：耗时直方图 + 按结果分类的次数 (result = ok / timeout / network_error / bad_response)
+static void recordLLMCall(qint64 elapsedNs, const char *result)
+{
+    static MetricHistogram *latency = Metrics::instance().histogram(
+        "llm_request_duration_seconds", "LLM API call latency", QString(),
+        {0.25, 0.5, 1, 2, 4, 8, 15, 30, 60});
+    static QHash<QString, MetricCounter *> byResult = [] {
+        QHash<QString, MetricCounter *> h;
+        for (const char *r : {"ok", "timeout", "network_error", "bad_response"}) {
+            h.insert(r, Metrics::instance().counter("llm_requests_total", "LLM API calls by result",
+                                                    QString("result=\"%1\"").arg(r)));
+        }
+        return h;
+    }();
+    latency->observeNs(elapsedNs);
+    byResult.value(result)->inc();
+}
+
+// 通用 LLM 请求函数 (异步)
+// 返回的 future 一定会完成：网络错误、超时都会转成一条提示文字放在 content_str 里
+QFuture<QJsonObject> AIController::performLLMRequest(const QJsonObject &payload, const char *spanName)
 {
     // 从配置文件读取配置，支持回退
     QString apiUrl = getAiConfig("ApiUrl", "https://open.bigmodel.cn/api/paas/v4/chat/completions");
     QString apiKey = getAiConfig("ApiKey", "");
+    const int connectTimeoutMs = getAiConfig("ConnectTimeoutMs", "5000").toInt();
+    const int totalTimeoutMs = getAiConfig("TotalTimeoutMs", "30000").toInt();
 
     QNetworkRequest req((QUrl(apiUrl)));
     req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
@@ -277,33 +365,72 @@ QJsonObject AIController::performLLMRequest(const QJsonObject &payload)
     // qInfo() << "\n[AI Request] Sending to LLM:\n" << requestData;
     // // --------------------------------
 
-    QNetworkReply *reply = manager->post(req, QJsonDocument(payload).toJson());
+    auto promise = std::make_shared<QPromise<QJsonObject>>();
+    QFuture<QJsonObject> future = promise->future();
+    promise->start();
 
-    // 同步等待 (虽然会阻塞线程，但代码简单；生产环境建议用异步 callback)
-    QEventLoop loop;
-    connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
-    loop.exec();
+    QElapsedTimer callTimer;
+    callTimer.start();
+    // 请求在回调里才结束，区间手动记：发出时取开始时间，finished 时写入追踪
+    auto trace = Tracer::current();
+    const qint64 traceStartUs = Tracer::nowUs();
+    QNetworkReply *reply = manager->post(req, QJsonDocument(payload).toJson());
 
-    QJsonObject result;
-    if (reply->error() != QNetworkReply::NoError) {
-        qWarning() << "AI Request Error:" << reply->errorString();
-        // 返回错误提示给调用方，防止崩溃
-        result["content_str"] = "抱歉，AI连接出现网络错误，请稍后再试。";
-    } else {
-        QByteArray responseData = reply->readAll();
-        QJsonDocument doc = QJsonDocument::fromJson(responseData);
-
-        // 提取 content
-        // 假设 API 返回结构符合 OpenAI 标准
-        if (doc.object().contains("choices") && !doc.object()["choices"].toArray().isEmpty()) {
-            QJsonObject choice = doc.object()["choices"].toArray().first().toObject();
-            result["content_str"] = choice["message"].toObject()["content"].toString();
+    // 超时控制：请求发出之前算连接超时，整体再有一个总超时，到点直接 abort
+    auto timeoutReason = std::make_shared<QString>();
+
+    auto *connectTimer = new QTimer(reply);
+    connectTimer->setSingleShot(true);
+    connect(connectTimer, &QTimer::timeout, reply, [reply, timeoutReason]() {
+        *timeoutReason = "连接超时";
+        reply->abort();
+    });
+    connect(reply, &QNetworkReply::requestSent, connectTimer, &QTimer::stop);
+    connectTimer->start(connectTimeoutMs);
+
+    auto *totalTimer = new QTimer(reply);
+    totalTimer->setSingleShot(true);
+    connect(totalTimer, &QTimer::timeout, reply, [reply, timeoutReason]() {
+        *timeoutReason = "响应超时";
+        reply->abort();
+    });
+    totalTimer->start(totalTimeoutMs);
+
+    connect(reply, &QNetworkReply::finished, this, [reply, promise, timeoutReason, callTimer, trace, traceStartUs, spanName]() {
+        QJsonObject result;
+        const char *outcome = "ok";
+        if (!timeoutReason->isEmpty()) {
+            outcome = "timeout";
+            qWarning() << "AI Request Timeout:" << *timeoutReason;
+            result["content_str"] = "抱歉，AI服务" + *timeoutReason + "，请稍后再试。";
+        } else if (reply->error() != QNetworkReply::NoError) {
+            outcome = "network_error";
+            qWarning() << "AI Request Error:" << reply->errorString();
+            // 返回错误提示给调用方，防止崩溃
+            result["content_str"] = "抱歉，AI连接出现网络错误，请稍后再试。";
         } else {
-            qWarning() << "AI Response Format Error:" << responseData;
-            result["content_str"] = "抱歉，AI返回的数据格式异常。";
+            QByteArray responseData = reply->readAll();
+            QJsonDocument doc = QJsonDocument::fromJson(responseData);
+
+            // 提取 content
+            // 假设 API 返回结构符合 OpenAI 标准
+            if (doc.object().contains("choices") && !doc.object()["choices"].toArray().isEmpty()) {
+                QJsonObject choice = doc.object()["choices"].toArray().first().toObject();
+                result["content_str"] = choice["message"].toObject()["content"].toString();
+            } else {
+                outcome = "bad_response";
+                qWarning() << "AI Response Format Error:" << responseData;
+                result["content_str"] = "抱歉，AI返回的数据格式异常。";
+            }
         }
-    }
 
-    reply->deleteLater();
-    return result;
+        recordLLMCall(callTimer.nsecsElapsed(), outcome);
+        if (trace) trace->addSpan(spanName, "http", traceStartUs, Tracer::nowUs(), outcome);
+
+        promise->addResult(result);
+        promise->finish();
+        reply->deleteLater();
+    });
+
+    return future;
 }
@@ -6,6 +6,7 @@
 #include <QNetworkReply>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QFuture>
 
 class AIController : public BaseController
 {
@@ -15,20 +16,24 @@ public:
     void registerRoutes(QHttpServer *server) override;
 
 private:
-    // 处理 AI 对话请求
-    QHttpServerResponse handleAIChat(const QHttpServerRequest &request);
+    // 处理 AI 对话请求 (异步：返回的 future 在大模型回复后完成)
+    QFuture<QHttpServerResponse> handleAIChat(const QHttpServerRequest &request);
+
+    // 根据意图选择分支 (查票 / 追问 / 闲聊)，得到最终返回的 JSON
+    QFuture<QJsonObject> replyForIntent(const QJsonObject &intent, const QString &userMessage, const QJsonArray &history);
 
     // 辅助：调用大模型 API 解析意图 (新增 history 参数)
-    QJsonObject callLLMToParseIntent(const QString &userText, const QJsonArray &history);
+    QFuture<QJsonObject> callLLMToParseIntent(const QString &userText, const QJsonArray &history);
 
     // 辅助：调用大模型生成回复 (新增 history 参数)
-    QString callLLMToChat(const QString &systemPrompt, const QString &userText, const QJsonArray &history);
+    QFuture<QString> callLLMToChat(const QString &systemPrompt, const QString &userText, const QJsonArray &history);
 
-    // 辅助：根据解析出的参数查库
+    // 辅助：根据解析出的参数查库 (在工作线程中调用)
     QJsonArray searchFlightsInDB(const QString &from, const QString &to, const QString &date);
 
-    // 辅助：通用的 LLM 网络请求发送函数 (避免代码重复)
-    QJsonObject performLLMRequest(const QJsonObject &payload);
+    // 辅助：通用的 LLM 网络请求发送函数 (避免代码重复)，带连接超时和总超时
+    // spanName 是这次调用在请求追踪里的名字 (字符串字面量)
+    QFuture<QJsonObject> performLLMRequest(const QJsonObject &payload, const char *spanName);
 
     QNetworkAccessManager *manager;
 };
@@ -43,6 +43,9 @@ ALTER TABLE flights DROP INDEX unique_flight_number;
 
 ALTER TABLE flights ADD UNIQUE KEY unique_schedule (flight_number, departure_time);
 
+-- 航班搜索按 航线 + 出发时间区间 查询 (departure_time >= ? AND departure_time < ?)
+ALTER TABLE flights ADD INDEX idx_route_time (origin, destination, departure_time);
+
 -- 3. 订单表
 CREATE TABLE IF NOT EXISTS orders (
     ID INT NOT NULL AUTO_INCREMENT PRIMARY KEY,
@@ -56,14 +59,33 @@ CREATE TABLE IF NOT EXISTS orders (
     total_amount DECIMAL(10, 2) DEFAULT 0.00,
     paid_amount DECIMAL(10, 2) DEFAULT 0.00,
     payment_method VARCHAR(20) NULL COMMENT 'balance-余额, wechat-微信, alipay-支付宝',
+    -- 仍然占座的订单 = seat_number，已取消/已退款 = NULL (唯一键允许多个 NULL)
+    active_seat VARCHAR(50) AS (CASE WHEN status IN ('已取消', '已退款') THEN NULL ELSE seat_number END) STORED COMMENT '占座中的座位号',
     FOREIGN KEY (user_id) REFERENCES users(U_ID) ON DELETE CASCADE,
     FOREIGN KEY (flight_id) REFERENCES flights(ID) ON DELETE CASCADE,
     UNIQUE KEY unique_order_id (order_id),
     INDEX idx_flight_seat (flight_id, seat_number),
+    -- 同一航班同一座位只能有一张占座中的订单，下单时靠它防止重复分配，不再需要锁整个航班
+    UNIQUE KEY uniq_flight_active_seat (flight_id, active_seat),
     INDEX idx_status (status),
     INDEX idx_user (user_id)
 );
 
+-- 订单历史按 (order_date, ID) 倒序做 keyset 翻页，每页只需要在这个索引上做一次范围扫描
+ALTER TABLE orders ADD INDEX idx_user_date (user_id, order_date, ID);
+
+-- 余座计数：每个 (航班, 舱位) 拆成 8 行，合计为余座数；下单/取消/退款/删除订单时在同一个事务里随机挑一行加减，
+-- 同一舱位的并发下单不会在一行的行锁上排队
+-- seat_type 与 orders.seat_type 一致：0 经济舱, 1 商务舱, 2 头等舱
+CREATE TABLE IF NOT EXISTS flight_seat_inventory (
+    flight_id INT NOT NULL,
+    seat_type INT NOT NULL COMMENT '0:经济舱, 1:商务舱, 2:头等舱',
+    shard TINYINT NOT NULL COMMENT '分片号 0..7 (SeatCounters::kShards)',
+    remaining INT NOT NULL COMMENT '这个分片还能卖的座位数',
+    PRIMARY KEY (flight_id, seat_type, shard),
+    FOREIGN KEY (flight_id) REFERENCES flights(ID) ON DELETE CASCADE
+);
+
 -- 4. 城市代码映射表
 CREATE TABLE IF NOT EXISTS city_codes (
     id INT NOT NULL AUTO_INCREMENT PRIMARY KEY,
@@ -148,6 +170,7 @@ INSERT INTO orders (order_id, user_id, flight_id, seat_type, seat_number, status
 ('ORD00003', 3, 2, 1, '01F', '已取消', 5000.00, 0.00, '2025-11-26 11:00:00'),
 ('ORD00004', 1, 3, 2, '01A', '未支付', 35000.00, 0.00, '2025-11-27 09:00:00');
 
+-- 5. 余座计数不在这里初始化：服务器启动时给没有计数行的航班按 orders 补齐 (SeatCounters::backfill)
 
 -- ============================================
 -- 创建视图（用于SystemController）
@@ -0,0 +1,205 @@
+-- SQLite 版本的 flight_system.sql (config.ini 里 Database/Driver=sqlite 时使用)
+-- 服务器启动时发现库里还没有 flights 表 (新文件或内存库) 就在一个事务里执行本脚本，不需要手动导入
+-- 表、列、索引和示例数据与 MySQL 版保持一致，差异只在写法上：
+--   INT AUTO_INCREMENT PRIMARY KEY -> INTEGER PRIMARY KEY AUTOINCREMENT
+--   表内的 KEY / INDEX 写成单独的 CREATE INDEX，COMMENT 改成注释
+--   order_date 默认值用本地时间 (SQLite 的 CURRENT_TIMESTAMP 是 UTC)
+-- 修改 flight_system.sql 的表结构时请同步修改本文件
+-- (脚本按行尾的分号切分语句，字符串常量里不要出现分号)
+
+-- 1. 用户表
+CREATE TABLE IF NOT EXISTS users (
+    U_ID INTEGER PRIMARY KEY AUTOINCREMENT,
+    username VARCHAR(30) NOT NULL,
+    true_name VARCHAR(30) NULL,
+    nickname VARCHAR(30) NULL,
+    telephone VARCHAR(11) NOT NULL,
+    password VARCHAR(30) NOT NULL,
+    P_ID VARCHAR(18) NULL,
+    email VARCHAR(40) NULL,
+    photo VARCHAR(100) NULL,
+    balance DECIMAL(10, 2) DEFAULT 0.00,   -- 用户余额
+    CONSTRAINT unique_tele UNIQUE (telephone),
+    CONSTRAINT unique_pid UNIQUE (P_ID),
+    CONSTRAINT unique_username UNIQUE (username)
+);
+
+-- 2. 航班表
+CREATE TABLE IF NOT EXISTS flights (
+    ID INTEGER PRIMARY KEY AUTOINCREMENT,
+    flight_number VARCHAR(10) NOT NULL,
+    origin VARCHAR(50) NOT NULL,
+    destination VARCHAR(50) NOT NULL,
+    departure_time DATETIME NOT NULL,
+    landing_time DATETIME NOT NULL,
+    airline VARCHAR(20) NOT NULL,
+    aircraft_model VARCHAR(15) NOT NULL,
+    economy_seats INT NOT NULL,
+    economy_price INT NOT NULL,
+    business_seats INT NOT NULL,
+    business_price INT NOT NULL,
+    first_class_seats INT NOT NULL,
+    first_class_price INT NOT NULL,
+    CONSTRAINT unique_schedule UNIQUE (flight_number, departure_time)
+);
+
+-- 航班搜索按 航线 + 出发时间区间 查询 (departure_time >= ? AND departure_time < ?)
+CREATE INDEX IF NOT EXISTS idx_route_time ON flights (origin, destination, departure_time);
+
+-- 3. 订单表
+CREATE TABLE IF NOT EXISTS orders (
+    ID INTEGER PRIMARY KEY AUTOINCREMENT,
+    order_id VARCHAR(50) NULL,                -- 前端订单号
+    order_date DATETIME NOT NULL DEFAULT (datetime('now', 'localtime')),
+    user_id INT NOT NULL REFERENCES users(U_ID) ON DELETE CASCADE,
+    flight_id INT NOT NULL REFERENCES flights(ID) ON DELETE CASCADE,
+    seat_type INT NOT NULL,                   -- 0:经济舱, 1:商务舱, 2:头等舱
+    seat_number VARCHAR(50) NOT NULL,
+    status VARCHAR(20) DEFAULT '未支付',       -- 未支付, 已支付, 已取消, 已完成, 已退款
+    total_amount DECIMAL(10, 2) DEFAULT 0.00,
+    paid_amount DECIMAL(10, 2) DEFAULT 0.00,
+    payment_method VARCHAR(20) NULL,          -- balance-余额, wechat-微信, alipay-支付宝
+    -- 仍然占座的订单 = seat_number，已取消/已退款 = NULL (唯一索引允许多个 NULL)
+    active_seat VARCHAR(50) GENERATED ALWAYS AS (CASE WHEN status IN ('已取消', '已退款') THEN NULL ELSE seat_number END) STORED,
+    CONSTRAINT unique_order_id UNIQUE (order_id)
+);
+
+CREATE INDEX IF NOT EXISTS idx_flight_seat ON orders (flight_id, seat_number);
+-- 同一航班同一座位只能有一张占座中的订单，下单时靠它防止重复分配
+CREATE UNIQUE INDEX IF NOT EXISTS uniq_flight_active_seat ON orders (flight_id, active_seat);
+CREATE INDEX IF NOT EXISTS idx_status ON orders (status);
+CREATE INDEX IF NOT EXISTS idx_user ON orders (user_id);
+-- 订单历史按 (order_date, ID) 倒序做 keyset 翻页
+CREATE INDEX IF NOT EXISTS idx_user_date ON orders (user_id, order_date, ID);
+
+-- 余座计数：每个 (航班, 舱位) 拆成 8 行，合计为余座数；下单/取消/退款/删除订单时在同一个事务里随机挑一行加减，
+-- 同一舱位的并发下单不会在一行的行锁上排队
+-- seat_type 与 orders.seat_type 一致：0 经济舱, 1 商务舱, 2 头等舱
+CREATE TABLE IF NOT EXISTS flight_seat_inventory (
+    flight_id INT NOT NULL REFERENCES flights(ID) ON DELETE CASCADE,
+    seat_type INT NOT NULL,
+    shard INT NOT NULL,                       -- 分片号 0..7 (SeatCounters::kShards)
+    remaining INT NOT NULL,                   -- 这个分片还能卖的座位数
+    PRIMARY KEY (flight_id, seat_type, shard)
+) WITHOUT ROWID;
+
+-- 4. 城市代码映射表
+CREATE TABLE IF NOT EXISTS city_codes (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    city_name VARCHAR(50) NOT NULL,           -- 城市中文名
+    city_code VARCHAR(3) NOT NULL,            -- IATA三字码
+    pinyin VARCHAR(50) NULL,                  -- 城市拼音，方便后续做模糊搜索
+    CONSTRAINT unique_code UNIQUE (city_code)
+);
+
+-- ============================================
+-- 数据初始化
+-- ============================================
+
+-- 1. 插入示例用户数据
+INSERT INTO users (U_ID, username, true_name, nickname, telephone, password, P_ID, email, photo) VALUES
+(1, 'zhangsan', '张三', '法外狂徒', '13800138001', 'pass123', '110101199001011234', 'zs@example.com', NULL),
+(2, 'lisi', '李四', '朝阳群众', '13900139002', 'pass456', '110101199202025678', 'ls@example.com', NULL),
+(3, 'wangwu', '王五', '隔壁老王', '13700137003', 'pass789', '110101198803039012', 'ww@example.com', NULL),
+(4, 'admin', '管理员', '系统管理员', '13600136000', 'admin123', '110101199501011111', 'admin@example.com', NULL),
+(123, 'test123', '测试用户123', '测试昵称', '13800138123', 'test123', '110101199001011235', 'test123@example.com', NULL);
+
+-- 2. 插入城市代码数据
+INSERT INTO city_codes (city_name, city_code, pinyin) VALUES
+('北京', 'BJS', 'Beijing'),
+('上海', 'SHA', 'Shanghai'),
+('广州', 'CAN', 'Guangzhou'),
+('深圳', 'SZX', 'Shenzhen'),
+('珠海', 'ZUH', 'Zhuhai'),
+('成都', 'CTU', 'Chengdu'),
+('杭州', 'HGH', 'Hangzhou'),
+('昆明', 'KMG', 'Kunming'),
+('西安', 'XIY', 'Xian'),
+('重庆', 'CKG', 'Chongqing'),
+('武汉', 'WUH', 'Wuhan'),
+('南京', 'NKG', 'Nanjing'),
+('厦门', 'XMN', 'Xiamen'),
+('长沙', 'CSX', 'Changsha'),
+('海口', 'HAK', 'Haikou'),
+('三亚', 'SYX', 'Sanya'),
+('青岛', 'TAO', 'Qingdao'),
+('大连', 'DLC', 'Dalian'),
+('天津', 'TSN', 'Tianjin'),
+('郑州', 'CGO', 'Zhengzhou'),
+('沈阳', 'SHE', 'Shenyang'),
+('哈尔滨', 'HRB', 'Harbin'),
+('乌鲁木齐', 'URC', 'Urumqi'),
+('贵阳', 'KWE', 'Guiyang'),
+('南宁', 'NNG', 'Nanning'),
+('福州', 'FOC', 'Fuzhou'),
+('兰州', 'LHW', 'Lanzhou'),
+('太原', 'TYN', 'Taiyuan'),
+('长春', 'CGQ', 'Changchun'),
+('南昌', 'KHN', 'Nanchang'),
+('呼和浩特', 'HET', 'Hohhot'),
+('宁波', 'NGB', 'Ningbo'),
+('温州', 'WNZ', 'Wenzhou'),
+('合肥', 'HFE', 'Hefei'),
+('济南', 'TNA', 'Jinan'),
+('石家庄', 'SJW', 'Shijiazhuang'),
+('银川', 'INC', 'Yinchuan'),
+('西宁', 'XNN', 'Xining'),
+('拉萨', 'LXA', 'Lhasa'),
+('丽江', 'LJG', 'Lijiang'),
+('西双版纳', 'JHG', 'Xishuangbanna'),
+('桂林', 'KWL', 'Guilin'),
+('烟台', 'YNT', 'Yantai'),
+('泉州', 'JJN', 'Quanzhou'),
+('无锡', 'WUX', 'Wuxi'),
+('洛阳', 'LYA', 'Luoyang');
+
+-- 3. 插入航班数据
+INSERT INTO flights (flight_number, origin, destination, departure_time, landing_time, airline, aircraft_model, economy_seats, economy_price, business_seats, business_price, first_class_seats, first_class_price) VALUES
+('CA1001', '北京', '上海', '2025-12-01 08:00:00', '2025-12-01 10:15:00', '中国国航', 'Boeing 737', 150, 800, 20, 2000, 8, 4500),
+('MU2567', '上海', '东京', '2025-12-02 14:30:00', '2025-12-02 18:30:00', '东方航空', 'Airbus A330', 200, 2500, 30, 5000, 10, 12000),
+('CZ3888', '广州', '纽约', '2025-12-05 23:00:00', '2025-12-06 14:00:00', '南方航空', 'Boeing 787', 220, 6000, 40, 15000, 12, 35000),
+('CA1502', '北京', '广州', '2025-12-10 10:00:00', '2025-12-10 13:30:00', '中国国航', 'Airbus A320', 180, 1200, 25, 3000, 6, 6000);
+
+-- 4. 插入订单数据（包含测试订单）
+INSERT INTO orders (order_id, user_id, flight_id, seat_type, seat_number, status, total_amount, paid_amount, order_date) VALUES
+('ORD00001', 1, 1, 0, '12A', '已支付', 800.00, 800.00, '2025-11-26 10:00:00'),
+('ORD00002', 2, 1, 0, '12B', '已支付', 800.00, 800.00, '2025-11-26 10:05:00'),
+('ORD00003', 3, 2, 1, '01F', '已取消', 5000.00, 0.00, '2025-11-26 11:00:00'),
+('ORD00004', 1, 3, 2, '01A', '未支付', 35000.00, 0.00, '2025-11-27 09:00:00');
+
+-- 5. 余座计数不在这里初始化：服务器启动时给没有计数行的航班按 orders 补齐 (SeatCounters::backfill)
+
+-- ============================================
+-- 视图 (与 MySQL 版一致)
+-- ============================================
+
+-- 订单统计视图
+CREATE VIEW IF NOT EXISTS order_statistics AS
+SELECT
+    DATE(o.order_date) as order_date,
+    COUNT(*) as total_orders,
+    SUM(CASE WHEN o.status = '已支付' THEN 1 ELSE 0 END) as paid_orders,
+    SUM(CASE WHEN o.status = '已取消' THEN 1 ELSE 0 END) as cancelled_orders,
+    SUM(CASE WHEN o.status = '未支付' THEN 1 ELSE 0 END) as unpaid_orders,
+    SUM(COALESCE(o.total_amount, 0)) as total_revenue,
+    COUNT(DISTINCT o.user_id) as unique_users
+FROM orders o
+GROUP BY DATE(o.order_date);
+
+-- 航班上座率统计视图
+CREATE VIEW IF NOT EXISTS flight_occupancy_stats AS
+SELECT
+    f.ID as flight_id,
+    f.flight_number,
+    f.origin,
+    f.destination,
+    f.departure_time,
+    (f.economy_seats + f.business_seats + f.first_class_seats) as total_seats,
+    COUNT(o.ID) as booked_seats,
+    ROUND(COUNT(o.ID) * 100.0 / (f.economy_seats + f.business_seats + f.first_class_seats), 2) as occupancy_rate,
+    SUM(CASE WHEN o.seat_type = 0 THEN 1 ELSE 0 END) as economy_booked,
+    SUM(CASE WHEN o.seat_type = 1 THEN 1 ELSE 0 END) as business_booked,
+    SUM(CASE WHEN o.seat_type = 2 THEN 1 ELSE 0 END) as first_class_booked
+FROM flights f
+LEFT JOIN orders o ON f.ID = o.flight_id AND o.status IN ('已支付', '已完成')
+GROUP BY f.ID, f.flight_number, f.origin, f.destination, f.departure_time;
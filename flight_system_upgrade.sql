@@ -0,0 +1,39 @@
+-- ============================================
+-- 旧库升级 (MySQL)
+-- flight_system.sql 只用 CREATE TABLE IF NOT EXISTS 建表，已经部署的库不会拿到后来加的列和索引。
+-- 服务器启动时会检查下面的结构：缺少唯一键/列时拒绝启动，缺少只影响性能的索引时打印警告；
+-- 按顺序执行一次即可 (重复执行会报 "Duplicate column/key")。
+-- ============================================
+
+USE flight_system;
+
+-- 1. 座位唯一性：下单不再锁整个航班，靠 uniq_flight_active_seat 防止同一座位被两张订单占用
+-- 先确认现有数据里没有重复占座，否则加唯一键会失败 (有结果时需要先人工处理这些订单)：
+--   SELECT flight_id, seat_number, COUNT(*) FROM orders
+--   WHERE status NOT IN ('已取消', '已退款')
+--   GROUP BY flight_id, seat_number HAVING COUNT(*) > 1;
+ALTER TABLE orders
+    ADD COLUMN active_seat VARCHAR(50) AS (CASE WHEN status IN ('已取消', '已退款') THEN NULL ELSE seat_number END) STORED COMMENT '占座中的座位号',
+    ADD UNIQUE KEY uniq_flight_active_seat (flight_id, active_seat);
+
+-- 2. 余座计数按分片存储 (每个舱位 8 行)，并发下单不再抢同一行的行锁
+-- 计数是可以从 orders 重算的派生数据：直接重建空表，服务器启动时按 orders 补齐 (SeatCounters::backfill)
+-- SQLite 库同样执行这两条语句 (建表语句换成 flight_system.sqlite.sql 里的写法)
+DROP TABLE IF EXISTS flight_seat_inventory;
+CREATE TABLE flight_seat_inventory (
+    flight_id INT NOT NULL,
+    seat_type INT NOT NULL COMMENT '0:经济舱, 1:商务舱, 2:头等舱',
+    shard TINYINT NOT NULL COMMENT '分片号 0..7 (SeatCounters::kShards)',
+    remaining INT NOT NULL COMMENT '这个分片还能卖的座位数',
+    PRIMARY KEY (flight_id, seat_type, shard),
+    FOREIGN KEY (flight_id) REFERENCES flights(ID) ON DELETE CASCADE
+);
+
+-- 3. 航班搜索按 航线 + 出发时间区间 查询 (departure_time >= ? AND departure_time < ?)，没有这个索引时每次搜索都是全表扫描
+-- (flight_system.sql 在旧库上重跑会停在 DROP INDEX unique_flight_number，走不到这一句)
+-- SQLite：CREATE INDEX IF NOT EXISTS idx_route_time ON flights (origin, destination, departure_time);
+ALTER TABLE flights ADD INDEX idx_route_time (origin, destination, departure_time);
+
+-- 4. 订单历史按 (order_date, ID) 倒序做 keyset 翻页，没有这个索引时退化成 idx_user + filesort
+-- SQLite：CREATE INDEX IF NOT EXISTS idx_user_date ON orders (user_id, order_date, ID);
+ALTER TABLE orders ADD INDEX idx_user_date (user_id, order_date, ID);
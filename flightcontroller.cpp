@@ -1,11 +1,19 @@
 #include "FlightController.h"
 #include "DatabaseManager.h" // 一定要包含这个，用来连数据库
+#include "SeatInventory.h"
+#include "SeatCounters.h"
+#include "FlightQueries.h"
+#include "CityDirectory.h"
+#include "FlightStore.h"
+#include "SearchCache.h"
+#include "JsonStreamWriter.h"
 
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QSqlRecord>
 #include <QDebug>
 
 FlightController::FlightController(QObject *parent) : BaseController(parent)
@@ -15,45 +23,66 @@ FlightController::FlightController(QObject *parent) : BaseController(parent)
 // 核心：注册路由
 void FlightController::registerRoutes(QHttpServer *server)
 {
-    server->route("/api/search_flights", QHttpServerRequest::Method::Post,
+    routeConcurrent(server, "/api/search_flights", QHttpServerRequest::Method::Post,
                   [this](const QHttpServerRequest &req) {
                       return handleSearchFlights(req);
                   });
 
+    // 座位图
+    routeConcurrent(server, "/api/flight/seat_map", QHttpServerRequest::Method::Post,
+                  [this](const QHttpServerRequest &req) {
+                      return handleSeatMap(req);
+                  });
+
     // [新增] 管理员添加航班
-    server->route("/api/admin/add_flight", QHttpServerRequest::Method::Post,
+    routeConcurrent(server, "/api/admin/add_flight", QHttpServerRequest::Method::Post,
                   [this](const QHttpServerRequest &req) {
                       return handleAddFlight(req);
                   });
 
     // [新增] 管理员修改航班
-    server->route("/api/admin/update_flight", QHttpServerRequest::Method::Post,
+    routeConcurrent(server, "/api/admin/update_flight", QHttpServerRequest::Method::Post,
                   [this](const QHttpServerRequest &req) {
                       return handleUpdateFlight(req);
                   });
 
     // [新增] 管理员删除航班
-    server->route("/api/admin/delete_flight", QHttpServerRequest::Method::Post,
+    routeConcurrent(server, "/api/admin/delete_flight", QHttpServerRequest::Method::Post,
                   [this](const QHttpServerRequest &req) {
                       return handleDeleteFlight(req);
                   });
+
+    // [新增] 管理员重新加载城市字典
+    routeConcurrent(server, "/api/admin/reload_cities", QHttpServerRequest::Method::Post,
+                  [this](const QHttpServerRequest &req) {
+                      return handleReloadCities(req);
+                  });
 }
 
 QString FlightController::getCityNameByCode(const QString &code)
 {
-    QSqlDatabase db = DatabaseManager::getConnection();
-    if (!db.isOpen()) return code;
-
-    QSqlQuery query(db);
-    query.prepare("SELECT city_name FROM city_codes WHERE city_code = ?");
-    query.addBindValue(code);
+    // 启动时已把 city_codes 读进内存，这里只是一次哈希查找，不再访问数据库
+    // 如果查不到（可能是前端直接传了中文，或者代码错误），直接返回原字符串尝试去匹配
+    return CityDirectory::instance().cityName(code);
+}
 
-    if (query.exec() && query.next()) {
-        return query.value("city_name").toString();
+// ------------------------------------------------------------------
+// 管理员功能：重新加载城市字典 (修改 city_codes 表之后调用)
+// ------------------------------------------------------------------
+QHttpServerResponse FlightController::handleReloadCities(const QHttpServerRequest &request)
+{
+    Q_UNUSED(request);
+    PooledConnection db = DatabaseManager::getConnection();
+    if (!db.isOpen() || !CityDirectory::instance().reload(db)) {
+        QJsonObject err; err["status"] = "failed"; err["message"] = "城市字典加载失败";
+        return QHttpServerResponse(err, QHttpServerResponse::StatusCode::InternalServerError);
     }
 
-    // 如果查不到（可能是前端直接传了中文，或者代码错误），直接返回原字符串尝试去匹配
-    return code;
+    QJsonObject success;
+    success["status"] = "success";
+    success["message"] = "城市字典已重新加载";
+    success["count"] = CityDirectory::instance().size();
+    return QHttpServerResponse(success, QHttpServerResponse::StatusCode::Ok);
 }
 
 // ------------------------------------------------------------------
@@ -84,88 +113,240 @@ QHttpServerResponse FlightController::handleSearchFlights(const QHttpServerReque
 
     qDebug() << "Converted City:" << depCity << "->" << arrCity;
 
-    QSqlDatabase db = DatabaseManager::getConnection();
-    if (!db.isOpen()) {
-        return QHttpServerResponse(QHttpServerResponse::StatusCode::InternalServerError);
+    // 3. 组装过滤条件 (除航线和日期外都是可选的)
+    // 注意：flights 表里的 departure_time 是 DATETIME，这里按 [当天, 次日) 的区间比较，可以走 idx_route_time 索引
+    FlightFilter filter;
+    filter.origin = depCity;
+    filter.destination = arrCity;
+    // 以前的 DATE(departure_time) = ? 由 MySQL 解析日期，"2025-12-1"、"2025/12/01" 也能查到，这里同样接受
+    filter.date = QDate::fromString(dateStr, "yyyy-M-d");
+    if (!filter.date.isValid()) filter.date = QDate::fromString(dateStr, "yyyy/M/d");
+    if (!filter.date.isValid()) {
+        // 和以前一样：日期解析不了时查不到航班，返回空列表
+        QJsonObject ok;
+        ok["status"] = "success";
+        ok["data"] = QJsonArray();
+        ok["message"] = "成功返回航班";
+        return QHttpServerResponse(ok, QHttpServerResponse::StatusCode::Ok);
     }
 
-    // 3. 构造查询语句
-    // 注意：flights 表里的 departure_time 是 DATETIME，我们需要用 DATE() 函数截取日期部分进行比对
-    QSqlQuery query(db);
-    QString sql = "SELECT * FROM flights WHERE origin = ? AND destination = ? AND DATE(departure_time) = ?";
+    // 起飞时间窗口 "HH:mm"
+    if (reqObj.contains("departure_time_from")) {
+        QTime t = QTime::fromString(reqObj["departure_time_from"].toString(), "HH:mm");
+        if (t.isValid()) filter.departFromMinute = t.msecsSinceStartOfDay() / 60000;
+    }
+    if (reqObj.contains("departure_time_to")) {
+        QTime t = QTime::fromString(reqObj["departure_time_to"].toString(), "HH:mm");
+        if (t.isValid()) filter.departToMinute = t.msecsSinceStartOfDay() / 60000 + 1; // 包含结束那一分钟
+    }
 
-    query.prepare(sql);
-    query.addBindValue(depCity);
-    query.addBindValue(arrCity);
-    query.addBindValue(dateStr);
+    // 价格区间作用在所选舱位上，兼容 "公务/头等舱" 写法 (按商务舱算)
+    if (seatClass.contains("公务") || seatClass.contains("商务")) {
+        filter.priceCabin = 1;
+    } else if (seatClass.contains("头等")) {
+        filter.priceCabin = 2;
+    }
+    if (reqObj.contains("min_price")) filter.minPrice = reqObj["min_price"].toInt();
+    if (reqObj.contains("max_price")) filter.maxPrice = reqObj["max_price"].toInt(INT_MAX);
+    filter.airline = reqObj["airline"].toString();
+
+    // 4. 先查响应缓存：热门航线命中时只是一次哈希查找，直接把序列化好的字节写回
+    const QString routeDay = SearchCache::routeDayKey(depCity, arrCity, filter.date);
+    const QString cacheKey = QStringList{
+        routeDay, QString::number(filter.priceCabin),
+        QString::number(filter.departFromMinute), QString::number(filter.departToMinute),
+        QString::number(filter.minPrice), QString::number(filter.maxPrice), filter.airline
+    }.join('|');
+    QByteArray cached;
+    if (SearchCache::instance().lookup(cacheKey, &cached)) {
+        return QHttpServerResponse("application/json", cached, QHttpServerResponse::StatusCode::Ok);
+    }
+    const quint64 cacheGeneration = SearchCache::instance().generation();
 
-    if (!query.exec()) {
-        qWarning() << "Search SQL Error:" << query.lastError().text();
-        QJsonObject err;
-        err["status"] = "error";
-        err["message"] = "Database query error";
-        return QHttpServerResponse(err, QHttpServerResponse::StatusCode::InternalServerError);
+    // 5. 查询：内存航班库已加载时直接在内存里过滤，不访问数据库；否则退回 SQL 查询
+    QList<FlightRecord> flights;
+    if (FlightStore::instance().isLoaded()) {
+        flights = FlightStore::instance().search(filter);
+    } else {
+        // 结果会写进 SearchCache，而缓存只在主库提交之后失效；从副本读到的旧余座会一直留在缓存里，所以这里读主库
+        PooledConnection db = DatabaseManager::getConnection();
+        if (!db.isOpen()) {
+            return QHttpServerResponse(QHttpServerResponse::StatusCode::InternalServerError);
+        }
+
+        QSqlQuery &query = db.prepared(FlightQueries::searchByRouteDaySql());
+        FlightQueries::bindRouteDay(query, depCity, arrCity, filter.date);
+
+        if (!DatabaseManager::exec(query)) {
+            qWarning() << "Search SQL Error:" << query.lastError().text();
+            QJsonObject err;
+            err["status"] = "error";
+            err["message"] = "Database query error";
+            return QHttpServerResponse(err, QHttpServerResponse::StatusCode::InternalServerError);
+        }
+
+        // 列下标只解析一次，逐行按下标取值
+        const QSqlRecord rec = query.record();
+        const int cId = rec.indexOf("ID");
+        const int cFlightNumber = rec.indexOf("flight_number");
+        const int cAirline = rec.indexOf("airline");
+        const int cModel = rec.indexOf("aircraft_model");
+        const int cDeparture = rec.indexOf("departure_time");
+        const int cLanding = rec.indexOf("landing_time");
+        const int cSeats[3] = { rec.indexOf("economy_seats"), rec.indexOf("business_seats"),
+                                rec.indexOf("first_class_seats") };
+        const int cPrices[3] = { rec.indexOf("economy_price"), rec.indexOf("business_price"),
+                                 rec.indexOf("first_class_price") };
+        const int cRemaining[3] = { rec.indexOf("economy_remaining"), rec.indexOf("business_remaining"),
+                                    rec.indexOf("first_class_remaining") };
+
+        while (query.next()) {
+            FlightRecord flight;
+            flight.id = query.value(cId).toInt();
+            flight.flightNumber = query.value(cFlightNumber).toString();
+            flight.airline = query.value(cAirline).toString();
+            flight.aircraftModel = query.value(cModel).toString();
+            flight.departureTime = query.value(cDeparture).toDateTime();
+            flight.landingTime = query.value(cLanding).toDateTime();
+            for (int c = 0; c < 3; ++c) {
+                flight.seats[c] = query.value(cSeats[c]).toInt();
+                flight.prices[c] = query.value(cPrices[c]).toInt();
+                flight.remaining[c] = query.value(cRemaining[c]).toInt();
+            }
+            if (filter.matches(flight)) flights.append(flight);
+        }
     }
 
-    // 4. 组装返回结果
-    QJsonArray flightList;
-    while (query.next()) {
-        QJsonObject flight;
-
-        // --- 基础信息 ---
-        flight["id"] = query.value("ID").toInt();
-        flight["flight_number"] = query.value("flight_number").toString(); // 前端叫 flight_no
-        flight["airline"] = query.value("airline").toString(); //航空公司
-        flight["aircraft_model"] = query.value("aircraft_model").toString();    // 机型
-
-        // --- 时间处理 ---
-        // 数据库取出来可能是 "2025-12-01T08:00:00.000"
-        QDateTime depTime = query.value("departure_time").toDateTime();
-        QDateTime arrTime = query.value("landing_time").toDateTime();
-
-        // 前端只需要 "08:00" 这种格式显示在列表上
-        flight["departure_time"] = depTime.toString("HH:mm");
-        flight["landing_time"] = arrTime.toString("HH:mm");
-
-        // // --- 价格逻辑 ---
-        // // 根据前端选的舱位返回对应价格
-        // int price = 0;
-        // int seats = 0;
-        // 简单判断字符串包含关系，兼容 "公务/头等舱" 写法
-        // if (seatClass.contains("经济")) {
-        //     price = query.value("economy_price").toInt();
-        //     seats = query.value("economy_seats").toInt();
-        // } else if (seatClass.contains("公务") || seatClass.contains("商务")) {
-        //     price = query.value("business_price").toInt();
-        //     seats = query.value("business_seats").toInt();
-        // } else {
-        //     // 默认或者头等舱
-        //     price = query.value("first_class_price").toInt();
-        //     seats = query.value("first_class_seats").toInt();
-        // }
-
-        flight["economy_price"] = query.value("economy_price").toInt();
-        flight["economy_seats"] = query.value("economy_seats").toInt();
-        flight["business_price"] = query.value("business_price").toInt();
-        flight["business_seats"] = query.value("business_seats").toInt();
-        flight["first_class_price"] = query.value("first_class_price").toInt();
-        flight["first_class_seats"] = query.value("first_class_seats").toInt();
-
-        flightList.append(flight);
+    // 6. 组装返回结果：直接写成 JSON 文本，不再逐个构造 QJsonObject
+    JsonStreamWriter out(256 + flights.size() * 320);
+    QList<int> flightIds;
+    out.beginObject();
+    out.field("status", "success");
+    out.key("data");
+    out.beginArray();
+    for (const FlightRecord &f : flights) {
+        flightIds.append(f.id);
+        writeFlightRow(out, f);
     }
+    out.endArray();
+    // 原来列表为空时也返回 "成功返回航班"，保持不变
+    out.field("message", "成功返回航班");
+    out.endObject();
+
+    // 7. 序列化结果同时写进缓存
+    const QByteArray body = out.take();
+    SearchCache::instance().insert(cacheKey, routeDay, flightIds, body, cacheGeneration);
+    return QHttpServerResponse("application/json", body, QHttpServerResponse::StatusCode::Ok);
+}
+
 
-    // 5. 最终返回结构
-    QJsonObject responseObj;
-    responseObj["status"] = "success";
-    responseObj["data"] = flightList;
-    // 如果列表为空，message 可以提示一下，但 status 依然是 success
-    if (flightList.isEmpty()) {
-        responseObj["message"] = "未找到符合条件的航班";
+// ------------------------------------------------------------------
+// 座位图
+// 请求：{ "flight_id": 10 }
+// 返回：{ "status": "success", "flight_id": 10, "cabins": [
+//          { "seat_type": 0, "start_row": 6, "letters": "ABCDEF", "capacity": 150, "free": 120,
+//            "occupied": "base64..." }, ... ] }
+// occupied 解码后第 i 个座位 (从 start_row 排的 A 开始按行编号) 对应第 i/8 个字节的第 i%8 位 (低位在前)，1 = 已占用
+// 300 座的飞机整个位图不到 40 字节；航班位图已在内存里时不访问数据库
+// ------------------------------------------------------------------
+QHttpServerResponse FlightController::handleSeatMap(const QHttpServerRequest &request)
+{
+    QJsonObject jsonObj = QJsonDocument::fromJson(request.body()).object();
+    if (!jsonObj.contains("flight_id")) {
+        QJsonObject err; err["status"] = "failed"; err["message"] = "参数缺失";
+        return QHttpServerResponse(err, QHttpServerResponse::StatusCode::BadRequest);
+    }
+    const int flightId = jsonObj["flight_id"].toInt();
+
+    // 1. 座位配置：优先从内存航班库取
+    FlightCapacity capacity;
+    FlightRecord record;
+    const bool inStore = FlightStore::instance().find(flightId, &record);
+    if (inStore) {
+        capacity.economy = record.seats[0];
+        capacity.business = record.seats[1];
+        capacity.first = record.seats[2];
     }
-    responseObj["message"] = "成功返回航班";
-    return QHttpServerResponse(responseObj, QHttpServerResponse::StatusCode::Ok);
+
+    // 2. 位图已在内存里直接用；否则借连接从 orders 重建
+    QList<SeatInventory::CabinMap> cabins;
+    if (inStore) cabins = SeatInventory::instance().cachedSeatMap(flightId, capacity);
+    if (cabins.isEmpty()) {
+        PooledConnection db = DatabaseManager::getConnection();
+        if (!db.isOpen()) return QHttpServerResponse(QHttpServerResponse::StatusCode::InternalServerError);
+
+        if (!inStore) {
+            QSqlQuery query(db);
+            query.prepare("SELECT economy_seats, business_seats, first_class_seats FROM flights WHERE ID = ?");
+            query.addBindValue(flightId);
+            if (!DatabaseManager::exec(query) || !query.next()) {
+                QJsonObject err; err["status"] = "failed"; err["message"] = "航班不存在";
+                return QHttpServerResponse(err, QHttpServerResponse::StatusCode::NotFound);
+            }
+            capacity.economy = query.value(0).toInt();
+            capacity.business = query.value(1).toInt();
+            capacity.first = query.value(2).toInt();
+        }
+
+        bool ok = true;
+        cabins = SeatInventory::instance().seatMap(db, flightId, capacity, &ok);
+        if (!ok) {
+            QJsonObject err; err["status"] = "failed"; err["message"] = "系统繁忙 (Seat Error)";
+            return QHttpServerResponse(err, QHttpServerResponse::StatusCode::InternalServerError);
+        }
+    }
+
+    // 3. 组装返回
+    JsonStreamWriter out(512);
+    out.beginObject();
+    out.field("status", "success");
+    out.field("flight_id", flightId);
+    out.key("cabins");
+    out.beginArray();
+    for (int type = 0; type < cabins.size(); ++type) {
+        const SeatInventory::CabinMap &cabin = cabins.at(type);
+        out.beginObject();
+        out.field("seat_type", type);
+        out.field("start_row", cabin.layout.startRow);
+        out.field("letters", cabin.layout.letters);
+        out.field("capacity", cabin.layout.capacity);
+        out.field("free", cabin.freeCount);
+        out.field("occupied", QString::fromLatin1(cabin.occupied.toBase64()));
+        out.endObject();
+    }
+    out.endArray();
+    out.endObject();
+    return QHttpServerResponse("application/json", out.take(), QHttpServerResponse::StatusCode::Ok);
 }
 
+void FlightController::writeFlightRow(JsonStreamWriter &out, const FlightRecord &f)
+{
+    out.beginObject();
+
+    // --- 基础信息 ---
+    out.field("id", f.id);
+    out.field("flight_number", f.flightNumber); // 前端叫 flight_no
+    out.field("airline", f.airline); //航空公司
+    out.field("aircraft_model", f.aircraftModel);    // 机型
+
+    // 前端只需要 "08:00" 这种格式显示在列表上
+    out.field("departure_time", f.departureTime.toString("HH:mm"));
+    out.field("landing_time", f.landingTime.toString("HH:mm"));
+
+    out.field("economy_price", f.prices[0]);
+    out.field("economy_seats", f.seats[0]);
+    out.field("business_price", f.prices[1]);
+    out.field("business_seats", f.seats[1]);
+    out.field("first_class_price", f.prices[2]);
+    out.field("first_class_seats", f.seats[2]);
+
+    // *_seats 是座位总数，*_remaining 才是还能卖的余座
+    out.field("economy_remaining", f.remaining[0]);
+    out.field("business_remaining", f.remaining[1]);
+    out.field("first_class_remaining", f.remaining[2]);
+
+    out.endObject();
+}
 
 // ------------------------------------------------------------------
 // 管理员功能：添加航班
@@ -211,7 +392,7 @@ QHttpServerResponse FlightController::handleAddFlight(const QHttpServerRequest &
     int firSeats = jsonObj["first_class_seats"].toInt();
     int firPrice = jsonObj["first_class_price"].toInt();
 
-    QSqlDatabase db = DatabaseManager::getConnection();
+    PooledConnection db = DatabaseManager::getConnection();
     if (!db.isOpen()) return QHttpServerResponse(QHttpServerResponse::StatusCode::InternalServerError);
 
     QSqlQuery query(db);
@@ -243,18 +424,32 @@ QHttpServerResponse FlightController::handleAddFlight(const QHttpServerRequest &
     query.addBindValue(busSeats); query.addBindValue(busPrice);
     query.addBindValue(firSeats); query.addBindValue(firPrice);
 
-    if (!query.exec()) {
+    // 航班和它的余座计数一起提交：没有计数行的航班每张票都会被当成售罄
+    db.transaction();
+    if (!DatabaseManager::exec(query)) {
+        db.rollback();
         qWarning() << "Add Flight Error:" << query.lastError().text();
         QJsonObject err; err["status"] = "failed"; err["message"] = "添加航班失败: " + query.lastError().text();
         qInfo()<<"err: 添加航班失败";
         return QHttpServerResponse(err, QHttpServerResponse::StatusCode::InternalServerError);
     }
 
+    const int flightId = query.lastInsertId().toInt();
+    if (!SeatCounters::rebuild(db, flightId) || !db.commit()) {
+        db.rollback();
+        QJsonObject err; err["status"] = "failed"; err["message"] = "添加航班失败: 余座计数初始化失败";
+        return QHttpServerResponse(err, QHttpServerResponse::StatusCode::InternalServerError);
+    }
+
     QJsonObject success;
     success["status"] = "success";
+    // 再把新航班同步进内存航班库；该航线当天的搜索缓存作废
+    FlightStore::instance().refreshFlight(db, flightId);
+    SearchCache::instance().invalidateRouteDay(origin, dest, QDate::fromString(depDateStr, "yyyy-MM-dd"));
+
     success["message"] = "航班添加成功";
     qInfo()<<"航班添加成功";
-    success["flight_id"] = query.lastInsertId().toInt();
+    success["flight_id"] = flightId;
     return QHttpServerResponse(success, QHttpServerResponse::StatusCode::Ok);
 }
 
@@ -273,7 +468,6 @@ QHttpServerResponse FlightController::handleUpdateFlight(const QHttpServerReques
     }
 
     int flightId = jsonObj["flight_id"].toInt();
-    QSqlDatabase db = DatabaseManager::getConnection();
 
     QStringList setClauses;
     QVariantList boundValues;
@@ -337,11 +531,33 @@ QHttpServerResponse FlightController::handleUpdateFlight(const QHttpServerReques
     QString sql = "UPDATE flights SET " + setClauses.join(", ") + " WHERE ID = ?";
     boundValues << flightId;
 
+    // 连接在拼好 SQL 之后再借，避免上面查城市码时同时占用两条连接
+    PooledConnection db = DatabaseManager::getConnection();
     QSqlQuery query(db);
     query.prepare(sql);
     for (const QVariant &val : boundValues) query.addBindValue(val);
 
-    if (query.exec()) {
+    // 修改座位数时，余座计数按新的座位数重算，和修改放在同一个事务里，重算失败则整个修改回滚
+    const bool seatsChanged = jsonObj.contains("economy_seats") || jsonObj.contains("business_seats")
+                              || jsonObj.contains("first_class_seats");
+    db.transaction();
+    const bool ok = DatabaseManager::exec(query)
+                    && (!seatsChanged || SeatCounters::rebuild(db, flightId))
+                    && db.commit();
+    if (!ok) db.rollback();
+
+    if (ok) {
+        // 座位数可能变了，丢掉座位位图缓存，下次下单时重建
+        SeatInventory::instance().invalidateFlight(flightId);
+        // 重新读取这一行，同步到内存航班库
+        FlightRecord updated;
+        FlightStore::instance().refreshFlight(db, flightId, &updated);
+        // 作废含有该航班的搜索缓存；航班可能改到了别的航线/日期，新位置的缓存也要作废
+        SearchCache::instance().invalidateFlight(flightId);
+        if (updated.id != 0) {
+            SearchCache::instance().invalidateRouteDay(updated.origin, updated.destination,
+                                                       updated.departureTime.date());
+        }
         QJsonObject success; success["status"] = "success"; success["message"] = "更新成功";
         return QHttpServerResponse(success, QHttpServerResponse::StatusCode::Ok);
     } else {
@@ -355,7 +571,7 @@ QHttpServerResponse FlightController::handleDeleteFlight(const QHttpServerReques
     QJsonDocument jsonDoc = QJsonDocument::fromJson(request.body());
     QJsonObject jsonObj = jsonDoc.object();
 
-    QSqlDatabase db = DatabaseManager::getConnection();
+    PooledConnection db = DatabaseManager::getConnection();
     if (!db.isOpen()) {
         return QHttpServerResponse(QHttpServerResponse::StatusCode::InternalServerError);
     }
@@ -373,7 +589,7 @@ QHttpServerResponse FlightController::handleDeleteFlight(const QHttpServerReques
     }
 
     // 3. 执行删除
-    if (!query.exec()) {
+    if (!DatabaseManager::exec(query)) {
         qWarning() << "Delete Flight Error:" << query.lastError().text();
         QJsonObject err;
         err["status"] = "failed";
@@ -384,6 +600,9 @@ QHttpServerResponse FlightController::handleDeleteFlight(const QHttpServerReques
 
     // 4. 检查是否有数据被删除
     if (query.numRowsAffected() > 0) {
+        SeatInventory::instance().invalidateFlight(jsonObj["flight_id"].toInt());
+        FlightStore::instance().removeFlight(jsonObj["flight_id"].toInt());
+        SearchCache::instance().invalidateFlight(jsonObj["flight_id"].toInt());
         QJsonObject success;
         success["status"] = "success";
         success["message"] = "航班已删除";
@@ -5,6 +5,9 @@
 #include <QHttpServerResponse>
 #include <QHttpServerRequest>
 
+class JsonStreamWriter;
+struct FlightRecord;
+
 class FlightController : public BaseController
 {
     Q_OBJECT
@@ -12,6 +15,9 @@ public:
     explicit FlightController(QObject *parent = nullptr);
     void registerRoutes(QHttpServer *server) override;
 
+    // 搜索结果里的一个航班 (一个 JSON 对象)，每个结果行都会调用
+    static void writeFlightRow(JsonStreamWriter &out, const FlightRecord &f);
+
 private:
     QHttpServerResponse handleSearchFlights(const QHttpServerRequest &request);
     // [新增] 管理员：添加航班
@@ -21,7 +27,14 @@ private:
     QHttpServerResponse handleUpdateFlight(const QHttpServerRequest &request);
 
     QHttpServerResponse handleDeleteFlight(const QHttpServerRequest &request);
-    // 辅助函数 (代码转中文名)
+
+    // 座位图：各舱位布局 + 占用位图 (base64)
+    QHttpServerResponse handleSeatMap(const QHttpServerRequest &request);
+
+    // [新增] 管理员：重新加载城市字典
+    QHttpServerResponse handleReloadCities(const QHttpServerRequest &request);
+
+    // 辅助函数 (代码转中文名，查内存中的城市字典)
     QString getCityNameByCode(const QString &code);
 };
 
@@ -14,11 +14,11 @@ LoginController::LoginController(QObject *parent) : BaseController(parent)
 void LoginController::registerRoutes(QHttpServer *server)
 {
     // 路由：POST /api/login
-    server->route("/api/login", QHttpServerRequest::Method::Post,
+    routeConcurrent(server, "/api/login", QHttpServerRequest::Method::Post,
                   [this](const QHttpServerRequest &req) {
                       return handleLogin(req);
                   });
-    server->route("/api/register", QHttpServerRequest::Method::Post,
+    routeConcurrent(server, "/api/register", QHttpServerRequest::Method::Post,
                   [this](const QHttpServerRequest &req) {
                       return handleRegister(req);
                   });
@@ -50,7 +50,7 @@ QHttpServerResponse LoginController::handleLogin(const QHttpServerRequest &reque
     QString username = jsonObj["username"].toString();
     QString password = jsonObj["password"].toString();
 
-    QSqlDatabase database = DatabaseManager::getConnection();
+    PooledConnection database = DatabaseManager::getConnection();
     if (!database.isOpen()) {
         QJsonObject responseObj;
         responseObj["status"] = "failed";
@@ -58,12 +58,11 @@ QHttpServerResponse LoginController::handleLogin(const QHttpServerRequest &reque
         return QHttpServerResponse(responseObj,QHttpServerResponse::StatusCode::InternalServerError);
     }
 
-    QSqlQuery query(database);
-    query.prepare("SELECT U_ID, username, telephone, email, photo FROM users WHERE username = ? AND password = ?");
+    QSqlQuery &query = database.prepared("SELECT U_ID, username, telephone, email, photo FROM users WHERE username = ? AND password = ?");
     query.addBindValue(username);
     query.addBindValue(password);
 
-    if (!query.exec()) {
+    if (!DatabaseManager::exec(query)) {
         qWarning() << "Login SQL Error:" << query.lastError().text();
         QJsonObject responseObj;
         responseObj["status"] = "failed";
@@ -127,7 +126,7 @@ QHttpServerResponse LoginController::handleRegister(const QHttpServerRequest &re
     QString telephone = jsonObj["telephone"].toString();
 
     // 4. 获取数据库连接
-    QSqlDatabase database = DatabaseManager::getConnection();
+    PooledConnection database = DatabaseManager::getConnection();
     if (!database.isOpen()) {
         QJsonObject responseObj;
         responseObj["status"] = "failed";
@@ -143,7 +142,7 @@ QHttpServerResponse LoginController::handleRegister(const QHttpServerRequest &re
     query.addBindValue(password);
     query.addBindValue(telephone);
     query.addBindValue(email);
-    if (!query.exec()) {
+    if (!DatabaseManager::exec(query)) {
         // 记录具体的 SQL 错误
         qWarning() << "Register SQL Error:" << query.lastError().text();
 
@@ -151,7 +150,7 @@ QHttpServerResponse LoginController::handleRegister(const QHttpServerRequest &re
         responseObj["status"] = "failed";
 
         // 简单判断一下是否是重复键错误 (Duplicate entry)
-        if (query.lastError().text().contains("Duplicate")) {
+        if (DatabaseManager::isDuplicateKeyError(query.lastError())) {
             responseObj["message"] = "注册失败：用户名，电话号码或身份证号已被注册";
         } else {
             responseObj["message"] = "注册失败：数据库写入错误";
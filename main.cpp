@@ -1,6 +1,7 @@
 #include <QCoreApplication>
 #include <QHttpServer>
 #include <QDebug>
+#include <QTimer>
 #include "FlightController.h"
 #include "DatabaseManager.h"
 #include "logincontroller.h"
@@ -8,16 +9,109 @@
 #include"PaymentController.h"
 #include "aicontroller.h"
 #include "usercontroller.h"
+#include "QueryPlanCheck.h"
+#include "CityDirectory.h"
+#include "FlightStore.h"
+#include "OrderExpiryScheduler.h"
+#include "SeatCounters.h"
+#include "MonitorController.h"
 int main(int argc, char *argv[])
 {
     QCoreApplication a(argc, argv);
-    QSqlDatabase db = DatabaseManager::getConnection();
-    if (!db.isOpen()) {
+    // 预热连接池 (PoolMinSize 条连接)，顺便检查数据库配置是否可用
+    if (!AppConfig::exists() || !DatabaseManager::pool().warmUp()) {
         qCritical() << "无法连接数据库，服务器启动中止！";
         // 记得把 config.ini 放到 build 目录下的 debug 文件夹里！
         return -1;
     }
 
+    // 嵌入式 SQLite (Database/Driver=sqlite)：新库 / 内存库先按 flight_system.sqlite.sql 建表
+    {
+        PooledConnection db = DatabaseManager::getConnection();
+        if (!SqlDialect::ensureSchema(db)) {
+            qCritical() << "SQLite 建表失败，服务器启动中止！";
+            return -1;
+        }
+    }
+
+    // 旧库升级检查：乐观下单靠 orders 的 uniq_flight_active_seat 唯一键防止重复分配座位，
+    // 缺少这个键时两个并发下单可能拿到同一个座位，宁可不启动
+    {
+        PooledConnection db = DatabaseManager::getConnection();
+        if (!SqlDialect::hasIndex(db, "orders", "uniq_flight_active_seat")) {
+            qCritical() << "orders 表缺少唯一键 uniq_flight_active_seat，请先执行 flight_system_upgrade.sql，服务器启动中止！";
+            return -1;
+        }
+        // 余座计数改成了按分片存储，旧表结构 (每个舱位一行) 扣减语句会全部失败
+        if (!SqlDialect::hasColumn(db, "flight_seat_inventory", "shard")) {
+            qCritical() << "flight_seat_inventory 表缺少 shard 列，请先执行 flight_system_upgrade.sql，服务器启动中止！";
+            return -1;
+        }
+        // 只影响性能的索引缺少时不中止，但搜索会退化成全表扫描
+        if (!SqlDialect::hasIndex(db, "flights", "idx_route_time")) {
+            qWarning() << "flights 表缺少索引 idx_route_time，航班搜索会全表扫描，请执行 flight_system_upgrade.sql";
+        }
+        if (!SqlDialect::hasIndex(db, "orders", "idx_user_date")) {
+            qWarning() << "orders 表缺少索引 idx_user_date，订单列表翻页需要额外排序，请执行 flight_system_upgrade.sql";
+        }
+        // 没有余座计数的航班 (旧库、爬虫直接写入的航班) 按 orders 补齐，否则这些航班每张票都会被当成售罄
+        if (!SeatCounters::backfill(db)) {
+            qCritical() << "余座计数补齐失败，服务器启动中止！";
+            return -1;
+        }
+    }
+
+    // 查询计划回归检查：FlightBackendServer --check-query-plans
+    // 对热点查询跑 EXPLAIN，出现全表扫描时返回非 0，可以放进部署前的检查脚本
+    if (a.arguments().contains("--check-query-plans")) {
+        PooledConnection db = DatabaseManager::getConnection();
+        return QueryPlanCheck::run(db) ? 0 : 1;
+    }
+
+    // 城市字典一次性读进内存，之后城市码转换不再访问数据库
+    {
+        PooledConnection db = DatabaseManager::getConnection();
+        if (!CityDirectory::instance().reload(db)) {
+            qWarning() << "城市字典加载失败，城市码将按原样使用";
+        }
+    }
+
+    // 航班表读进内存列式库，航班搜索不再访问数据库 (FlightStore/Enabled=false 可关闭)
+    if (AppConfig::value("FlightStore/Enabled", true).toBool()) {
+        PooledConnection db = DatabaseManager::getConnection();
+        if (!FlightStore::instance().reload(db)) {
+            qWarning() << "航班内存库加载失败，航班搜索将直接查询数据库";
+        }
+    }
+
+    // 未支付订单超时自动取消 (Order/HoldMinutes)
+    {
+        PooledConnection db = DatabaseManager::getConnection();
+        if (!OrderExpiryScheduler::instance().start(db)) {
+            qWarning() << "未支付订单加载失败，超时取消只对新订单生效";
+        }
+    }
+
+    // 定期回收长时间空闲的数据库连接
+    QTimer poolEvictTimer;
+    QObject::connect(&poolEvictTimer, &QTimer::timeout, [] {
+        DatabaseManager::pool().evictIdle();
+        ReplicaRouter::instance().evictIdle();
+    });
+    poolEvictTimer.start(30 * 1000);
+
+    // 读写分离 ([Replica]/Hosts)：定期在工作线程里检查连通性和复制延迟
+    // 第一次检查也放到工作线程，连不上的副本不会拖住启动；检查通过之前读请求都走主库
+    QTimer replicaHealthTimer;
+    if (ReplicaRouter::instance().hasReplicas()) {
+        const auto checkReplicas = [] {
+            QtConcurrent::run(BaseController::workerPool(), [] { ReplicaRouter::instance().checkHealth(); });
+        };
+        checkReplicas();
+        QObject::connect(&replicaHealthTimer, &QTimer::timeout, checkReplicas);
+        replicaHealthTimer.start(qMax(1, AppConfig::value("Replica/HealthCheckSec", 5).toInt()) * 1000);
+    }
+
     // 创建 HTTP 服务器实例
     QHttpServer httpServer;
 
@@ -26,6 +120,11 @@ int main(int argc, char *argv[])
     FlightController *flightCtrl = new FlightController(&a);
     flightCtrl->registerRoutes(&httpServer);
 
+    // 运行指标：GET /metrics (Prometheus 抓取)
+    // 单段路径，必须在下面的 "/<arg>" 兜底路由之前注册
+    MonitorController *monitorCtrl = new MonitorController(&a);
+    monitorCtrl->registerRoutes(&httpServer);
+
     httpServer.route("/<arg>", [](const QHttpServerRequest &) {
         return QHttpServerResponse("Not Found", QHttpServerResponse::StatusCode::NotFound);
     });
@@ -47,6 +146,10 @@ int main(int argc, char *argv[])
     UserController* userCtrl = new UserController(&a);
     userCtrl->registerRoutes(&httpServer);
 
+    if (BaseController::workerPool()->maxThreadCount() > DatabaseManager::pool().options().maxSize) {
+        qWarning() << "工作线程数大于数据库连接池上限，部分请求将排队等待数据库连接";
+    }
+
     // 启动监听, 开始监听本机的全部ip地址和给定的端口
     const quint16 port = 8080;
     if (!httpServer.listen(QHostAddress::Any, port)) {
@@ -56,12 +159,16 @@ int main(int argc, char *argv[])
 
     qInfo() << "==========================================";
     qInfo() << "   服务器已启动 | 监听端口:" << port;
+    qInfo() << "   数据库连接池: min" << DatabaseManager::pool().options().minSize
+            << "/ max" << DatabaseManager::pool().options().maxSize;
+    qInfo() << "   工作线程数:" << BaseController::workerPool()->maxThreadCount();
     qInfo() << "   已加载模块: FlightController";
     qInfo() << "   已加载模块: LoginController";
     qInfo() << "   已加载模块: AIController";
     qInfo() << "   已加载模块: OrderController";
     qInfo() << "   已加载模块: UserController";
     qInfo() << "   已加载模块: PaymentController";
+    qInfo() << "   已加载模块: MonitorController (/metrics)";
     qInfo() << "==========================================";
 
     return a.exec();
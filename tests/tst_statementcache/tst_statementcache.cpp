@@ -0,0 +1,101 @@
+#include "StatementCache.h"
+
+#include <QtTest>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QVariant>
+
+class TestStatementCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void hitReturnsSameStatement();
+    void referenceSurvivesEviction();
+    void uncachedStatementLivesUntilRelease();
+
+private:
+    static int selectValue(QSqlQuery &query, int value);
+};
+
+static const char *kConnection = "tst_statementcache";
+
+void TestStatementCache::initTestCase()
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", kConnection);
+    db.setDatabaseName(":memory:");
+    QVERIFY(db.open());
+}
+
+void TestStatementCache::cleanupTestCase()
+{
+    QSqlDatabase::database(kConnection).close();
+    QSqlDatabase::removeDatabase(kConnection);
+}
+
+int TestStatementCache::selectValue(QSqlQuery &query, int value)
+{
+    query.addBindValue(value);
+    if (!query.exec() || !query.next()) return -1;
+    return query.value(0).toInt();
+}
+
+void TestStatementCache::hitReturnsSameStatement()
+{
+    StatementCache cache(4);
+    const QSqlDatabase db = QSqlDatabase::database(kConnection);
+
+    QSqlQuery &first = cache.acquire(db, "SELECT ? + 1");
+    QCOMPARE(selectValue(first, 1), 2);
+    QSqlQuery &second = cache.acquire(db, "SELECT ? + 1");
+    QCOMPARE(&second, &first);
+    QCOMPARE(selectValue(second, 41), 42);
+
+    quint64 hits, misses, evictions;
+    cache.takeCounters(&hits, &misses, &evictions);
+    QCOMPARE(hits, quint64(1));
+    QCOMPARE(misses, quint64(1));
+    QCOMPARE(evictions, quint64(0));
+}
+
+// 借用期间拿到的引用在语句被 LRU 淘汰之后仍然可用 (handleCreateOrder 的 insertQuery 就是这样用的)
+void TestStatementCache::referenceSurvivesEviction()
+{
+    StatementCache cache(1);
+    const QSqlDatabase db = QSqlDatabase::database(kConnection);
+
+    QSqlQuery &held = cache.acquire(db, "SELECT ? * 2");
+    QSqlQuery &other = cache.acquire(db, "SELECT ? * 3"); // 淘汰 held
+    QCOMPARE(selectValue(other, 2), 6);
+    QCOMPARE(selectValue(held, 21), 42);
+
+    // 同一条 SQL 再取一次是新的语句，被淘汰的那条仍然有效
+    QSqlQuery &again = cache.acquire(db, "SELECT ? * 2");
+    QVERIFY(&again != &held);
+    QCOMPARE(selectValue(held, 5), 10);
+    QCOMPARE(selectValue(again, 6), 12);
+
+    quint64 hits, misses, evictions;
+    cache.takeCounters(&hits, &misses, &evictions);
+    QCOMPARE(evictions, quint64(2));
+
+    cache.releaseTransient();
+    QCOMPARE(selectValue(again, 7), 14);
+}
+
+void TestStatementCache::uncachedStatementLivesUntilRelease()
+{
+    StatementCache cache(0);
+    const QSqlDatabase db = QSqlDatabase::database(kConnection);
+
+    QSqlQuery &a = cache.acquire(db, "SELECT ? - 1");
+    QSqlQuery &b = cache.acquire(db, "SELECT ? - 2");
+    QCOMPARE(selectValue(a, 10), 9);
+    QCOMPARE(selectValue(b, 10), 8);
+    cache.releaseTransient();
+}
+
+QTEST_GUILESS_MAIN(TestStatementCache)
+#include "tst_statementcache.moc"
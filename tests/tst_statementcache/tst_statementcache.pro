@@ -0,0 +1,24 @@
+# ------------------------------------------------
+# 文件: tests/tst_statementcache/tst_statementcache.pro
+# StatementCache 单元测试 (内存 SQLite，不需要 MySQL)
+#
+# 构建/运行: qmake tests/tst_statementcache && make && ./tst_statementcache
+# ------------------------------------------------
+
+QT += core sql testlib
+QT -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_statementcache
+
+SERVER_DIR = $$PWD/../..
+INCLUDEPATH += $$SERVER_DIR
+
+SOURCES += \
+    tst_statementcache.cpp \
+    $$SERVER_DIR/StatementCache.cpp
+
+HEADERS += \
+    $$SERVER_DIR/StatementCache.h
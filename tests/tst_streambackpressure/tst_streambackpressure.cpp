@@ -0,0 +1,147 @@
+#include "StreamBackpressure.h"
+
+#include <QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+#include <atomic>
+#include <memory>
+
+// 和 routeStreaming 一样：工作线程产出 chunk，投递到 socket 所在线程 (这里是测试主线程) 写出
+class TestStreamBackpressure : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void unreadSocketStopsProducer();
+    void drainedSocketReceivesEverything();
+    void disconnectStopsProducer();
+
+private:
+    struct Producer {
+        std::atomic<bool> done{false};
+        std::atomic<int> chunks{0};     // waitForRoom() 放行的 chunk 数
+    };
+    std::unique_ptr<QThread> startProducer(const std::shared_ptr<StreamBackpressure> &bp, int maxChunks,
+                                           const std::shared_ptr<Producer> &state);
+
+    QObject *m_owner = nullptr;         // 相当于 QHttpServer：服务端 socket 的父对象
+    QTcpServer *m_listener = nullptr;
+    QTcpSocket *m_client = nullptr;
+    QPointer<QTcpSocket> m_accepted;
+};
+
+static const qint64 kChunk = 64 * 1024;
+static const qint64 kMaxBuffered = 256 * 1024;
+
+void TestStreamBackpressure::init()
+{
+    m_owner = new QObject;
+    m_listener = new QTcpServer;
+    QVERIFY(m_listener->listen(QHostAddress::LocalHost));
+
+    m_client = new QTcpSocket;
+    m_client->setReadBufferSize(4096); // 不调用 read() 时，客户端最多从内核读走这么多
+    m_client->connectToHost(QHostAddress::LocalHost, m_listener->serverPort());
+    QVERIFY(m_client->waitForConnected(5000));
+    QVERIFY(m_listener->waitForNewConnection(5000));
+    m_accepted = m_listener->nextPendingConnection();
+    QVERIFY(m_accepted);
+    m_accepted->setParent(m_owner);
+}
+
+void TestStreamBackpressure::cleanup()
+{
+    delete m_client;
+    delete m_listener;
+    delete m_owner;
+    m_client = nullptr;
+    m_listener = nullptr;
+    m_owner = nullptr;
+}
+
+std::unique_ptr<QThread> TestStreamBackpressure::startProducer(const std::shared_ptr<StreamBackpressure> &bp,
+                                                               int maxChunks, const std::shared_ptr<Producer> &state)
+{
+    QPointer<QTcpSocket> socket = m_accepted;
+    std::unique_ptr<QThread> thread(QThread::create([this, bp, maxChunks, state, socket] {
+        const QByteArray chunk(kChunk, 'x');
+        for (int i = 0; i < maxChunks; ++i) {
+            if (!bp->waitForRoom(chunk.size())) break;
+            ++state->chunks;
+            QMetaObject::invokeMethod(m_owner, [bp, socket, chunk] {
+                if (socket) socket->write(chunk);
+                bp->written(chunk.size());
+            }, Qt::QueuedConnection);
+        }
+        state->done = true;
+    }));
+    thread->start();
+    return thread;
+}
+
+// 客户端一直不读：写缓冲到上限后工作线程停下来，等待预算用完就放弃并断开，而不是一直占着线程
+void TestStreamBackpressure::unreadSocketStopsProducer()
+{
+    auto bp = std::make_shared<StreamBackpressure>(kMaxBuffered, 300);
+    bp->attach(m_owner, m_client->localAddress(), m_client->localPort(), bp);
+
+    const int maxChunks = 100000; // 6 GB，不背压的话远远写不完
+    auto state = std::make_shared<Producer>();
+    std::unique_ptr<QThread> thread = startProducer(bp, maxChunks, state);
+    QTRY_VERIFY_WITH_TIMEOUT(state->done, 20000);
+    QVERIFY(thread->wait(5000));
+    QTest::qWait(50); // 写出已经投递的 chunk
+
+    QVERIFY(state->chunks < maxChunks);
+    QVERIFY(bp->blockedMs() >= 300);
+    // 最后一个 chunk 是在积压低于上限时放行的
+    QVERIFY(m_accepted->bytesToWrite() <= kMaxBuffered + kChunk);
+    QVERIFY(!bp->waitForRoom(kChunk));
+    QVERIFY(bp->abortIfStalled());
+    QCOMPARE(m_accepted->state(), QAbstractSocket::UnconnectedState);
+}
+
+// 客户端正常接收：每个 chunk 都发出去，不会被判定为卡住
+void TestStreamBackpressure::drainedSocketReceivesEverything()
+{
+    qint64 received = 0;
+    connect(m_client, &QTcpSocket::readyRead, this, [this, &received] { received += m_client->readAll().size(); });
+
+    auto bp = std::make_shared<StreamBackpressure>(kMaxBuffered, 5000);
+    bp->attach(m_owner, m_client->localAddress(), m_client->localPort(), bp);
+
+    const int chunks = 64;
+    auto state = std::make_shared<Producer>();
+    std::unique_ptr<QThread> thread = startProducer(bp, chunks, state);
+    QTRY_VERIFY_WITH_TIMEOUT(state->done, 10000);
+    QVERIFY(thread->wait(5000));
+
+    QCOMPARE(state->chunks.load(), chunks);
+    QTRY_COMPARE_WITH_TIMEOUT(received, chunks * kChunk, 10000);
+    QVERIFY(!bp->abortIfStalled());
+}
+
+// 客户端断开：工作线程马上停下来，不用等到等待预算用完
+void TestStreamBackpressure::disconnectStopsProducer()
+{
+    auto bp = std::make_shared<StreamBackpressure>(kMaxBuffered, 60000);
+    bp->attach(m_owner, m_client->localAddress(), m_client->localPort(), bp);
+
+    auto state = std::make_shared<Producer>();
+    std::unique_ptr<QThread> thread = startProducer(bp, 100000, state);
+    QTRY_VERIFY_WITH_TIMEOUT(m_accepted->bytesToWrite() >= kMaxBuffered, 20000);
+
+    QElapsedTimer timer;
+    timer.start();
+    m_client->abort();
+    QTRY_VERIFY_WITH_TIMEOUT(state->done, 10000);
+    QVERIFY(thread->wait(5000));
+    QVERIFY(timer.elapsed() < 10000);
+    QVERIFY(!bp->abortIfStalled());
+}
+
+QTEST_GUILESS_MAIN(TestStreamBackpressure)
+#include "tst_streambackpressure.moc"
@@ -0,0 +1,23 @@
+# ------------------------------------------------
+# 文件: tests/tst_streambackpressure/tst_streambackpressure.pro
+# StreamBackpressure 单元测试 (本机回环 TCP 连接，不需要数据库)
+#
+# 构建/运行: qmake tests/tst_streambackpressure && make && ./tst_streambackpressure
+# ------------------------------------------------
+
+QT += core network testlib
+QT -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_streambackpressure
+
+SERVER_DIR = $$PWD/../..
+INCLUDEPATH += $$SERVER_DIR
+
+SOURCES += \
+    tst_streambackpressure.cpp
+
+HEADERS += \
+    $$SERVER_DIR/StreamBackpressure.h
@@ -0,0 +1,114 @@
+#include "BenchRunner.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QTextStream>
+#include <algorithm>
+
+static volatile qint64 g_sink = 0;
+
+void benchSink(qint64 value)
+{
+    g_sink = g_sink + value;
+}
+
+void BenchRunner::add(const QString &name, const QString &description, std::function<void()> body)
+{
+    m_cases.push_back({name, description, std::move(body)});
+}
+
+void BenchRunner::list() const
+{
+    QTextStream out(stdout);
+    for (const Case &c : m_cases) out << QString("%1 %2\n").arg(c.name, -36).arg(c.description);
+}
+
+// 跑 iterations 次，返回总耗时 (纳秒)
+static qint64 timeIterations(const std::function<void()> &body, qint64 iterations)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (qint64 i = 0; i < iterations; ++i) body();
+    return timer.nsecsElapsed();
+}
+
+void BenchRunner::run()
+{
+    QTextStream out(stdout);
+    out << QString("%1 %2 %3 %4\n").arg("benchmark", -36).arg("ns/iter", 14).arg("min", 14).arg("iterations", 12);
+
+    const qint64 sampleNs = qint64(m_options.minTimeMs) * 1000000 / qMax(1, m_options.samples);
+    for (const Case &c : m_cases) {
+        if (!m_options.filter.match(c.name).hasMatch()) continue; // 空正则匹配所有用例
+
+        // 1. 预热 + 标定迭代次数
+        c.body();
+        qint64 iterations = 1;
+        while (timeIterations(c.body, iterations) < sampleNs && iterations < (qint64(1) << 40)) {
+            iterations *= 2;
+        }
+
+        // 2. 多轮取中位数
+        std::vector<double> perIter;
+        for (int s = 0; s < qMax(1, m_options.samples); ++s) {
+            perIter.push_back(double(timeIterations(c.body, iterations)) / double(iterations));
+        }
+        std::sort(perIter.begin(), perIter.end());
+
+        Result r;
+        r.name = c.name;
+        r.medianNs = perIter[perIter.size() / 2];
+        r.minNs = perIter.front();
+        r.iterations = iterations;
+        m_results.push_back(r);
+
+        out << QString("%1 %2 %3 %4\n").arg(c.name, -36).arg(r.medianNs, 14, 'f', 1)
+                   .arg(r.minNs, 14, 'f', 1).arg(r.iterations, 12);
+        out.flush();
+    }
+}
+
+bool BenchRunner::compare(const QJsonObject &baseline) const
+{
+    QTextStream out(stdout);
+    const QJsonObject base = baseline["benchmarks"].toObject();
+    if (baseline["build"].toString() != results()["build"].toString()) {
+        out << "注意：基线的构建类型 (" << baseline["build"].toString() << ") 与本次不同，比较结果仅供参考\n";
+    }
+
+    bool ok = true;
+    out << "\n" << QString("%1 %2 %3 %4\n").arg("benchmark", -36).arg("baseline", 14).arg("current", 14).arg("change", 10);
+    for (const Result &r : m_results) {
+        if (!base.contains(r.name)) {
+            out << QString("%1 %2 %3\n").arg(r.name, -36).arg("-", 14).arg(r.medianNs, 14, 'f', 1);
+            continue;
+        }
+        const double before = base[r.name].toObject()["ns_per_iter"].toDouble();
+        const double change = before > 0 ? (r.medianNs - before) / before : 0;
+        const bool regressed = change > m_options.tolerance;
+        ok = ok && !regressed;
+        out << QString("%1 %2 %3 %4%5\n").arg(r.name, -36).arg(before, 14, 'f', 1).arg(r.medianNs, 14, 'f', 1)
+                   .arg(QString::asprintf("%+.1f%%", change * 100), 10).arg(regressed ? "  REGRESSION" : "");
+    }
+    return ok;
+}
+
+QJsonObject BenchRunner::results() const
+{
+    QJsonObject benchmarks;
+    for (const Result &r : m_results) {
+        benchmarks[r.name] = QJsonObject{{"ns_per_iter", r.medianNs},
+                                         {"min_ns_per_iter", r.minNs},
+                                         {"iterations", r.iterations}};
+    }
+
+    QJsonObject root;
+#ifdef QT_DEBUG
+    root["build"] = "debug";
+#else
+    root["build"] = "release";
+#endif
+    root["qt_version"] = QString(qVersion());
+    root["benchmarks"] = benchmarks;
+    return root;
+}
@@ -0,0 +1,67 @@
+#ifndef BENCHRUNNER_H
+#define BENCHRUNNER_H
+
+#include <QString>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <functional>
+#include <vector>
+
+// 防止编译器把基准里算出来但没用到的结果优化掉
+void benchSink(qint64 value);
+
+// ==============================================================================
+//  微基准运行器
+//  每个用例是一个 "跑一次" 的函数 (准备工作在注册时做好，放在闭包里)：
+//  1. 先跑一次预热，再翻倍迭代次数，直到一轮耗时超过 minTimeMs / samples
+//  2. 按这个迭代次数跑 samples 轮，取每次迭代耗时的中位数
+//  3. 有基线时按中位数比较，变慢超过 tolerance 记为回归
+// ==============================================================================
+class BenchRunner {
+public:
+    struct Options {
+        int minTimeMs = 500;       // 每个用例的大致总耗时
+        int samples = 5;
+        double tolerance = 0.15;   // 允许比基线慢多少 (0.15 = 15%)
+        QRegularExpression filter;
+    };
+
+    explicit BenchRunner(const Options &options) : m_options(options) {}
+
+    void add(const QString &name, const QString &description, std::function<void()> body);
+
+    // 打印用例名和说明
+    void list() const;
+
+    // 跑所有匹配 filter 的用例，结果打印到标准输出
+    void run();
+
+    // 与基线比较 (基线里没有的用例只打印不比较)，有回归时返回 false
+    bool compare(const QJsonObject &baseline) const;
+
+    // 结果：{ "build": "release", "qt_version": "...", "benchmarks": { 名字: { ns_per_iter, min_ns_per_iter, iterations } } }
+    // 直接可以作为下一次的基线
+    QJsonObject results() const;
+
+private:
+    struct Case {
+        QString name;
+        QString description;
+        std::function<void()> body;
+    };
+    struct Result {
+        QString name;
+        double medianNs = 0;
+        double minNs = 0;
+        qint64 iterations = 0;
+    };
+
+    Options m_options;
+    std::vector<Case> m_cases;
+    std::vector<Result> m_results;
+};
+
+// 注册热点代码的基准用例 (HotPathBenchmarks.cpp)
+void registerHotPathBenchmarks(BenchRunner &runner);
+
+#endif // BENCHRUNNER_H
@@ -0,0 +1,215 @@
+#include "BenchRunner.h"
+
+#include "FlightStore.h"
+#include "JsonStreamWriter.h"
+#include "OrderController.h"
+#include "OrderQueries.h"
+#include "SeatInventory.h"
+#include "flightcontroller.h"
+#include "usercontroller.h"
+
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QRandomGenerator>
+#include <memory>
+
+// 典型的窄体机：头等 8、商务 24、经济 300
+static const FlightCapacity kCapacity{8, 24, 300};
+// 搜索结果 / 订单列表的行数
+static const int kRows = 500;
+
+// 占用率为 occupancy 的经济舱位图 (固定种子，每次运行一致)
+static std::shared_ptr<SeatBitmap> occupiedCabin(double occupancy)
+{
+    auto bitmap = std::make_shared<SeatBitmap>(CabinLayout::forCabin(kCapacity, 0));
+    QRandomGenerator random(20251201);
+    const int target = int(bitmap->layout().capacity * occupancy);
+    while (bitmap->layout().capacity - bitmap->freeCount() < target) {
+        bitmap->occupy(int(random.bounded(bitmap->layout().capacity)));
+    }
+    return bitmap;
+}
+
+static QList<FlightRecord> sampleFlights(int count)
+{
+    static const char *const airlines[] = {"中国国际航空", "中国东方航空", "中国南方航空", "海南航空"};
+    static const char *const models[] = {"空客A320", "波音737-800", "空客A330", "波音787"};
+
+    QList<FlightRecord> flights;
+    const QDateTime base(QDate(2025, 12, 1), QTime(6, 0));
+    for (int i = 0; i < count; ++i) {
+        FlightRecord f;
+        f.id = 10000 + i;
+        f.flightNumber = QString("MU%1").arg(5000 + i);
+        f.origin = "北京";
+        f.destination = "上海";
+        f.airline = airlines[i % 4];
+        f.aircraftModel = models[i % 4];
+        f.departureTime = base.addSecs(i * 97);
+        f.landingTime = f.departureTime.addSecs(2 * 3600 + 15 * 60);
+        f.seats[0] = 300; f.seats[1] = 24; f.seats[2] = 8;
+        f.prices[0] = 800 + i % 400; f.prices[1] = 2600; f.prices[2] = 5200;
+        f.remaining[0] = 300 - i % 290; f.remaining[1] = 24 - i % 20; f.remaining[2] = 8 - i % 8;
+        flights.append(f);
+    }
+    return flights;
+}
+
+static std::vector<OrderRecord> sampleOrders(int count)
+{
+    static const char *const statuses[] = {"已支付", "未支付", "已取消", "已退款"};
+    const CabinLayout layout = CabinLayout::forCabin(kCapacity, 0);
+    const QDateTime base(QDate(2025, 12, 1), QTime(6, 0));
+
+    std::vector<OrderRecord> rows;
+    for (int i = 0; i < count; ++i) {
+        OrderRecord r;
+        r.orderId = 900000 - i;
+        r.status = statuses[i % 4];
+        r.flightNumber = QString("CA%1").arg(1500 + i % 50);
+        r.airline = "中国国际航空";
+        r.origin = "北京";
+        r.destination = "广州";
+        r.aircraftModel = "空客A330";
+        r.departureTime = base.addDays(-i);
+        r.landingTime = base.addDays(-i).addSecs(3 * 3600);
+        r.seatNumber = layout.seatLabel(i % layout.capacity);
+        r.seatType = i % 3;
+        r.price = 1200 + i % 700;
+        rows.push_back(r);
+    }
+    return rows;
+}
+
+void registerHotPathBenchmarks(BenchRunner &runner)
+{
+    // ------------------------------------------------------------------
+    // 座位 (原 SeatAllocator::generateAllSeats / assignSeat)
+    // ------------------------------------------------------------------
+    runner.add("seat_cabin_build_300", "按布局生成 300 座经济舱位图 (首次加载航班时每个舱位一次)", [] {
+        SeatBitmap bitmap(CabinLayout::forCabin(kCapacity, 0));
+        benchSink(bitmap.freeCount());
+    });
+
+    auto cabin = occupiedCabin(0.95);
+    runner.add("seat_assign_any_95pct", "95% 占用的 300 座舱位里随机挑座 + 占用 + 释放", [cabin] {
+        const int index = cabin->pickFree(-1);
+        cabin->occupy(index);
+        cabin->release(index);
+        benchSink(index);
+    });
+
+    const int windowColumn = cabin->layout().columnOf("A");
+    runner.add("seat_assign_window_95pct", "95% 占用时按列偏好 (A 靠窗) 挑座", [cabin, windowColumn] {
+        benchSink(cabin->pickFree(windowColumn));
+    });
+
+    runner.add("seat_assign_block3_95pct", "95% 占用时给 3 人团体挑相邻座位", [cabin] {
+        benchSink(qint64(cabin->pickBlock(3).size()));
+    });
+
+    runner.add("seat_label_roundtrip_300", "300 个座位的 序号 -> 座位号 -> 序号", [] {
+        static const CabinLayout layout = CabinLayout::forCabin(kCapacity, 0);
+        qint64 sum = 0;
+        for (int i = 0; i < layout.capacity; ++i) sum += layout.seatIndex(layout.seatLabel(i));
+        benchSink(sum);
+    });
+
+    runner.add("seat_map_bytes_300", "座位图接口：300 座位图导出为字节串", [cabin] {
+        benchSink(cabin->toBytes().size());
+    });
+
+    // ------------------------------------------------------------------
+    // 结果序列化 (handleSearchFlights / handleGetOrders)
+    // ------------------------------------------------------------------
+    const QList<FlightRecord> flights = sampleFlights(kRows);
+    runner.add("search_rows_stream_500", "搜索结果 500 行，FlightController::writeFlightRow 流式写出", [flights] {
+        JsonStreamWriter out(256 + flights.size() * 320);
+        out.beginObject();
+        out.field("status", "success");
+        out.key("data");
+        out.beginArray();
+        for (const FlightRecord &f : flights) FlightController::writeFlightRow(out, f);
+        out.endArray();
+        out.field("message", "成功返回航班");
+        out.endObject();
+        benchSink(out.take().size());
+    });
+
+    // 参考：改成流式写出之前的做法，每行构造一个 QJsonObject 再整体序列化
+    runner.add("search_rows_qjson_500", "参考：同样 500 行用 QJsonObject/QJsonArray 构造再序列化", [flights] {
+        QJsonArray data;
+        for (const FlightRecord &f : flights) {
+            QJsonObject row;
+            row["id"] = f.id;
+            row["flight_number"] = f.flightNumber;
+            row["airline"] = f.airline;
+            row["aircraft_model"] = f.aircraftModel;
+            row["departure_time"] = f.departureTime.toString("HH:mm");
+            row["landing_time"] = f.landingTime.toString("HH:mm");
+            row["economy_price"] = f.prices[0];
+            row["economy_seats"] = f.seats[0];
+            row["business_price"] = f.prices[1];
+            row["business_seats"] = f.seats[1];
+            row["first_class_price"] = f.prices[2];
+            row["first_class_seats"] = f.seats[2];
+            row["economy_remaining"] = f.remaining[0];
+            row["business_remaining"] = f.remaining[1];
+            row["first_class_remaining"] = f.remaining[2];
+            data.append(row);
+        }
+        QJsonObject root{{"status", "success"}, {"data", data}, {"message", "成功返回航班"}};
+        benchSink(QJsonDocument(root).toJson(QJsonDocument::Compact).size());
+    });
+
+    const std::vector<OrderRecord> orders = sampleOrders(kRows);
+    runner.add("orders_rows_stream_500", "订单列表 500 行，OrderController::writeOrderRow 流式写出", [orders] {
+        JsonStreamWriter out;
+        out.beginObject();
+        out.field("status", "success");
+        out.key("data");
+        out.beginArray();
+        for (const OrderRecord &r : orders) OrderController::writeOrderRow(out, r);
+        out.endArray();
+        out.field("has_more", true);
+        out.field("next_cursor", "MjAyNS0xMi0wMVQwNjowMDowMHw5MDAwMDA");
+        out.endObject();
+        benchSink(out.take().size());
+    });
+
+    // ------------------------------------------------------------------
+    // 请求解析 (每个接口开头的 QJsonDocument::fromJson + 取字段)
+    // ------------------------------------------------------------------
+    const QByteArray searchBody = R"({"departure_city":"BJS","arrival_city":"SHA","departure_date":"2025-12-01",)"
+                                  R"("seat_class":"经济舱","departure_time_from":"08:00","departure_time_to":"20:00",)"
+                                  R"("min_price":300,"max_price":1500,"airline":""})";
+    runner.add("parse_search_request", "解析航班搜索请求体并取出各字段", [searchBody] {
+        const QJsonObject obj = QJsonDocument::fromJson(searchBody).object();
+        qint64 n = obj["departure_city"].toString().size() + obj["arrival_city"].toString().size()
+                 + obj["departure_date"].toString().size() + obj["seat_class"].toString().size()
+                 + obj["min_price"].toInt() + obj["max_price"].toInt();
+        benchSink(n);
+    });
+
+    const QByteArray orderBody = R"({"user_id":12345,"flight_id":678,"seat_type":0,"prefer_letter":"A"})";
+    runner.add("parse_create_order_request", "解析下单请求体并取出各字段", [orderBody] {
+        const QJsonObject obj = QJsonDocument::fromJson(orderBody).object();
+        benchSink(obj["user_id"].toInt() + obj["flight_id"].toInt() + obj["seat_type"].toInt()
+                  + obj["prefer_letter"].toString().size());
+    });
+
+    // ------------------------------------------------------------------
+    // 身份证号 -> 性别 (用户信息、实名认证)
+    // ------------------------------------------------------------------
+    QStringList idCards;
+    for (int i = 0; i < 1000; ++i) {
+        // 地区码 6 位 + 出生日期 8 位 + 顺序码 3 位 (第 17 位奇男偶女) + 校验位
+        idCards << QString("110105%1%2%3%4%5").arg(1960 + i % 40).arg(1 + i % 12, 2, 10, QChar('0'))
+                       .arg(1 + i % 28, 2, 10, QChar('0')).arg(i % 1000, 3, 10, QChar('0')).arg(i % 10);
+    }
+    runner.add("gender_from_id_card_1000", "1000 个身份证号解析性别", [idCards] {
+        qint64 male = 0;
+        for (const QString &id : idCards) male += UserController::getGenderFromIdCard(id) == QStringLiteral("男");
+        benchSink(male);
+    });
+}
@@ -0,0 +1,52 @@
+# ------------------------------------------------
+# 文件: tools/flight_bench/flight_bench.pro
+# 热点代码微基准：座位位图挑座、搜索/订单结果序列化、请求 JSON 解析、身份证性别解析
+# 直接编译服务器的源文件 (除 main.cpp)，测的就是线上的代码
+#
+# 构建: qmake tools/flight_bench CONFIG+=release && make   (debug 构建的数字没有参考意义)
+# 用法: flight_bench                                   # 跑全部，打印每次迭代耗时
+#       flight_bench --output baseline.json            # 记录基线
+#       flight_bench --baseline baseline.json          # 与基线比较，变慢超过 --tolerance (默认 15%) 时退出码为 1
+#       flight_bench --filter seat_                    # 只跑名字匹配的用例 (正则)
+# 基线文件放在 tools/flight_bench/baseline.json，在固定的压测机上用 release 构建记录：
+#       make bench_baseline                            # 记录/更新基线 (改动热点代码之前先跑一次)
+#       make bench_check                               # 与基线比较，有回归时 make 失败；
+#                                                      # 还没有 baseline.json 时打印提示并跳过 (不算失败)
+# 仓库里不带 baseline.json：耗时取决于机器和构建，别人的基线拿来比较没有意义，需要在自己的压测机上记录
+#
+# 没有用 QtTest 的 QBENCHMARK (tests/ 下的单元测试用 QtTest)：QBENCHMARK 只打印本次的结果，
+# 没有 "记录基线 / 超过容差就失败" 的比较，而这里要的就是这个门禁；
+# 另外这个工具编译了服务器的全部源文件，单元测试只编译被测的那一个文件，两者分开构建更清楚
+# ------------------------------------------------
+
+QT += core network sql httpserver concurrent
+QT -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = flight_bench
+
+SERVER_DIR = $$PWD/../..
+INCLUDEPATH += $$SERVER_DIR
+
+SOURCES += \
+    BenchRunner.cpp \
+    HotPathBenchmarks.cpp \
+    main.cpp
+
+HEADERS += \
+    BenchRunner.h
+
+# 服务器源文件 (入口 main.cpp 除外)
+SOURCES += $$files($$SERVER_DIR/*.cpp)
+SOURCES -= $$SERVER_DIR/main.cpp
+HEADERS += $$files($$SERVER_DIR/*.h)
+
+# 记录基线 / 与基线比较 (见文件开头的说明)
+bench_baseline.depends = $(TARGET)
+bench_baseline.commands = ./$(TARGET) --output $$PWD/baseline.json
+bench_check.depends = $(TARGET)
+bench_check.commands = @if [ -f $$PWD/baseline.json ]; then ./$(TARGET) --baseline $$PWD/baseline.json; \
+    else echo 跳过基线比较: 没有 $$PWD/baseline.json, 先在压测机上运行 make bench_baseline 记录基线; fi
+QMAKE_EXTRA_TARGETS += bench_baseline bench_check
@@ -0,0 +1,77 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QFile>
+#include <QTextStream>
+
+#include "BenchRunner.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("flight_bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("航班预订后端热点代码微基准");
+    parser.addHelpOption();
+
+    const QCommandLineOption filterOpt("filter", "只跑名字匹配该正则的用例", "regex");
+    const QCommandLineOption minTimeOpt("min-time", "每个用例大致运行多久 (毫秒)", "ms", "500");
+    const QCommandLineOption samplesOpt("samples", "每个用例跑几轮取中位数", "n", "5");
+    const QCommandLineOption baselineOpt("baseline", "与基线文件比较", "file");
+    const QCommandLineOption toleranceOpt("tolerance", "比基线慢多少算回归 (0.15 = 15%)", "ratio", "0.15");
+    const QCommandLineOption outputOpt("output", "结果写入文件 (可作为之后的基线)", "file");
+    const QCommandLineOption listOpt("list", "列出所有用例");
+    parser.addOptions({filterOpt, minTimeOpt, samplesOpt, baselineOpt, toleranceOpt, outputOpt, listOpt});
+    parser.process(app);
+
+    BenchRunner::Options options;
+    options.minTimeMs = qMax(1, parser.value(minTimeOpt).toInt());
+    options.samples = qMax(1, parser.value(samplesOpt).toInt());
+    options.tolerance = parser.value(toleranceOpt).toDouble();
+    options.filter = QRegularExpression(parser.value(filterOpt));
+    if (!options.filter.isValid()) {
+        QTextStream(stderr) << "无效的正则: " << parser.value(filterOpt) << "\n";
+        return 1;
+    }
+
+    BenchRunner runner(options);
+    registerHotPathBenchmarks(runner);
+
+    if (parser.isSet(listOpt)) {
+        runner.list();
+        return 0;
+    }
+
+#ifdef QT_DEBUG
+    QTextStream(stderr) << "注意：这是 debug 构建，耗时没有参考意义 (qmake CONFIG+=release)\n";
+#endif
+
+    // 先读基线，文件有问题就不用白跑一遍
+    QJsonObject baseline;
+    if (parser.isSet(baselineOpt)) {
+        QFile file(parser.value(baselineOpt));
+        if (!file.open(QIODevice::ReadOnly)) {
+            QTextStream(stderr) << "无法读取基线文件: " << file.fileName() << "\n";
+            return 1;
+        }
+        baseline = QJsonDocument::fromJson(file.readAll()).object();
+    }
+
+    runner.run();
+
+    if (parser.isSet(outputOpt)) {
+        QFile file(parser.value(outputOpt));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            QTextStream(stderr) << "无法写入结果文件: " << file.fileName() << "\n";
+            return 1;
+        }
+        file.write(QJsonDocument(runner.results()).toJson(QJsonDocument::Indented));
+    }
+
+    if (parser.isSet(baselineOpt) && !runner.compare(baseline)) {
+        QTextStream(stderr) << "有用例比基线慢了 " << options.tolerance * 100 << "% 以上\n";
+        return 1;
+    }
+    return 0;
+}
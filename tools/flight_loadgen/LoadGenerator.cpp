@@ -0,0 +1,395 @@
+#include "LoadGenerator.h"
+
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDate>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+
+// 操作名 -> 接口路径 (报告里按操作名分组)
+static const QMap<QString, QString> &operationPaths()
+{
+    static const QMap<QString, QString> paths = {
+        {"search", "/api/search_flights"},
+        {"create_order", "/api/create_order"},
+        {"payment", "/api/payment"},
+        {"get_orders", "/api/get_orders"},
+        {"user_info", "/api/user/info"},
+    };
+    return paths;
+}
+
+// 压测航班用到的城市 (flight_system.sql 里的三字码)
+static const char *const kCities[] = {"BJS", "SHA", "CAN", "SZX", "CTU", "HGH"};
+static const int kCityCount = int(sizeof(kCities) / sizeof(kCities[0]));
+
+// 未支付订单队列上限 (payment 比例很低时避免无限增长)
+static const size_t kMaxUnpaidOrders = 10000;
+
+QStringList LoadGenerator::operations()
+{
+    return operationPaths().keys();
+}
+
+LoadGenerator::LoadGenerator(const LoadOptions &options, QObject *parent)
+    : QObject(parent), m_options(options), m_random(QRandomGenerator::securelySeeded())
+{
+    // 每个 manager 对同一主机最多 6 条连接
+    const int managers = qMax(1, (m_options.concurrency + 5) / 6);
+    for (int i = 0; i < managers; ++i) m_managers.push_back(new QNetworkAccessManager(this));
+
+    for (auto it = m_options.mix.constBegin(); it != m_options.mix.constEnd(); ++it) {
+        if (it.value() <= 0) continue;
+        m_totalWeight += it.value();
+        m_operations << it.key();
+        m_cumulativeWeights << m_totalWeight;
+    }
+    for (const QString &op : operationPaths().keys()) m_stats[op].path = operationPaths().value(op);
+
+    m_rateTimer.setInterval(1);
+    connect(&m_rateTimer, &QTimer::timeout, this, &LoadGenerator::tickOpenLoop);
+}
+
+void LoadGenerator::start()
+{
+    m_clock.start();
+    if (m_totalWeight <= 0) {
+        emit failed("请求比例 (--mix) 为空");
+        return;
+    }
+    QTextStream(stderr) << "准备压测数据: " << m_options.users << " 个用户, " << m_options.flights << " 个航班\n";
+    seedUsers(0);
+}
+
+// ==============================================================================
+//  准备数据
+// ==============================================================================
+void LoadGenerator::seedUsers(int index)
+{
+    if (index >= m_options.users) {
+        seedFlights(0);
+        return;
+    }
+
+    const QString username = QString("lg_user_%1").arg(index);
+    const QString password = "loadgen";
+
+    // 充值后进入下一个用户
+    auto recharge = [this, index](int uid) {
+        m_userIds << uid;
+        post("/api/user/recharge", QJsonObject{{"uid", uid}, {"amount", 10000000}}, nowUs(), QString(),
+             [this, index](int, const QJsonObject &) { seedUsers(index + 1); });
+    };
+
+    QJsonObject registerBody{{"username", username},
+                             {"password", password},
+                             {"telephone", QString("199%1").arg(index, 8, 10, QChar('0'))},
+                             {"email", username + "@loadgen.test"}};
+    post("/api/register", registerBody, nowUs(), QString(),
+         [this, username, password, recharge](int status, const QJsonObject &body) {
+             if (status == 200 && body["status"].toString() == "success") {
+                 recharge(body["new_user_id"].toInt());
+                 return;
+             }
+             // 上次压测已经注册过，登录拿 ID
+             post("/api/login", QJsonObject{{"username", username}, {"password", password}}, nowUs(), QString(),
+                  [this, username, recharge](int status, const QJsonObject &body) {
+                      if (status != 200) {
+                          emit failed("压测用户 " + username + " 注册和登录都失败了，请检查服务器是否启动");
+                          return;
+                      }
+                      recharge(body["user"].toObject()["id"].toInt());
+                  });
+         });
+}
+
+void LoadGenerator::seedFlights(int index)
+{
+    if (index >= m_options.flights) {
+        beginRun();
+        return;
+    }
+
+    // 航线在几个城市之间轮换，日期分布在未来 7 天
+    const int pairs = kCityCount * (kCityCount - 1);
+    const int pair = index % pairs;
+    const int from = pair / (kCityCount - 1);
+    int to = pair % (kCityCount - 1);
+    if (to >= from) ++to;
+
+    Flight flight;
+    flight.originCode = kCities[from];
+    flight.destinationCode = kCities[to];
+    flight.date = QDate::currentDate().addDays(1 + (index / pairs) % 7).toString("yyyy-MM-dd");
+
+    // 航班号和起飞时间只由序号决定：同一天重复运行时撞上 unique_schedule (flight_number, departure_time)，
+    // 说明上次已经建过这个航班，直接沿用
+    const QString flightNumber = QString("LG%1").arg(index, 4, 10, QChar('0'));
+    const int hour = 6 + index % 14;
+    QJsonObject body{{"flight_number", flightNumber},
+                     {"origin", flight.originCode},
+                     {"destination", flight.destinationCode},
+                     {"departure_date", flight.date},
+                     {"landing_date", flight.date},
+                     {"departure_time", QString("%1:00").arg(hour, 2, 10, QChar('0'))},
+                     {"landing_time", QString("%1:30").arg(hour + 2, 2, 10, QChar('0'))},
+                     {"airline", "压测航空"},
+                     {"aircraft_model", "A321"},
+                     {"economy_seats", 300}, {"economy_price", 600 + int(m_random.bounded(900))},
+                     {"business_seats", 24}, {"business_price", 2500},
+                     {"first_class_seats", 8}, {"first_class_price", 5000}};
+
+    post("/api/admin/add_flight", body, nowUs(), QString(),
+         [this, index, flight, flightNumber](int status, const QJsonObject &resp) {
+             if (status == 200) {
+                 Flight added = flight;
+                 added.id = resp["flight_id"].toInt();
+                 m_flights << added;
+                 seedFlights(index + 1);
+                 return;
+             }
+             reuseSeededFlight(index, flight, flightNumber, resp["message"].toString());
+         });
+}
+
+void LoadGenerator::reuseSeededFlight(int index, const Flight &flight, const QString &flightNumber,
+                                      const QString &addError)
+{
+    // 新增失败时按航线+日期搜一次，找到同号的压测航班就当作已经建好 (上次运行留下的)
+    // 注意：沿用的航班上次卖出的座位不会退回，余座不够时下单会返回售罄
+    post("/api/search_flights",
+         QJsonObject{{"departure_city", flight.originCode}, {"arrival_city", flight.destinationCode},
+                     {"departure_date", flight.date}},
+         nowUs(), QString(), [this, index, flight, flightNumber, addError](int status, const QJsonObject &body) {
+             const QJsonArray rows = status == 200 ? body["data"].toArray() : QJsonArray();
+             for (const QJsonValue &row : rows) {
+                 if (row["flight_number"].toString() != flightNumber) continue;
+                 Flight existing = flight;
+                 existing.id = row["id"].toInt();
+                 m_flights << existing;
+                 seedFlights(index + 1);
+                 return;
+             }
+             emit failed("新增压测航班失败: " + addError);
+         });
+}
+
+void LoadGenerator::beginRun()
+{
+    if (m_userIds.isEmpty() || m_flights.isEmpty()) {
+        emit failed("没有可用的压测用户或航班");
+        return;
+    }
+
+    const qint64 now = nowUs();
+    m_measureStartUs = now + qint64(m_options.warmupSec) * 1000000;
+    m_endUs = m_measureStartUs + qint64(m_options.durationSec) * 1000000;
+    QTextStream(stderr) << "开始压测: 预热 " << m_options.warmupSec << " 秒, 统计 " << m_options.durationSec << " 秒\n";
+
+    if (m_options.rate > 0) {
+        m_nextScheduledUs = now;
+        m_rateTimer.start();
+    } else {
+        for (int i = 0; i < m_options.concurrency; ++i) runOne(now);
+    }
+}
+
+// ==============================================================================
+//  压测
+// ==============================================================================
+QString LoadGenerator::pickOperation()
+{
+    const int r = int(m_random.bounded(m_totalWeight));
+    for (int i = 0; i < m_cumulativeWeights.size(); ++i) {
+        if (r < m_cumulativeWeights[i]) return m_operations[i];
+    }
+    return m_operations.last();
+}
+
+void LoadGenerator::tickOpenLoop()
+{
+    const qint64 now = nowUs();
+    if (now >= m_endUs) {
+        m_rateTimer.stop();
+        finish();
+        return;
+    }
+
+    // 补发所有已经到点的请求；在途数达到上限时计为丢弃 (说明压测端或服务端已经饱和)
+    const qint64 intervalUs = qMax<qint64>(1, qint64(1e6 / m_options.rate));
+    while (m_nextScheduledUs <= now) {
+        if (m_inFlight < m_options.concurrency) {
+            runOne(m_nextScheduledUs);
+        } else if (m_nextScheduledUs >= m_measureStartUs) {
+            m_stats["dropped"].statusCounts["dropped"] += 1;
+        }
+        m_nextScheduledUs += intervalUs;
+    }
+}
+
+void LoadGenerator::runOne(qint64 scheduledUs)
+{
+    if (m_stopping) return;
+    if (m_options.rate <= 0 && nowUs() >= m_endUs) {
+        finish();
+        return;
+    }
+
+    // 闭环模式下每个请求结束就发下一个
+    auto next = [this]() {
+        --m_inFlight;
+        if (m_options.rate <= 0) {
+            runOne(nowUs());
+        } else if (m_stopping) {
+            finish();
+        }
+    };
+
+    QString op = pickOperation();
+    if (op == "payment" && m_unpaidOrders.empty()) op = "create_order"; // 还没有可以支付的订单
+
+    const int userId = m_userIds[int(m_random.bounded(m_userIds.size()))];
+    const Flight &flight = m_flights[int(m_random.bounded(m_flights.size()))];
+    ++m_inFlight;
+
+    if (op == "search") {
+        post(operationPaths().value(op),
+             QJsonObject{{"departure_city", flight.originCode}, {"arrival_city", flight.destinationCode},
+                         {"departure_date", flight.date}, {"seat_class", "经济舱"}},
+             scheduledUs, op, [next](int, const QJsonObject &) { next(); });
+    } else if (op == "create_order") {
+        post(operationPaths().value(op),
+             QJsonObject{{"user_id", userId}, {"flight_id", flight.id}, {"seat_type", 0}},
+             scheduledUs, op, [this, next, userId](int status, const QJsonObject &body) {
+                 if (status == 200 && body["status"].toString() == "success" && m_unpaidOrders.size() < kMaxUnpaidOrders) {
+                     m_unpaidOrders.push_back({body["order_id"].toInt(), userId});
+                 }
+                 next();
+             });
+    } else if (op == "payment") {
+        const PendingOrder order = m_unpaidOrders.front();
+        m_unpaidOrders.pop_front();
+        post(operationPaths().value(op),
+             QJsonObject{{"user_id", order.userId}, {"order_id", order.orderId}},
+             scheduledUs, op, [next](int, const QJsonObject &) { next(); });
+    } else if (op == "get_orders") {
+        post(operationPaths().value(op), QJsonObject{{"user_id", userId}, {"limit", 20}},
+             scheduledUs, op, [next](int, const QJsonObject &) { next(); });
+    } else {
+        post(operationPaths().value("user_info"), QJsonObject{{"uid", QString::number(userId)}},
+             scheduledUs, "user_info", [next](int, const QJsonObject &) { next(); });
+    }
+}
+
+void LoadGenerator::post(const QString &path, const QJsonObject &body, qint64 startUs, const QString &record,
+                         const Callback &done)
+{
+    QUrl url = m_options.baseUrl;
+    url.setPath(path);
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+
+    QNetworkAccessManager *manager = m_managers[m_nextManager];
+    m_nextManager = (m_nextManager + 1) % m_managers.size();
+
+    QNetworkReply *reply = manager->post(request, QJsonDocument(body).toJson(QJsonDocument::Compact));
+    connect(reply, &QNetworkReply::finished, this, [this, reply, startUs, record, done]() {
+        const qint64 latencyUs = nowUs() - startUs;
+        const QVariant statusAttr = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+        const int status = statusAttr.isValid() ? statusAttr.toInt() : 0;
+        const QJsonObject responseBody = QJsonDocument::fromJson(reply->readAll()).object();
+        reply->deleteLater();
+
+        // 只统计计划在预热结束之后发出的请求
+        if (!record.isEmpty() && startUs >= m_measureStartUs && startUs < m_endUs) {
+            RouteStats &stats = m_stats[record];
+            stats.latenciesUs.push_back(latencyUs);
+            const QString key = status == 0 ? QStringLiteral("network_error") : QString("%1xx").arg(status / 100);
+            stats.statusCounts[key] += 1;
+            if (status == 0 || status >= 500) ++stats.errors;
+        }
+        done(status, responseBody);
+    });
+}
+
+void LoadGenerator::finish()
+{
+    m_stopping = true;
+    if (m_inFlight > 0) return; // 等在途请求都回来
+
+    if (m_reported) return;
+    m_reported = true;
+    emit finished(buildReport());
+}
+
+// 最近秩法取分位数 (输入已排序)
+static double percentileMs(const std::vector<qint64> &sorted, double p)
+{
+    if (sorted.empty()) return 0;
+    const size_t rank = size_t(std::ceil(p * double(sorted.size())));
+    return sorted[qBound<size_t>(1, rank, sorted.size()) - 1] / 1000.0;
+}
+
+QJsonObject LoadGenerator::buildReport() const
+{
+    const double seconds = m_options.durationSec > 0 ? double(m_options.durationSec) : 1.0;
+
+    QJsonObject routes;
+    quint64 totalRequests = 0;
+    quint64 totalErrors = 0;
+    for (auto it = m_stats.constBegin(); it != m_stats.constEnd(); ++it) {
+        const RouteStats &s = it.value();
+        if (it.key() == "dropped") continue;
+
+        std::vector<qint64> sorted = s.latenciesUs;
+        std::sort(sorted.begin(), sorted.end());
+        double sumMs = 0;
+        for (qint64 us : sorted) sumMs += us / 1000.0;
+
+        QJsonObject status;
+        for (auto c = s.statusCounts.constBegin(); c != s.statusCounts.constEnd(); ++c) status[c.key()] = qint64(c.value());
+
+        QJsonObject latency;
+        latency["mean"] = sorted.empty() ? 0.0 : sumMs / double(sorted.size());
+        latency["p50"] = percentileMs(sorted, 0.50);
+        latency["p95"] = percentileMs(sorted, 0.95);
+        latency["p99"] = percentileMs(sorted, 0.99);
+        latency["p999"] = percentileMs(sorted, 0.999);
+        latency["max"] = sorted.empty() ? 0.0 : sorted.back() / 1000.0;
+
+        QJsonObject route;
+        route["path"] = s.path;
+        route["requests"] = qint64(sorted.size());
+        route["errors"] = qint64(s.errors);
+        route["throughput_rps"] = double(sorted.size()) / seconds;
+        route["status"] = status;
+        route["latency_ms"] = latency;
+        routes[it.key()] = route;
+
+        totalRequests += sorted.size();
+        totalErrors += s.errors;
+    }
+
+    QJsonObject mix;
+    for (auto it = m_options.mix.constBegin(); it != m_options.mix.constEnd(); ++it) mix[it.key()] = it.value();
+
+    QJsonObject report;
+    report["target"] = m_options.baseUrl.toString();
+    report["mode"] = m_options.rate > 0 ? "open_loop" : "closed_loop";
+    report["concurrency"] = m_options.concurrency;
+    report["rate"] = m_options.rate;
+    report["duration_s"] = m_options.durationSec;
+    report["warmup_s"] = m_options.warmupSec;
+    report["mix"] = mix;
+    report["users"] = int(m_userIds.size());
+    report["flights"] = int(m_flights.size());
+    report["total_requests"] = qint64(totalRequests);
+    report["total_errors"] = qint64(totalErrors);
+    report["throughput_rps"] = double(totalRequests) / seconds;
+    report["dropped"] = qint64(m_stats.value("dropped").statusCounts.value("dropped"));
+    report["routes"] = routes;
+    return report;
+}
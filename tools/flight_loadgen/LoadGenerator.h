@@ -0,0 +1,114 @@
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+#include <QObject>
+#include <QNetworkAccessManager>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QList>
+#include <QMap>
+#include <QUrl>
+#include <QRandomGenerator>
+#include <deque>
+#include <functional>
+#include <vector>
+
+// 压测参数 (由命令行填充)
+struct LoadOptions {
+    QUrl baseUrl = QUrl("http://localhost:8080");
+    int concurrency = 16;        // 闭环模式：同时在途的虚拟用户数
+    double rate = 0;             // 开环模式：每秒发起的请求数 (>0 时启用，concurrency 作为在途上限)
+    int durationSec = 30;
+    int warmupSec = 5;           // 预热期间的请求不计入统计
+    int users = 50;              // 压测用户数
+    int flights = 20;            // 压测航班数 (分布在若干航线、未来几天)
+    QMap<QString, int> mix;      // 操作 -> 权重
+    QString outputPath;          // 为空时结果打印到标准输出
+};
+
+// ==============================================================================
+//  HTTP 压测器
+//  1. 准备数据：注册/登录压测用户并充值，通过管理接口新增压测航班
+//  2. 按权重随机选择操作发请求：
+//     - 闭环 (--concurrency)：每个虚拟用户收到响应后立即发下一个
+//     - 开环 (--rate)：按固定速率排程，延迟从 "计划发出时间" 算起，服务端变慢时不会少算排队时间
+//  3. 结束后按接口输出请求数、状态码分布、吞吐和延迟分位数
+//  QNetworkAccessManager 对同一主机最多开 6 条连接，这里按并发数创建多个 manager 轮流使用
+// ==============================================================================
+class LoadGenerator : public QObject {
+    Q_OBJECT
+public:
+    explicit LoadGenerator(const LoadOptions &options, QObject *parent = nullptr);
+
+    // 开始 (异步)，结束时发出 finished(结果 JSON)
+    void start();
+
+    static QStringList operations();
+
+signals:
+    void finished(const QJsonObject &report);
+    void failed(const QString &message);
+
+private:
+    struct RouteStats {
+        QString path;
+        std::vector<qint64> latenciesUs;
+        QMap<QString, quint64> statusCounts;   // "2xx" / "4xx" / "5xx" / "network_error"
+        quint64 errors = 0;
+    };
+    struct Flight {
+        int id;
+        QString originCode;
+        QString destinationCode;
+        QString date;
+    };
+    struct PendingOrder {
+        int orderId;
+        int userId;
+    };
+    using Callback = std::function<void(int status, const QJsonObject &body)>;
+
+    // 准备数据
+    void seedUsers(int index);
+    void seedFlights(int index);
+    void reuseSeededFlight(int index, const Flight &flight, const QString &flightNumber, const QString &addError);
+    void beginRun();
+
+    // 压测
+    void runOne(qint64 scheduledUs);
+    void tickOpenLoop();
+    void finish();
+    QString pickOperation();
+
+    // 发一个 POST，完成后回调；record 非空时把延迟计入对应接口
+    void post(const QString &path, const QJsonObject &body, qint64 startUs, const QString &record, const Callback &done);
+
+    qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+    QJsonObject buildReport() const;
+
+    LoadOptions m_options;
+    std::vector<QNetworkAccessManager *> m_managers;
+    size_t m_nextManager = 0;
+    QRandomGenerator m_random;
+
+    QList<int> m_userIds;
+    QList<Flight> m_flights;
+    std::deque<PendingOrder> m_unpaidOrders;   // 下单成功、等待 payment 操作支付的订单
+
+    QStringList m_operations;                  // 与 m_cumulativeWeights 一一对应
+    QList<int> m_cumulativeWeights;
+    int m_totalWeight = 0;
+
+    QElapsedTimer m_clock;
+    qint64 m_measureStartUs = 0;
+    qint64 m_endUs = 0;
+    bool m_stopping = false;
+    bool m_reported = false;
+    int m_inFlight = 0;
+    QTimer m_rateTimer;
+    qint64 m_nextScheduledUs = 0;
+    QMap<QString, RouteStats> m_stats;
+};
+
+#endif // LOADGENERATOR_H
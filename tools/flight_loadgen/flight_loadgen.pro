@@ -0,0 +1,27 @@
+# ------------------------------------------------
+# 文件: tools/flight_loadgen/flight_loadgen.pro
+# 压测工具：按加权比例回放 搜索 / 下单 / 支付 / 订单列表 / 用户信息 请求，
+# 输出每个接口的吞吐和 p50/p95/p99/p99.9 延迟 (JSON)
+#
+# 构建: qmake tools/flight_loadgen && make
+# 用法: flight_loadgen --url http://localhost:8080 --concurrency 32 --duration 30 --output result.json
+#       flight_loadgen --rate 500 --mix search=70,create_order=10,payment=5,get_orders=10,user_info=5
+#       (flight_loadgen --help 查看全部参数)
+# 注意：会通过接口注册压测用户、新增压测航班 (航班号 LG 开头)，请对测试库使用；
+#       同一天重复运行会沿用已有的 LG 航班，上次卖出的座位不会退回
+# ------------------------------------------------
+
+QT += core network
+QT -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = flight_loadgen
+
+SOURCES += \
+    LoadGenerator.cpp \
+    main.cpp
+
+HEADERS += \
+    LoadGenerator.h
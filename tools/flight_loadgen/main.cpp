@@ -0,0 +1,95 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QFile>
+#include <QTextStream>
+#include <QTimer>
+
+#include "LoadGenerator.h"
+
+// 解析 "search=60,create_order=10" 形式的请求比例
+static bool parseMix(const QString &text, QMap<QString, int> &mix, QString &error)
+{
+    const QStringList known = LoadGenerator::operations();
+    for (const QString &part : text.split(',', Qt::SkipEmptyParts)) {
+        const QStringList kv = part.trimmed().split('=');
+        bool ok = false;
+        const int weight = kv.size() == 2 ? kv[1].trimmed().toInt(&ok) : 0;
+        if (!ok || weight < 0) {
+            error = "无法解析比例: " + part;
+            return false;
+        }
+        const QString op = kv[0].trimmed();
+        if (!known.contains(op)) {
+            error = "未知操作: " + op + " (可选: " + known.join(", ") + ")";
+            return false;
+        }
+        mix[op] = weight;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("flight_loadgen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("航班预订后端 HTTP 压测工具");
+    parser.addHelpOption();
+
+    const QCommandLineOption urlOpt("url", "服务器地址", "url", "http://localhost:8080");
+    const QCommandLineOption concurrencyOpt("concurrency", "闭环并发数；开环模式下为在途请求上限", "n", "16");
+    const QCommandLineOption rateOpt("rate", "开环模式：每秒请求数 (0 = 闭环)", "rps", "0");
+    const QCommandLineOption durationOpt("duration", "统计时长 (秒)", "sec", "30");
+    const QCommandLineOption warmupOpt("warmup", "预热时长 (秒)，不计入统计", "sec", "5");
+    const QCommandLineOption usersOpt("users", "压测用户数", "n", "50");
+    const QCommandLineOption flightsOpt("flights", "压测航班数", "n", "20");
+    const QCommandLineOption mixOpt("mix", "请求比例", "op=weight,...",
+                                    "search=60,create_order=10,payment=5,get_orders=15,user_info=10");
+    const QCommandLineOption outputOpt("output", "结果 JSON 写入文件 (默认打印到标准输出)", "file");
+    parser.addOptions({urlOpt, concurrencyOpt, rateOpt, durationOpt, warmupOpt, usersOpt, flightsOpt, mixOpt, outputOpt});
+    parser.process(app);
+
+    LoadOptions options;
+    options.baseUrl = QUrl(parser.value(urlOpt));
+    options.concurrency = qMax(1, parser.value(concurrencyOpt).toInt());
+    options.rate = qMax(0.0, parser.value(rateOpt).toDouble());
+    options.durationSec = qMax(1, parser.value(durationOpt).toInt());
+    options.warmupSec = qMax(0, parser.value(warmupOpt).toInt());
+    options.users = qMax(1, parser.value(usersOpt).toInt());
+    options.flights = qMax(1, parser.value(flightsOpt).toInt());
+    options.outputPath = parser.value(outputOpt);
+
+    QString error;
+    if (!options.baseUrl.isValid() || !parseMix(parser.value(mixOpt), options.mix, error)) {
+        QTextStream(stderr) << (error.isEmpty() ? "无效的服务器地址" : error) << "\n";
+        return 1;
+    }
+
+    LoadGenerator generator(options);
+    QObject::connect(&generator, &LoadGenerator::finished, &app, [&](const QJsonObject &report) {
+        const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+        if (options.outputPath.isEmpty()) {
+            QTextStream(stdout) << json;
+        } else {
+            QFile file(options.outputPath);
+            if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                QTextStream(stderr) << "无法写入结果文件: " << options.outputPath << "\n";
+                app.exit(1);
+                return;
+            }
+            file.write(json);
+            QTextStream(stderr) << "结果已写入 " << options.outputPath << "\n";
+        }
+        app.exit(0);
+    });
+    QObject::connect(&generator, &LoadGenerator::failed, &app, [&](const QString &message) {
+        QTextStream(stderr) << "压测失败: " << message << "\n";
+        app.exit(1);
+    });
+
+    // 在事件循环里开始，start() 里同步出错时 app.exit() 才有效
+    QTimer::singleShot(0, &generator, [&generator]() { generator.start(); });
+    return app.exec();
+}
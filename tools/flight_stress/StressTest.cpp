@@ -0,0 +1,467 @@
+#include "StressTest.h"
+
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDate>
+#include <QDateTime>
+#include <QTextStream>
+#include <algorithm>
+#include <memory>
+#include <cmath>
+
+// 核对失败时最多列出多少条明细
+static const int kMaxDetails = 10;
+
+StressTest::StressTest(const StressOptions &options, QObject *parent)
+    : QObject(parent), m_options(options), m_random(QRandomGenerator::securelySeeded())
+{
+    // 每个 manager 对同一主机最多 6 条连接
+    const int managers = qMax(1, (m_options.concurrency + 5) / 6);
+    for (int i = 0; i < managers; ++i) m_managers.push_back(new QNetworkAccessManager(this));
+
+    // 用户名和航班号都带上本次的标记，不会和之前的压测数据混在一起
+    m_runTag = QString::number(QDateTime::currentSecsSinceEpoch() % 1000000);
+    m_connectionName = "flight_stress_" + m_runTag;
+}
+
+StressTest::~StressTest()
+{
+    if (m_db.isValid()) {
+        m_db.close();
+        m_db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(m_connectionName);
+    }
+}
+
+void StressTest::start()
+{
+    m_clock.start();
+    if (!openDatabase()) return;
+    QTextStream(stderr) << "准备压测数据: " << m_options.users << " 个用户, 1 个航班 (" << m_options.seats << " 座)\n";
+    seedUsers(0);
+}
+
+bool StressTest::openDatabase()
+{
+    m_db = QSqlDatabase::addDatabase("QMYSQL", m_connectionName);
+    m_db.setHostName(m_options.dbHost);
+    m_db.setPort(m_options.dbPort);
+    m_db.setDatabaseName(m_options.dbName);
+    m_db.setUserName(m_options.dbUser);
+    m_db.setPassword(m_options.dbPassword);
+    if (!m_db.open()) {
+        emit failed("无法连接数据库 (压完要查库核对): " + m_db.lastError().text());
+        return false;
+    }
+    return true;
+}
+
+// ==============================================================================
+//  准备数据
+// ==============================================================================
+void StressTest::seedUsers(int index)
+{
+    if (index >= m_options.users) {
+        seedFlight();
+        return;
+    }
+
+    const QString username = QString("st%1_%2").arg(m_runTag).arg(index);
+    // 手机号唯一：17 + 本次标记后 5 位 + 序号 4 位
+    const QString telephone = QString("17%1%2").arg(m_runTag.right(5), 5, QChar('0')).arg(index, 4, 10, QChar('0'));
+    QJsonObject body{{"username", username}, {"password", "stress"}, {"telephone", telephone},
+                     {"email", username + "@stress.test"}};
+
+    post("/api/register", body, [this, index, username](int status, const QJsonObject &resp) {
+        if (status != 200 || resp["status"].toString() != "success") {
+            emit failed("注册压测用户 " + username + " 失败: " + resp["message"].toString());
+            return;
+        }
+        const int uid = resp["new_user_id"].toInt();
+        post("/api/user/recharge", QJsonObject{{"uid", uid}, {"amount", m_options.balance}},
+             [this, index, uid, username](int status, const QJsonObject &) {
+                 if (status != 200) {
+                     emit failed("压测用户 " + username + " 充值失败");
+                     return;
+                 }
+                 m_users.append({uid});
+                 seedUsers(index + 1);
+             });
+    });
+}
+
+void StressTest::seedFlight()
+{
+    const QString date = QDate::currentDate().addDays(1).toString("yyyy-MM-dd");
+    QJsonObject body{{"flight_number", "ST" + m_runTag},
+                     {"origin", "BJS"}, {"destination", "SHA"},
+                     {"departure_date", date}, {"landing_date", date},
+                     {"departure_time", "09:00"}, {"landing_time", "11:15"},
+                     {"airline", "压测航空"}, {"aircraft_model", "A321"},
+                     {"economy_seats", m_options.seats}, {"economy_price", m_options.price},
+                     {"business_seats", 8}, {"business_price", m_options.price * 3},
+                     {"first_class_seats", 4}, {"first_class_price", m_options.price * 6}};
+
+    post("/api/admin/add_flight", body, [this](int status, const QJsonObject &resp) {
+        if (status != 200) {
+            emit failed("新增压测航班失败: " + resp["message"].toString());
+            return;
+        }
+        m_flightId = resp["flight_id"].toInt();
+        snapshot([this](const LockCounters &counters) {
+            m_before = counters;
+            beginRun();
+        });
+    });
+}
+
+// ==============================================================================
+//  计数快照
+// ==============================================================================
+
+// /metrics 文本里取一个计数 (序列还没出现过说明还没有发生，按 0 算)
+static double metricValue(const QByteArray &text, const QByteArray &series)
+{
+    for (const QByteArray &line : text.split('\n')) {
+        if (line.startsWith(series + ' ')) return line.mid(series.size() + 1).trimmed().toDouble();
+    }
+    return 0;
+}
+
+void StressTest::snapshot(const std::function<void(const LockCounters &)> &done)
+{
+    LockCounters counters;
+
+    // 1. MySQL 全局行锁统计 (Innodb_row_lock_time 单位是毫秒)
+    QSqlQuery status(m_db);
+    if (status.exec("SHOW GLOBAL STATUS LIKE 'Innodb_row_lock%'")) {
+        while (status.next()) {
+            const QString name = status.value(0).toString();
+            if (name == "Innodb_row_lock_waits") counters.rowLockWaits = status.value(1).toLongLong();
+            else if (name == "Innodb_row_lock_time") counters.rowLockTimeMs = status.value(1).toLongLong();
+        }
+    }
+    QSqlQuery deadlocks(m_db);
+    if (deadlocks.exec("SELECT COUNT FROM information_schema.INNODB_METRICS WHERE NAME = 'lock_deadlocks'")
+        && deadlocks.next()) {
+        counters.innodbDeadlocks = deadlocks.value(0).toLongLong();
+    }
+
+    // 2. 服务器 /metrics：死锁、等锁超时 (语句级) 和下单时的选座冲突重试
+    QUrl url = m_options.baseUrl;
+    url.setPath("/metrics");
+    QNetworkReply *reply = m_managers.front()->get(QNetworkRequest(url));
+    connect(reply, &QNetworkReply::finished, this, [reply, counters, done]() mutable {
+        if (reply->error() == QNetworkReply::NoError) {
+            const QByteArray text = reply->readAll();
+            counters.serverDeadlocks = metricValue(text, "db_lock_errors_total{kind=\"deadlock\"}");
+            counters.serverLockTimeouts = metricValue(text, "db_lock_errors_total{kind=\"lock_wait_timeout\"}");
+            counters.serverSeatConflicts = metricValue(text, "order_seat_conflicts_total");
+        }
+        reply->deleteLater();
+        done(counters);
+    });
+}
+
+// ==============================================================================
+//  压测
+// ==============================================================================
+void StressTest::beginRun()
+{
+    QTextStream(stderr) << "开始抢票: 航班 " << m_flightId << ", " << m_options.bookings << " 次下单, 并发 "
+                        << m_options.concurrency << "\n";
+    m_runStartUs = nowUs();
+    while (m_inFlight < m_options.concurrency && m_launched < m_options.bookings) launchNext();
+}
+
+void StressTest::launchNext()
+{
+    ++m_inFlight;
+    book(m_launched++);
+}
+
+void StressTest::book(int bookingIndex)
+{
+    // 用户轮询分配：每个用户都有多笔订单在并发下单、支付，余额扣减也会互相竞争
+    const int userId = m_users[bookingIndex % m_users.size()].id;
+    const qint64 startUs = nowUs();
+
+    post("/api/create_order", QJsonObject{{"user_id", userId}, {"flight_id", m_flightId}, {"seat_type", 0}},
+         [this, userId, startUs](int status, const QJsonObject &resp) {
+             OpStats &create = m_stats["create_order"];
+             create.latenciesUs.push_back(nowUs() - startUs);
+
+             if (status != 200 || resp["status"].toString() != "success") {
+                 const QString message = resp["message"].toString();
+                 QString outcome = "error";
+                 if (status == 409 && message.contains("售罄")) outcome = "sold_out";
+                 else if (status == 409) outcome = "seat_conflict";
+                 else if (status == 0) outcome = "network_error";
+                 create.outcomes[outcome] += 1;
+                 bookingDone();
+                 return;
+             }
+             create.outcomes["success"] += 1;
+
+             const int orderId = resp["order_id"].toInt();
+             if (m_random.generateDouble() >= m_options.duplicatePay) {
+                 pay(userId, orderId, startUs, [this](bool) { bookingDone(); });
+                 return;
+             }
+
+             // 同一个订单同时发两次支付，只能有一次成功
+             auto pending = std::make_shared<int>(2);
+             auto onPaid = [this, pending](bool) {
+                 if (--*pending == 0) bookingDone();
+             };
+             pay(userId, orderId, startUs, onPaid);
+             pay(userId, orderId, startUs, onPaid);
+         });
+}
+
+void StressTest::pay(int userId, int orderId, qint64 bookingStartUs, const std::function<void(bool paid)> &done)
+{
+    const qint64 startUs = nowUs();
+    post("/api/payment", QJsonObject{{"user_id", userId}, {"order_id", orderId}},
+         [this, startUs, bookingStartUs, done](int status, const QJsonObject &resp) {
+             OpStats &payment = m_stats["payment"];
+             const qint64 endUs = nowUs();
+             payment.latenciesUs.push_back(endUs - startUs);
+
+             const bool paid = status == 200 && resp["status"].toString() == "success";
+             if (paid) {
+                 payment.outcomes["success"] += 1;
+                 ++m_paidBookings;
+                 m_stats["booking"].latenciesUs.push_back(endUs - bookingStartUs);
+             } else {
+                 const QString message = resp["message"].toString();
+                 QString outcome = "error";
+                 if (message.contains("余额不足")) outcome = "insufficient_balance";
+                 else if (message.contains("已支付") || message.contains("无法支付") || message.contains("已超时"))
+                     outcome = "already_paid_or_closed";
+                 else if (status == 0) outcome = "network_error";
+                 payment.outcomes[outcome] += 1;
+             }
+             done(paid);
+         });
+}
+
+void StressTest::bookingDone()
+{
+    --m_inFlight;
+    ++m_completed;
+    if (m_launched < m_options.bookings) {
+        launchNext();
+        return;
+    }
+    if (m_completed < m_options.bookings) return;
+
+    m_runEndUs = nowUs();
+    snapshot([this](const LockCounters &counters) {
+        m_after = counters;
+        QTextStream(stderr) << "压测结束，开始查库核对\n";
+        bool passed = true;
+        const QJsonObject checks = verify(&passed);
+        emit finished(buildReport(checks), passed);
+    });
+}
+
+void StressTest::post(const QString &path, const QJsonObject &body, const Callback &done)
+{
+    QUrl url = m_options.baseUrl;
+    url.setPath(path);
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+
+    QNetworkAccessManager *manager = m_managers[m_nextManager];
+    m_nextManager = (m_nextManager + 1) % m_managers.size();
+
+    QNetworkReply *reply = manager->post(request, QJsonDocument(body).toJson(QJsonDocument::Compact));
+    connect(reply, &QNetworkReply::finished, this, [reply, done]() {
+        const QVariant statusAttr = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+        const int status = statusAttr.isValid() ? statusAttr.toInt() : 0;
+        const QJsonObject body = QJsonDocument::fromJson(reply->readAll()).object();
+        reply->deleteLater();
+        done(status, body);
+    });
+}
+
+// ==============================================================================
+//  核对
+// ==============================================================================
+QJsonObject StressTest::verify(bool *passed)
+{
+    QJsonObject checks;
+    auto record = [&checks, passed](const char *name, bool ok, const QJsonArray &details, const QString &error) {
+        QJsonObject c{{"passed", ok}};
+        if (!details.isEmpty()) c["details"] = details;
+        if (!error.isEmpty()) c["error"] = error;
+        checks[name] = c;
+        if (!ok) *passed = false;
+    };
+
+    // 1. 同一座位没有两张占座中的订单 (已取消/已退款的不占座)
+    {
+        QSqlQuery q(m_db);
+        q.prepare("SELECT seat_type, seat_number, COUNT(*) FROM orders "
+                  "WHERE flight_id = ? AND status NOT IN ('已取消', '已退款') "
+                  "GROUP BY seat_type, seat_number HAVING COUNT(*) > 1");
+        q.addBindValue(m_flightId);
+        QJsonArray details;
+        const bool ok = q.exec();
+        while (ok && q.next()) {
+            if (details.size() < kMaxDetails) {
+                details.append(QString("seat_type %1 座位 %2 有 %3 张订单")
+                                   .arg(q.value(0).toInt()).arg(q.value(1).toString()).arg(q.value(2).toInt()));
+            }
+        }
+        record("no_double_assigned_seat", ok && details.isEmpty(), details, ok ? QString() : q.lastError().text());
+    }
+
+    // 2. 占座订单数不超过座位数，余座计数 = 座位数 - 占座订单数
+    {
+        QSqlQuery q(m_db);
+        // 余座计数按分片存储，舱位的余座是各分片之和
+        q.prepare("SELECT c.seat_type, "
+                  "(SELECT SUM(i.remaining) FROM flight_seat_inventory i WHERE i.flight_id = f.ID AND i.seat_type = c.seat_type), "
+                  "CASE c.seat_type WHEN 0 THEN f.economy_seats WHEN 1 THEN f.business_seats ELSE f.first_class_seats END, "
+                  "(SELECT COUNT(*) FROM orders o WHERE o.flight_id = f.ID AND o.seat_type = c.seat_type "
+                  " AND o.status NOT IN ('已取消', '已退款')) "
+                  "FROM flights f CROSS JOIN (SELECT 0 AS seat_type UNION ALL SELECT 1 UNION ALL SELECT 2) c WHERE f.ID = ?");
+        q.addBindValue(m_flightId);
+        QJsonArray details;
+        const bool ok = q.exec();
+        while (ok && q.next()) {
+            const int type = q.value(0).toInt();
+            const int remaining = q.value(1).toInt();
+            const int capacity = q.value(2).toInt();
+            const int held = q.value(3).toInt();
+            if (held > capacity) {
+                details.append(QString("seat_type %1 超卖: %2 张占座订单, 只有 %3 座").arg(type).arg(held).arg(capacity));
+            } else if (remaining != capacity - held) {
+                details.append(QString("seat_type %1 余座计数 %2, 按订单应为 %3").arg(type).arg(remaining).arg(capacity - held));
+            }
+        }
+        record("no_oversell_and_counters_match", ok && details.isEmpty(), details, ok ? QString() : q.lastError().text());
+    }
+
+    // 3. 余额没有负数，且 初始余额 = 当前余额 + 已支付金额
+    {
+        QSqlQuery q(m_db);
+        q.prepare("SELECT u.U_ID, u.balance, "
+                  "(SELECT COALESCE(SUM(o.paid_amount), 0) FROM orders o WHERE o.user_id = u.U_ID AND o.status = '已支付') "
+                  "FROM users u WHERE u.username LIKE ?");
+        q.addBindValue(QString("st%1\\_%").arg(m_runTag));
+        QJsonArray negative;
+        QJsonArray mismatched;
+        const bool ok = q.exec();
+        while (ok && q.next()) {
+            const int uid = q.value(0).toInt();
+            const double balance = q.value(1).toDouble();
+            const double paid = q.value(2).toDouble();
+            if (balance < 0 && negative.size() < kMaxDetails) {
+                negative.append(QString("用户 %1 余额 %2").arg(uid).arg(balance, 0, 'f', 2));
+            }
+            if (std::abs(balance + paid - m_options.balance) > 0.005 && mismatched.size() < kMaxDetails) {
+                mismatched.append(QString("用户 %1 余额 %2 + 已支付 %3 != 初始 %4").arg(uid)
+                                      .arg(balance, 0, 'f', 2).arg(paid, 0, 'f', 2).arg(m_options.balance, 0, 'f', 2));
+            }
+        }
+        const QString error = ok ? QString() : q.lastError().text();
+        record("no_negative_balance", ok && negative.isEmpty(), negative, error);
+        record("balance_matches_paid_orders", ok && mismatched.isEmpty(), mismatched, error);
+    }
+
+    // 4. 客户端收到的支付成功数 = 库里该航班已支付订单数
+    {
+        QSqlQuery q(m_db);
+        q.prepare("SELECT COUNT(*) FROM orders WHERE flight_id = ? AND status = '已支付'");
+        q.addBindValue(m_flightId);
+        const bool ok = q.exec() && q.next();
+        const qint64 dbPaid = ok ? q.value(0).toLongLong() : -1;
+        QJsonArray details;
+        if (ok && dbPaid != qint64(m_paidBookings)) {
+            details.append(QString("客户端支付成功 %1 次, 库里已支付订单 %2 张").arg(m_paidBookings).arg(dbPaid));
+        }
+        record("paid_count_matches", ok && details.isEmpty(), details, ok ? QString() : q.lastError().text());
+    }
+
+    return checks;
+}
+
+// ==============================================================================
+//  报告
+// ==============================================================================
+
+// 最近秩法取分位数 (输入已排序)
+static double percentileMs(const std::vector<qint64> &sorted, double p)
+{
+    if (sorted.empty()) return 0;
+    const size_t rank = size_t(std::ceil(p * double(sorted.size())));
+    return sorted[qBound<size_t>(1, rank, sorted.size()) - 1] / 1000.0;
+}
+
+// 两次快照之差，任何一次没取到就是 null
+static QJsonValue delta(double before, double after)
+{
+    if (before < 0 || after < 0) return QJsonValue();
+    return after - before;
+}
+
+QJsonObject StressTest::buildReport(const QJsonObject &checks) const
+{
+    const double seconds = qMax<qint64>(1, m_runEndUs - m_runStartUs) / 1e6;
+
+    QJsonObject ops;
+    for (auto it = m_stats.constBegin(); it != m_stats.constEnd(); ++it) {
+        std::vector<qint64> sorted = it.value().latenciesUs;
+        std::sort(sorted.begin(), sorted.end());
+
+        QJsonObject outcomes;
+        for (auto o = it.value().outcomes.constBegin(); o != it.value().outcomes.constEnd(); ++o) {
+            outcomes[o.key()] = qint64(o.value());
+        }
+        QJsonObject latency{{"p50", percentileMs(sorted, 0.50)}, {"p95", percentileMs(sorted, 0.95)},
+                            {"p99", percentileMs(sorted, 0.99)}, {"p999", percentileMs(sorted, 0.999)},
+                            {"max", sorted.empty() ? 0.0 : sorted.back() / 1000.0}};
+        QJsonObject op{{"count", qint64(sorted.size())}, {"latency_ms", latency}};
+        if (!outcomes.isEmpty()) op["outcomes"] = outcomes;
+        ops[it.key()] = op;
+    }
+
+    const QJsonValue lockWaits = delta(m_before.rowLockWaits, m_after.rowLockWaits);
+    const QJsonValue lockTimeMs = delta(m_before.rowLockTimeMs, m_after.rowLockTimeMs);
+    QJsonObject locks{
+        {"innodb_row_lock_waits", lockWaits},
+        {"innodb_row_lock_time_ms", lockTimeMs},
+        {"innodb_row_lock_avg_wait_ms", lockWaits.toDouble() > 0 ? QJsonValue(lockTimeMs.toDouble() / lockWaits.toDouble())
+                                                                 : QJsonValue()},
+        {"innodb_deadlocks", delta(m_before.innodbDeadlocks, m_after.innodbDeadlocks)},
+        {"server_deadlocks", delta(m_before.serverDeadlocks, m_after.serverDeadlocks)},
+        {"server_lock_wait_timeouts", delta(m_before.serverLockTimeouts, m_after.serverLockTimeouts)},
+        {"server_seat_conflict_retries", delta(m_before.serverSeatConflicts, m_after.serverSeatConflicts)}};
+
+    bool passed = true;
+    for (const QJsonValue &c : checks) passed = passed && c.toObject()["passed"].toBool();
+
+    QJsonObject report;
+    report["target"] = m_options.baseUrl.toString();
+    report["flight_id"] = m_flightId;
+    report["seats"] = m_options.seats;
+    report["users"] = int(m_users.size());
+    report["bookings"] = m_options.bookings;
+    report["concurrency"] = m_options.concurrency;
+    report["duplicate_pay_ratio"] = m_options.duplicatePay;
+    report["duration_s"] = seconds;
+    report["paid_bookings"] = qint64(m_paidBookings);
+    report["goodput_per_s"] = double(m_paidBookings) / seconds;
+    report["operations"] = ops;
+    report["locks"] = locks;
+    report["checks"] = checks;
+    report["passed"] = passed;
+    return report;
+}
@@ -0,0 +1,123 @@
+#ifndef STRESSTEST_H
+#define STRESSTEST_H
+
+#include <QObject>
+#include <QNetworkAccessManager>
+#include <QSqlDatabase>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMap>
+#include <QUrl>
+#include <QRandomGenerator>
+#include <functional>
+#include <vector>
+
+// 压测参数 (由命令行填充)
+struct StressOptions {
+    QUrl baseUrl = QUrl("http://localhost:8080");
+    int concurrency = 200;       // 同时在途的抢票请求数
+    int bookings = 2000;         // 一共发起多少次 下单 (+ 支付)
+    int users = 100;             // 抢票用户数 (按轮询分配，每个用户都会并发下单/支付)
+    int seats = 300;             // 压测航班经济舱座位数 (bookings 超过它时后面的请求应该都是售罄)
+    int price = 800;             // 经济舱票价
+    double balance = 1600;       // 每个用户的初始余额 (默认只够买两张，用来检验余额不足时不会扣成负数)
+    double duplicatePay = 0.1;   // 有多少比例的订单同时发两次支付 (检验不会重复扣款)
+
+    // 核对用的数据库连接 (默认从 config.ini 的 [Database] 读取)
+    QString dbHost = "localhost";
+    int dbPort = 3306;
+    QString dbName = "flight_system";
+    QString dbUser = "root";
+    QString dbPassword;
+
+    QString outputPath;          // 为空时结果打印到标准输出
+};
+
+// ==============================================================================
+//  抢票压测
+//  1. 准备数据：注册一批用户并充值，新增一个压测航班
+//  2. 记下 MySQL 行锁/死锁计数和服务器 /metrics 里的锁冲突、选座冲突计数
+//  3. 并发发起 bookings 次抢票：下单成功后立即支付，部分订单同时发两次支付
+//  4. 再取一次计数求差，然后查库核对：
+//     - 同一航班同一座位没有两张占座中的订单，占座订单数不超过座位数，余座计数与订单一致
+//     - 压测用户余额没有负数，且 初始余额 = 当前余额 + 已支付订单金额 (没有重复扣款/漏扣)
+//     - 客户端看到的支付成功数与库里已支付订单数一致
+// ==============================================================================
+class StressTest : public QObject {
+    Q_OBJECT
+public:
+    explicit StressTest(const StressOptions &options, QObject *parent = nullptr);
+    ~StressTest() override;
+
+    // 开始 (异步)，结束时发出 finished(结果 JSON, 核对是否全部通过)
+    void start();
+
+signals:
+    void finished(const QJsonObject &report, bool passed);
+    void failed(const QString &message);
+
+private:
+    struct User {
+        int id = 0;
+    };
+    struct OpStats {
+        std::vector<qint64> latenciesUs;
+        QMap<QString, quint64> outcomes;   // 结果分类 -> 次数
+    };
+    // 计数快照：MySQL 全局状态 + 服务器 /metrics
+    struct LockCounters {
+        qint64 rowLockWaits = -1;
+        qint64 rowLockTimeMs = -1;
+        qint64 innodbDeadlocks = -1;       // 需要 PROCESS 权限，读不到时为 -1
+        double serverDeadlocks = -1;
+        double serverLockTimeouts = -1;
+        double serverSeatConflicts = -1;
+    };
+    using Callback = std::function<void(int status, const QJsonObject &body)>;
+
+    // 准备数据
+    bool openDatabase();
+    void seedUsers(int index);
+    void seedFlight();
+
+    // 压测
+    void snapshot(const std::function<void(const LockCounters &)> &done);
+    void beginRun();
+    void launchNext();
+    void book(int bookingIndex);
+    void pay(int userId, int orderId, qint64 bookingStartUs, const std::function<void(bool paid)> &done);
+    void bookingDone();
+
+    // 核对与报告
+    QJsonObject verify(bool *passed);
+    QJsonObject buildReport(const QJsonObject &checks) const;
+
+    void post(const QString &path, const QJsonObject &body, const Callback &done);
+    qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+
+    StressOptions m_options;
+    std::vector<QNetworkAccessManager *> m_managers;
+    size_t m_nextManager = 0;
+    QRandomGenerator m_random;
+    QSqlDatabase m_db;
+    QString m_connectionName;
+
+    QString m_runTag;                  // 本次压测的用户名/航班号后缀，与之前的压测数据分开
+    QList<User> m_users;
+    int m_flightId = 0;
+
+    QElapsedTimer m_clock;
+    qint64 m_runStartUs = 0;
+    qint64 m_runEndUs = 0;
+    int m_launched = 0;
+    int m_inFlight = 0;
+    int m_completed = 0;
+    quint64 m_paidBookings = 0;        // 下单且支付成功的次数 (goodput)
+
+    QMap<QString, OpStats> m_stats;    // "create_order" / "payment" / "booking" (下单到支付成功的端到端耗时)
+    LockCounters m_before;
+    LockCounters m_after;
+};
+
+#endif // STRESSTEST_H
@@ -0,0 +1,27 @@
+# ------------------------------------------------
+# 文件: tools/flight_stress/flight_stress.pro
+# 抢票压测：大量并发 下单 + 支付 集中打到同一个航班、同一批用户上，
+# 压完直接查数据库核对 没有一座多卖、余额没有变成负数、扣款与已支付订单对得上，
+# 并输出有效吞吐 (下单且支付成功)、尾延迟、锁等待、死锁和选座冲突重试次数 (JSON)
+#
+# 构建: qmake tools/flight_stress && make
+# 用法: flight_stress --url http://localhost:8080 --config ../../config.ini --bookings 3000 --concurrency 300
+#       (flight_stress --help 查看全部参数)
+# 注意：会通过接口注册压测用户、新增一个压测航班 (航班号 ST 开头)，请对测试库使用；
+#       锁等待和死锁取自 MySQL 的全局计数，压测期间库上的其他流量也会算进去
+# ------------------------------------------------
+
+QT += core network sql
+QT -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = flight_stress
+
+SOURCES += \
+    StressTest.cpp \
+    main.cpp
+
+HEADERS += \
+    StressTest.h
@@ -0,0 +1,83 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QSettings>
+#include <QFile>
+#include <QTextStream>
+#include <QTimer>
+
+#include "StressTest.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("flight_stress");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("抢票压测：并发下单 + 支付集中到一个航班，压完查库核对一致性");
+    parser.addHelpOption();
+
+    const QCommandLineOption urlOpt("url", "服务器地址", "url", "http://localhost:8080");
+    const QCommandLineOption configOpt("config", "服务器的 config.ini (读取 [Database] 连接参数用于核对)", "file", "config.ini");
+    const QCommandLineOption concurrencyOpt("concurrency", "同时在途的抢票请求数", "n", "200");
+    const QCommandLineOption bookingsOpt("bookings", "一共发起多少次下单", "n", "2000");
+    const QCommandLineOption usersOpt("users", "抢票用户数", "n", "100");
+    const QCommandLineOption seatsOpt("seats", "压测航班经济舱座位数", "n", "300");
+    const QCommandLineOption priceOpt("price", "经济舱票价", "yuan", "800");
+    const QCommandLineOption balanceOpt("balance", "每个用户的初始余额 (默认两张票的钱)", "yuan");
+    const QCommandLineOption duplicateOpt("duplicate-pay", "同时发两次支付的订单比例", "ratio", "0.1");
+    const QCommandLineOption outputOpt("output", "结果 JSON 写入文件 (默认打印到标准输出)", "file");
+    parser.addOptions({urlOpt, configOpt, concurrencyOpt, bookingsOpt, usersOpt, seatsOpt, priceOpt,
+                       balanceOpt, duplicateOpt, outputOpt});
+    parser.process(app);
+
+    StressOptions options;
+    options.baseUrl = QUrl(parser.value(urlOpt));
+    options.concurrency = qMax(1, parser.value(concurrencyOpt).toInt());
+    options.bookings = qMax(1, parser.value(bookingsOpt).toInt());
+    options.users = qBound(1, parser.value(usersOpt).toInt(), 9999);
+    options.seats = qMax(1, parser.value(seatsOpt).toInt());
+    options.price = qMax(1, parser.value(priceOpt).toInt());
+    options.balance = parser.isSet(balanceOpt) ? parser.value(balanceOpt).toDouble() : options.price * 2.0;
+    options.duplicatePay = qBound(0.0, parser.value(duplicateOpt).toDouble(), 1.0);
+    options.outputPath = parser.value(outputOpt);
+
+    // 数据库连接参数与服务器用同一份配置
+    if (!QFile::exists(parser.value(configOpt))) {
+        QTextStream(stderr) << "找不到配置文件: " << parser.value(configOpt) << " (用 --config 指定服务器的 config.ini)\n";
+        return 1;
+    }
+    QSettings config(parser.value(configOpt), QSettings::IniFormat);
+    options.dbHost = config.value("Database/Host", options.dbHost).toString();
+    options.dbPort = config.value("Database/Port", options.dbPort).toInt();
+    options.dbName = config.value("Database/Name", options.dbName).toString();
+    options.dbUser = config.value("Database/User", options.dbUser).toString();
+    options.dbPassword = config.value("Database/Password").toString();
+
+    StressTest test(options);
+    QObject::connect(&test, &StressTest::finished, &app, [&](const QJsonObject &report, bool passed) {
+        const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+        if (options.outputPath.isEmpty()) {
+            QTextStream(stdout) << json;
+        } else {
+            QFile file(options.outputPath);
+            if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                QTextStream(stderr) << "无法写入结果文件: " << options.outputPath << "\n";
+                app.exit(1);
+                return;
+            }
+            file.write(json);
+            QTextStream(stderr) << "结果已写入 " << options.outputPath << "\n";
+        }
+        if (!passed) QTextStream(stderr) << "一致性核对未通过，见报告里的 checks\n";
+        app.exit(passed ? 0 : 1);
+    });
+    QObject::connect(&test, &StressTest::failed, &app, [&](const QString &message) {
+        QTextStream(stderr) << "压测失败: " << message << "\n";
+        app.exit(1);
+    });
+
+    // 在事件循环里开始，start() 里同步出错时 app.exit() 才有效
+    QTimer::singleShot(0, &test, [&test]() { test.start(); });
+    return app.exec();
+}
@@ -1,5 +1,6 @@
 #include "UserController.h"
 #include "DatabaseManager.h"
+#include "UserProfileCache.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QSqlQuery>
@@ -13,19 +14,19 @@ UserController::UserController(QObject *parent) : BaseController(parent)
 void UserController::registerRoutes(QHttpServer *server)
 {
     // 对应前端 fetchUserInfo() -> /api/user/info
-    server->route("/api/user/info", QHttpServerRequest::Method::Post,
+    routeConcurrent(server, "/api/user/info", QHttpServerRequest::Method::Post,
                   [this](const QHttpServerRequest &req) {
                       return handleGetUserInfo(req);
                   });
 
     // 对应前端 updateUserInfo() -> /api/user/update
-    server->route("/api/user/update", QHttpServerRequest::Method::Post,
+    routeConcurrent(server, "/api/user/update", QHttpServerRequest::Method::Post,
                   [this](const QHttpServerRequest &req) {
                       return handleUpdateUserInfo(req);
                   });
 
     // 对应前端 submitVerify() -> /api/user/verify
-    server->route("/api/user/verify", QHttpServerRequest::Method::Post,
+    routeConcurrent(server, "/api/user/verify", QHttpServerRequest::Method::Post,
                   [this](const QHttpServerRequest &req) {
                       return handleVerifyUser(req);
                   });
@@ -42,15 +43,24 @@ QHttpServerResponse UserController::handleGetUserInfo(const QHttpServerRequest &
     }
     int uid = jsonObj["uid"].toString().toInt();
 
-    QSqlDatabase db = DatabaseManager::getConnection();
+    // 先查缓存，命中就不访问数据库
+    QJsonObject cached;
+    if (UserProfileCache::instance().lookup(uid, &cached)) {
+        return QHttpServerResponse(QJsonObject{{"status", "success"}, {"data", cached}},
+                                   QHttpServerResponse::StatusCode::Ok);
+    }
+    const quint64 generation = UserProfileCache::instance().generation(uid);
+
+    // 缓存未命中时读主库：结果会在缓存里留一个 TTL，而缓存只随主库上的写入失效，
+    // 从副本读到的旧余额会一直留在缓存里 (读自己的写窗口过了之后副本也可能还落后几秒)
+    PooledConnection db = DatabaseManager::getConnection();
     if (!db.isOpen()) {
         return QHttpServerResponse(QJsonObject{{"status", "failed"}, {"message", "数据库连接失败"}},
                                    QHttpServerResponse::StatusCode::InternalServerError);
     }
-    QSqlQuery query(db);
-    query.prepare("SELECT username, nickname, true_name, telephone, email, P_ID, photo, balance FROM users WHERE U_ID = ?");
+    QSqlQuery &query = db.prepared("SELECT username, nickname, true_name, telephone, email, P_ID, photo, balance FROM users WHERE U_ID = ?");
     query.addBindValue(uid);
-    if (query.exec() && query.next()) {
+    if (DatabaseManager::exec(query) && query.next()) {
         QJsonObject data;
         QString pId = query.value("P_ID").toString();
 
@@ -66,6 +76,8 @@ QHttpServerResponse UserController::handleGetUserInfo(const QHttpServerRequest &
         // 计算性别
         data["gender"] = getGenderFromIdCard(pId);
 
+        UserProfileCache::instance().insert(uid, data, generation);
+
         QJsonObject response;
         response["status"] = "success";
         response["data"] = data;
@@ -103,7 +115,7 @@ QHttpServerResponse UserController::handleUpdateUserInfo(const QHttpServerReques
                                    QHttpServerResponse::StatusCode::BadRequest);
     }
 
-    QSqlDatabase db = DatabaseManager::getConnection();
+    PooledConnection db = DatabaseManager::getConnection();
     QSqlQuery query(db);
     // 注意：字段名不能作为绑定参数，必须直接拼接到 SQL 语句中（因为上面已经做了白名单检查，所以是安全的）
     QString sql = QString("UPDATE users SET %1 = ? WHERE U_ID = ?").arg(dbField);
@@ -112,7 +124,10 @@ QHttpServerResponse UserController::handleUpdateUserInfo(const QHttpServerReques
     query.addBindValue(value);
     query.addBindValue(uid);
 
-    if (query.exec()) {
+    if (DatabaseManager::exec(query)) {
+        DatabaseManager::noteWrite(uid);
+        // 作废缓存，下次读取从数据库加载 (两个并发修改各自写穿时，缓存可能留下先提交的那个值)
+        UserProfileCache::instance().invalidate(uid);
         return QHttpServerResponse(QJsonObject{{"status", "success"}, {"message", "更新成功"}},
                                    QHttpServerResponse::StatusCode::Ok);
     } else {
@@ -143,7 +158,7 @@ QHttpServerResponse UserController::handleVerifyUser(const QHttpServerRequest &r
                                    QHttpServerResponse::StatusCode::BadRequest);
     }
 
-    QSqlDatabase db = DatabaseManager::getConnection();
+    PooledConnection db = DatabaseManager::getConnection();
     QSqlQuery query(db);
     // 更新真实姓名和身份证号
     query.prepare("UPDATE users SET true_name = ?, P_ID = ? WHERE U_ID = ?");
@@ -151,13 +166,15 @@ QHttpServerResponse UserController::handleVerifyUser(const QHttpServerRequest &r
     query.addBindValue(idCard);
     query.addBindValue(uid);
 
-    if (query.exec()) {
+    if (DatabaseManager::exec(query)) {
+        DatabaseManager::noteWrite(uid);
+        UserProfileCache::instance().invalidate(uid);
         return QHttpServerResponse(QJsonObject{{"status", "success"}, {"message", "认证成功"}},
                                    QHttpServerResponse::StatusCode::Ok);
     } else {
         qWarning() << "Verify User Error:" << query.lastError().text();
         // 常见错误是身份证号已被其他账号绑定 (Duplicate entry)
-        if (query.lastError().text().contains("Duplicate")) {
+        if (DatabaseManager::isDuplicateKeyError(query.lastError())) {
             return QHttpServerResponse(QJsonObject{{"status", "failed"}, {"message", "该身份证号已被绑定"}},
                                        QHttpServerResponse::StatusCode::Conflict);
         }
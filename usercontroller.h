@@ -12,6 +12,9 @@ public:
     explicit UserController(QObject *parent = nullptr);
     void registerRoutes(QHttpServer *server);
 
+    // 辅助函数：根据身份证号计算性别 (第17位奇数男、偶数女)
+    static QString getGenderFromIdCard(const QString &idCard);
+
 private:
     // 获取用户信息
     QHttpServerResponse handleGetUserInfo(const QHttpServerRequest &request);
@@ -19,9 +22,6 @@ private:
     QHttpServerResponse handleUpdateUserInfo(const QHttpServerRequest &request);
     // 实名认证
     QHttpServerResponse handleVerifyUser(const QHttpServerRequest &request);
-
-    // 辅助函数：根据身份证号计算性别
-    QString getGenderFromIdCard(const QString &idCard);
 };
 
 #endif // USERCONTROLLER_H